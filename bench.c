@@ -0,0 +1,556 @@
+#include <stdio.h>
+#include <stdlib.h>  /* malloc(), realloc(), free() */
+#include <string.h>  /* memcpy(), strlen() */
+#include <time.h>    /* clock(), clock_gettime() */
+#include "leptjson.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BENCH_PERF 1
+#endif
+
+/* 每轮至少运行的时间（秒），取多轮中的最好成绩以减少干扰 */
+#define BENCH_MIN_SECONDS 0.2
+#define BENCH_ROUNDS 5
+
+/* 生成的测试数据大小 */
+#define BENCH_DATA_SIZE (4 << 20)
+
+/* 可增长的字符缓冲区，用于生成测试数据 */
+typedef struct {
+    char *s;
+    size_t len, size;
+} bench_buffer;
+
+static void bench_puts(bench_buffer *b, const char *s, size_t len) {
+    if (b->len + len + 1 > b->size) {
+        while (b->len + len + 1 > b->size)
+            b->size = b->size ? b->size * 2 : 4096;
+        b->s = (char *) realloc(b->s, b->size);
+    }
+    memcpy(b->s + b->len, s, len);
+    b->len += len;
+    b->s[b->len] = '\0';
+}
+
+#define BENCH_PUTS(b, s) bench_puts(b, s, strlen(s))
+
+/* 字符串为主：长的无转义字符串（如 base64、日志消息） */
+static void gen_strings(bench_buffer *b) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char chunk[1024];
+    size_t i, n = 0;
+    BENCH_PUTS(b, "[");
+    while (b->len < BENCH_DATA_SIZE) {
+        size_t len = 64 + (n * 37) % (sizeof(chunk) - 64);
+        for (i = 0; i < len; i++)
+            chunk[i] = alphabet[(i * 7 + n) % 64];
+        if (n++ > 0)
+            BENCH_PUTS(b, ",");
+        BENCH_PUTS(b, "\"");
+        bench_puts(b, chunk, len);
+        BENCH_PUTS(b, "\"");
+    }
+    BENCH_PUTS(b, "]");
+}
+
+/* 非 ASCII 字符串：中文与带重音的拉丁字母混合（UTF-8） */
+static void gen_unicode(bench_buffer *b) {
+    static const char *words[] = {"中文", "字符串", "café", "naïve", "日本語", "Ελληνικά", "text", "😀"};
+    size_t i, n = 0;
+    BENCH_PUTS(b, "[");
+    while (b->len < BENCH_DATA_SIZE) {
+        if (n > 0)
+            BENCH_PUTS(b, ",");
+        BENCH_PUTS(b, "\"");
+        for (i = 0; i < 8 + n % 24; i++) {
+            if (i > 0)
+                BENCH_PUTS(b, " ");
+            BENCH_PUTS(b, words[(i * 5 + n) % 8]);
+        }
+        BENCH_PUTS(b, "\"");
+        n++;
+    }
+    BENCH_PUTS(b, "]");
+}
+
+/* 非 ASCII 字符全部以 \\u 转义（许多客户端 SDK 的输出），含代理对 */
+static void gen_escapes(bench_buffer *b) {
+    char esc[16];
+    size_t i, n = 0;
+    BENCH_PUTS(b, "[");
+    while (b->len < BENCH_DATA_SIZE) {
+        if (n > 0)
+            BENCH_PUTS(b, ",");
+        BENCH_PUTS(b, "\"");
+        for (i = 0; i < 8 + n % 24; i++) {
+            if (i % 6 == 5) {
+                BENCH_PUTS(b, " ");
+            } else if (i % 11 == 7) {
+                sprintf(esc, "\\ud83d\\ude%02x", (unsigned) (n + i) % 0x50);
+                BENCH_PUTS(b, esc);
+            } else {
+                sprintf(esc, "\\u%04x", 0x4E00 + (unsigned) (n * 31 + i * 7) % 0x5200);
+                BENCH_PUTS(b, esc);
+            }
+        }
+        BENCH_PUTS(b, "\"");
+        n++;
+    }
+    BENCH_PUTS(b, "]");
+}
+
+/* 缩进格式的对象数组（配置、日志） */
+static void gen_pretty(bench_buffer *b) {
+    size_t n = 0;
+    BENCH_PUTS(b, "[\n");
+    while (b->len < BENCH_DATA_SIZE) {
+        if (n++ > 0)
+            BENCH_PUTS(b, ",\n");
+        BENCH_PUTS(b, "    {\n"
+                      "        \"name\": \"service\",\n"
+                      "        \"enabled\": true,\n"
+                      "        \"tags\": [\n"
+                      "            \"a\",\n"
+                      "            \"b\"\n"
+                      "        ],\n"
+                      "        \"limits\": {\n"
+                      "            \"cpu\": null\n"
+                      "        }\n"
+                      "    }");
+    }
+    BENCH_PUTS(b, "\n]\n");
+}
+
+/* 数值为主：坐标、传感器读数等浮点数组 */
+static void gen_numbers(bench_buffer *b) {
+    char num[32];
+    size_t n = 0;
+    unsigned long seed = 1;
+    BENCH_PUTS(b, "[");
+    while (b->len < BENCH_DATA_SIZE) {
+        seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF;
+        if (n++ > 0)
+            BENCH_PUTS(b, ",");
+        switch (n % 4) {
+            case 0: sprintf(num, "%lu", seed % 100000); break;
+            case 1: sprintf(num, "%.6f", (double) seed / 1000.0 - 1e6); break;
+            case 2: sprintf(num, "%.17g", (double) seed / 0x7FFFFFFF); break;
+            default: sprintf(num, "%.3e", (double) seed * 1e-20); break;
+        }
+        BENCH_PUTS(b, num);
+    }
+    BENCH_PUTS(b, "]");
+}
+
+/* 整数为主：带 64 位 ID 与时间戳的事件记录 */
+static void gen_ids(bench_buffer *b) {
+    char rec[128];
+    size_t n = 0;
+    unsigned long long id = 1152921504606846976ULL;
+    BENCH_PUTS(b, "[");
+    while (b->len < BENCH_DATA_SIZE) {
+        id += 7919 * (n % 13) + 1;
+        sprintf(rec, "%s{\"id\":%llu,\"ts\":%llu,\"user\":%lu,\"seq\":%lu}",
+                n > 0 ? "," : "", id, 1700000000000ULL + n * 17, (unsigned long) (n * 2654435761UL % 100000000), (unsigned long) n);
+        n++;
+        BENCH_PUTS(b, rec);
+    }
+    BENCH_PUTS(b, "]");
+}
+
+/* 嵌套较深：每条记录为 32 层交替嵌套的数组和对象 */
+static void gen_nested(bench_buffer *b) {
+    size_t n = 0;
+    int i;
+    BENCH_PUTS(b, "[");
+    while (b->len < BENCH_DATA_SIZE) {
+        if (n++ > 0)
+            BENCH_PUTS(b, ",");
+        for (i = 0; i < 16; i++)
+            BENCH_PUTS(b, "{\"k\":[");
+        BENCH_PUTS(b, "1,true");
+        for (i = 0; i < 16; i++)
+            BENCH_PUTS(b, "]}");
+    }
+    BENCH_PUTS(b, "]");
+}
+
+/* 各种记号交错：字面值、小整数、浮点数、带转义的短字符串，分支预测最难 */
+static void gen_mixed(bench_buffer *b) {
+    static const char *values[] = {
+        "null", "true", "false", "0", "-17", "3.25", "1e-7", "\"a\"", "\"tab\\there\"", "\"\\u00e9t\\u00e9\"",
+        "[]", "{}", "[1,\"x\"]", "{\"k\":false}", "\"\"", "42"
+    };
+    size_t n = 0;
+    unsigned long seed = 7;
+    BENCH_PUTS(b, "[");
+    while (b->len < BENCH_DATA_SIZE) {
+        seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF;
+        if (n++ > 0)
+            BENCH_PUTS(b, seed & 0x100 ? ", " : ",");
+        BENCH_PUTS(b, values[(seed >> 12) % (sizeof(values) / sizeof(values[0]))]);
+    }
+    BENCH_PUTS(b, "]");
+}
+
+/* NDJSON：每行一条日志记录 */
+static void gen_ndjson(bench_buffer *b) {
+    char rec[256];
+    size_t n = 0;
+    while (b->len < BENCH_DATA_SIZE) {
+        sprintf(rec, "{\"id\":%lu,\"ts\":%llu,\"level\":\"%s\",\"msg\":\"request done\",\"ms\":%.3f,\"tags\":[\"a\",\"b\"]}\n",
+                (unsigned long) n, 1700000000000ULL + n * 17, n % 5 ? "info" : "warn", (double) (n % 1000) / 7.0);
+        n++;
+        BENCH_PUTS(b, rec);
+    }
+}
+
+typedef struct {
+    const char *name;
+    void (*gen)(bench_buffer *b);
+} bench_case;
+
+static const bench_case bench_cases[] = {
+    {"strings", gen_strings},
+    {"pretty",  gen_pretty},
+    {"numbers", gen_numbers},
+    {"ids",     gen_ids},
+    {"nested",  gen_nested},
+    {"mixed",   gen_mixed},
+    {"unicode", gen_unicode},
+    {"escapes", gen_escapes},
+};
+
+/* 解析引擎 */
+typedef struct {
+    const char *name;
+    int (*parse)(lept_value *v, const char *json, size_t len);
+} bench_engine;
+
+/* 原地解析会改写输入，每次先复制到可写缓冲区（计入耗时） */
+static int bench_parse_insitu(lept_value *v, const char *json, size_t len) {
+    static char *buf = NULL;
+    static size_t size = 0;
+    if (len > size)
+        buf = (char *) realloc(buf, size = len);
+    memcpy(buf, json, len);
+    return lept_parse_insitu(v, buf, len);
+}
+
+static int bench_parse_borrow(lept_value *v, const char *json, size_t len) {
+    static const lept_parse_options opts = {LEPT_PARSE_OPT_BORROW, 0, 0};
+    return lept_parse_opts(v, json, len, &opts);
+}
+
+/* 校验字符串的 UTF-8 */
+static int bench_parse_utf8(lept_value *v, const char *json, size_t len) {
+    static const lept_parse_options opts = {LEPT_PARSE_OPT_VALIDATE_UTF8, 0, 0};
+    return lept_parse_opts(v, json, len, &opts);
+}
+
+/* 相同的对象键共享内存 */
+static int bench_parse_intern(lept_value *v, const char *json, size_t len) {
+    static const lept_parse_options opts = {LEPT_PARSE_OPT_INTERN_KEYS, 0, 0};
+    return lept_parse_opts(v, json, len, &opts);
+}
+
+/* 键序列相同的对象共享形状 */
+static int bench_parse_shapes(lept_value *v, const char *json, size_t len) {
+    static const lept_parse_options opts = {LEPT_PARSE_OPT_SHAPES, 0, 0};
+    return lept_parse_opts(v, json, len, &opts);
+}
+
+/* 延迟解析：只访问根值的第一个元素（或成员），模拟稀疏访问 */
+static int bench_parse_lazy(lept_value *v, const char *json, size_t len) {
+    static const lept_parse_options opts = {LEPT_PARSE_OPT_LAZY, 0, 0};
+    int ret = lept_parse_opts(v, json, len, &opts);
+    if (ret == LEPT_PARSE_OK && lept_get_type(v) == LEPT_ARRAY && lept_get_array_size(v) > 0)
+        lept_get_type(lept_get_array_element(v, 0));
+    return ret;
+}
+
+/* 事件方式：只统计标量个数，不构建 lept_value */
+static int bench_sax_count(void *ctx) {
+    ++*(size_t *) ctx;
+    return LEPT_SAX_CONTINUE;
+}
+
+static int bench_sax_bool(void *ctx, int b) {
+    (void) b;
+    return bench_sax_count(ctx);
+}
+
+static int bench_sax_number(void *ctx, const lept_value *n) {
+    (void) n;
+    return bench_sax_count(ctx);
+}
+
+static int bench_sax_string(void *ctx, const char *s, size_t len) {
+    (void) s;
+    (void) len;
+    return bench_sax_count(ctx);
+}
+
+static int bench_parse_sax(lept_value *v, const char *json, size_t len) {
+    static const lept_sax_handler handler = {
+        bench_sax_count, bench_sax_bool, bench_sax_number, bench_sax_string, NULL, NULL, NULL, NULL, NULL
+    };
+    size_t count = 0;
+    (void) v;
+    return lept_parse_sax(json, len, &handler, &count, NULL);
+}
+
+/* 拉取式读取：读完所有记号，不解码字符串 */
+static int bench_parse_reader(lept_value *v, const char *json, size_t len) {
+    lept_reader r;
+    lept_read_token tok;
+    int ret;
+    (void) v;
+    lept_reader_init(&r, json, len);
+    while ((tok = lept_reader_next(&r)) != LEPT_READ_EOF && tok != LEPT_READ_ERROR)
+        ;
+    ret = lept_reader_error(&r);
+    lept_reader_free(&r);
+    return ret;
+}
+
+/* 增量解析：按 4KB 一块输入，模拟从网络或文件流读取 */
+static int bench_parse_chunked(lept_value *v, const char *json, size_t len) {
+    lept_parser p;
+    size_t i, n;
+    int ret = LEPT_PARSE_OK;
+    lept_parser_init(&p, NULL);
+    for (i = 0; i < len && ret == LEPT_PARSE_OK; i += n) {
+        n = len - i < 4096 ? len - i : 4096;
+        ret = lept_parser_feed(&p, json + i, n);
+    }
+    return lept_parser_finish(&p, v);
+}
+
+/* 只校验，不构建 lept_value */
+static int bench_validate(lept_value *v, const char *json, size_t len) {
+    (void) v;
+    return lept_validate(json, len);
+}
+
+/* 选择性解析：每条记录只取一两个字段 */
+static int bench_parse_select(lept_value *v, const char *json, size_t len) {
+    static const char *pointers[] = {"/*/id", "/*/name"};
+    return lept_parse_select(v, json, len, pointers, 2);
+}
+
+/* 根数组的元素由 4 个线程并行构建 */
+static int bench_parse_parallel(lept_value *v, const char *json, size_t len) {
+    static const lept_parse_options opts = {0, 0, 4};
+    return lept_parse_opts(v, json, len, &opts);
+}
+
+/* 堆栈在各次解析之间保留 */
+static lept_workspace bench_workspace;
+
+static int bench_parse_workspace(lept_value *v, const char *json, size_t len) {
+    return lept_workspace_parse(&bench_workspace, v, json, len, NULL);
+}
+
+/* 值从文档的区块中分配；lept_free 只遍历，区块在下一次解析时重用 */
+static lept_document bench_document;
+
+static int bench_parse_document(lept_value *v, const char *json, size_t len) {
+    int ret = lept_document_parse(&bench_document, json, len, NULL);
+    lept_move(v, &bench_document.root);
+    return ret;
+}
+
+static const bench_engine bench_engines[] = {
+    {"lept_parse_n",       lept_parse_n},
+    {"lept_parse_indexed", lept_parse_indexed},
+    {"lept_parse_insitu",  bench_parse_insitu},
+    {"LEPT_PARSE_OPT_BORROW", bench_parse_borrow},
+    {"LEPT_PARSE_OPT_LAZY", bench_parse_lazy},
+    {"LEPT_PARSE_OPT_VALIDATE_UTF8", bench_parse_utf8},
+    {"LEPT_PARSE_OPT_INTERN_KEYS", bench_parse_intern},
+    {"LEPT_PARSE_OPT_SHAPES", bench_parse_shapes},
+    {"lept_parse_sax",     bench_parse_sax},
+    {"lept_reader",        bench_parse_reader},
+    {"lept_parser_feed",   bench_parse_chunked},
+    {"nthreads = 4",       bench_parse_parallel},
+    {"lept_validate",      bench_validate},
+    {"lept_parse_select",  bench_parse_select},
+    {"lept_workspace_parse", bench_parse_workspace},
+    {"lept_document_parse", bench_parse_document},
+};
+
+/* 墙钟时间（秒）：多线程解析时 clock() 累计的是所有线程的 CPU 时间，因此都按墙钟计时 */
+static double bench_wall_seconds(void) {
+#ifdef BENCH_PERF
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+    return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/**
+ * 每轮重复解析直到超过最短时间，返回各轮中最高的吞吐量（MB/s）
+ */
+static double bench_parse(const bench_engine *engine, const char *json, size_t len) {
+    double best = 0.0;
+    int round;
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        double start = bench_wall_seconds(), elapsed, mbps;
+        size_t iterations = 0;
+        do {
+            lept_value v;
+            lept_init(&v);
+            if (engine->parse(&v, json, len) != LEPT_PARSE_OK) {
+                fprintf(stderr, "parse error\n");
+                exit(1);
+            }
+            lept_free(&v);
+            iterations++;
+            elapsed = bench_wall_seconds() - start;
+        } while (elapsed < BENCH_MIN_SECONDS);
+        mbps = (double) len * iterations / (1 << 20) / elapsed;
+        if (mbps > best)
+            best = mbps;
+    }
+    return best;
+}
+
+static int bench_ndjson_callback(void *ctx, size_t offset, int error, lept_value *v) {
+    (void) offset;
+    (void) v;
+    if (error != LEPT_PARSE_OK)
+        ++*(size_t *) ctx;
+    return 0;
+}
+
+/**
+ * lept_parse_ndjson 在 nthreads 个线程下的吞吐量（MB/s），取多轮中的最好成绩
+ */
+static double bench_ndjson(const char *json, size_t len, size_t nthreads) {
+    double best = 0.0;
+    int round;
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        double start = bench_wall_seconds(), elapsed, mbps;
+        size_t iterations = 0, errors = 0;
+        do {
+            lept_parse_ndjson(json, len, nthreads, NULL, bench_ndjson_callback, &errors);
+            iterations++;
+            elapsed = bench_wall_seconds() - start;
+        } while (elapsed < BENCH_MIN_SECONDS);
+        if (errors != 0) {
+            fprintf(stderr, "parse error\n");
+            exit(1);
+        }
+        mbps = (double) len * iterations / (1 << 20) / elapsed;
+        if (mbps > best)
+            best = mbps;
+    }
+    return best;
+}
+
+#ifdef BENCH_PERF
+/**
+ * 打开本进程用户态的分支预测失败计数器，不支持（如虚拟机、权限不足）时返回 -1
+ */
+static int bench_perf_open(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * 解析一次的分支预测失败次数，换算为每 KB 输入
+ */
+static double bench_branch_misses(int fd, const bench_engine *engine, const char *json, size_t len) {
+    long long count = 0;
+    lept_value v;
+    lept_init(&v);
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    engine->parse(&v, json, len);
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    lept_free(&v);
+    if (read(fd, &count, sizeof(count)) != sizeof(count))
+        return -1.0;
+    return (double) count * 1024 / len;
+}
+#endif
+
+int main() {
+    static const char *level_names[] = {"scalar", "sse2", "avx2"};
+    static const size_t thread_counts[] = {1, 2, 4, 8, 16};
+    bench_buffer data[sizeof(bench_cases) / sizeof(bench_cases[0])], ndjson = {NULL, 0, 0};
+    size_t i, j;
+    int level, max = lept_set_simd_level(LEPT_SIMD_AUTO);
+#ifdef BENCH_PERF
+    int perf_fd = bench_perf_open();
+#endif
+    lept_workspace_init(&bench_workspace, 0);
+    lept_document_init(&bench_document, 0);
+    for (i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+        data[i].s = NULL;
+        data[i].len = data[i].size = 0;
+        bench_cases[i].gen(&data[i]);
+    }
+    for (j = 0; j < sizeof(bench_engines) / sizeof(bench_engines[0]); j++) {
+        printf("%s (MB/s)\n", bench_engines[j].name);
+        printf("%-10s", "");
+        for (level = LEPT_SIMD_SCALAR; level <= max; level++)
+            printf("%10s", level_names[level]);
+        printf("\n");
+        for (i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+            printf("%-10s", bench_cases[i].name);
+            for (level = LEPT_SIMD_SCALAR; level <= max; level++) {
+                lept_set_simd_level((lept_simd_level) level);
+                printf("%10.1f", bench_parse(&bench_engines[j], data[i].s, data[i].len));
+                fflush(stdout);
+            }
+            printf("\n");
+        }
+#ifdef BENCH_PERF
+        /* 有硬件计数器时再输出每 KB 输入的分支预测失败次数 */
+        if (perf_fd >= 0) {
+            printf("%s (branch-misses/KB)\n", bench_engines[j].name);
+            for (i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+                printf("%-10s", bench_cases[i].name);
+                for (level = LEPT_SIMD_SCALAR; level <= max; level++) {
+                    lept_set_simd_level((lept_simd_level) level);
+                    printf("%10.1f", bench_branch_misses(perf_fd, &bench_engines[j], data[i].s, data[i].len));
+                }
+                printf("\n");
+            }
+        }
+#endif
+    }
+    /* 按记录顺序交付，线程数超过核数时吞吐量不再增加 */
+    gen_ndjson(&ndjson);
+    lept_set_simd_level(LEPT_SIMD_AUTO);
+    printf("lept_parse_ndjson (MB/s)\n");
+    for (i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++)
+        printf("%4lu threads%10.1f\n", (unsigned long) thread_counts[i], bench_ndjson(ndjson.s, ndjson.len, thread_counts[i]));
+    free(ndjson.s);
+#ifdef BENCH_PERF
+    if (perf_fd < 0)
+        printf("(branch-miss counters unavailable)\n");
+    else
+        close(perf_fd);
+#endif
+    for (i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++)
+        free(data[i].s);
+    lept_workspace_free(&bench_workspace);
+    lept_document_free(&bench_document);
+    return 0;
+}
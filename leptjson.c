@@ -5,11 +5,47 @@
 
 #include "leptjson.h"
 #include <assert.h>  /* assert() */
-#include <errno.h>   /* errno, ERANGE */
-#include <math.h>    /* HUGE_VAL */
+#include <float.h>   /* FLT_EVAL_METHOD, DBL_MAX_10_EXP */
 #include <stdio.h>   /* sprintf() */
-#include <stdlib.h>  /* NULL, malloc(), realloc(), free(), strtod() */
+#include <stdlib.h>  /* NULL, malloc(), realloc(), free() */
 #include <string.h>  /* memcpy() */
+#include <stdint.h>  /* uint32_t, uint64_t */
+
+/* 并行解析 NDJSON 使用 POSIX 线程；其他平台在调用线程中解析 */
+#if !defined(_WIN32)
+#define LEPT_THREADS 1
+#include <pthread.h> /* pthread_create(), pthread_mutex_lock() */
+#include <unistd.h>  /* sysconf() */
+#endif
+
+/* 文件使用 mmap 只读映射；其他平台读入堆上的缓冲区 */
+#if !defined(_WIN32)
+#define LEPT_MMAP 1
+#include <fcntl.h>      /* open() */
+#include <sys/mman.h>   /* mmap(), madvise() */
+#include <sys/stat.h>   /* fstat() */
+#include <unistd.h>     /* close() */
+#endif
+
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_M_X64) || defined(_M_IX86)
+#define LEPT_LITTLE_ENDIAN 1
+#endif
+
+/* x86 下使用 SSE2/AVX2 加速扫描，运行时根据 CPU 选择实现；其他平台只有标量实现 */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LEPT_SIMD_X86 1
+#include <immintrin.h>
+#define LEPT_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+/* 强制内联：构建 lept_value 时事件驱动函数内联后，事件处理函数由间接调用变为直接调用 */
+#if defined(__GNUC__) || defined(__clang__)
+#define LEPT_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define LEPT_INLINE __forceinline
+#else
+#define LEPT_INLINE
+#endif
 
 #ifndef LEPT_PARSE_STACK_INIT_SIZE
 #define LEPT_PARSE_STACK_INIT_SIZE 256
@@ -33,9 +69,92 @@
         c->json++;\
     } while(0)
 
-#define ISDIGIT(ch) ((ch) >= '0' && (ch) <= '9')
+/* 读取当前字符，到达输入末尾时视为 '\0' */
+#define PEEK(c) ((c)->json < (c)->end ? *(c)->json : '\0')
+
+/* 字符分类，lept_ctype[] 中的标志位 */
+#define LEPT_CHAR_WS        0x01    /* 空白：' ' '\t' '\n' '\r' */
+#define LEPT_CHAR_DIGIT     0x02    /* '0'-'9' */
+#define LEPT_CHAR_STRUCT    0x04    /* 结构字符：{ } [ ] : , */
+#define LEPT_CHAR_STRING    0x08    /* 字符串中需要特殊处理的字符：'"' '\\' 及控制字符 */
+
+#define W LEPT_CHAR_WS
+#define D LEPT_CHAR_DIGIT
+#define S LEPT_CHAR_STRUCT
+#define Q LEPT_CHAR_STRING
+/* 以查表代替逐个比较的判断，减少热点循环中的分支 */
+static const unsigned char lept_ctype[256] = {
+    Q  , Q  , Q  , Q  , Q  , Q  , Q  , Q  , Q  , W|Q, W|Q, Q  , Q  , W|Q, Q  , Q  , /* 00 */
+    Q  , Q  , Q  , Q  , Q  , Q  , Q  , Q  , Q  , Q  , Q  , Q  , Q  , Q  , Q  , Q  , /* 10 */
+    W  , 0  , Q  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , S  , 0  , 0  , 0  , /* 20 */
+    D  , D  , D  , D  , D  , D  , D  , D  , D  , D  , S  , 0  , 0  , 0  , 0  , 0  , /* 30 */
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , /* 40 */
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , S  , Q  , S  , 0  , 0  , /* 50 */
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , /* 60 */
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , S  , 0  , S  , 0  , 0  , /* 70 */
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , /* 80 */
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , /* 90 */
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , /* A0 */
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , /* B0 */
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , /* C0 */
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , /* D0 */
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , /* E0 */
+    0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , 0  , /* F0 */
+};
+#undef W
+#undef D
+#undef S
+#undef Q
+
+#define XX 0xFF
+/* 十六进制数字的值，非十六进制数字为 0xFF */
+static const unsigned char lept_hex_value[256] = {
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* 00 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* 10 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* 20 */
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, XX, XX, XX, XX, XX, XX, /* 30 */
+    XX, 10, 11, 12, 13, 14, 15, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* 40 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* 50 */
+    XX, 10, 11, 12, 13, 14, 15, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* 60 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* 70 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* 80 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* 90 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* A0 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* B0 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* C0 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* D0 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* E0 */
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, /* F0 */
+};
+#undef XX
+
+/* 值的首字符对应的类型，用于 lept_sax_parse_value 分派 */
+enum {
+    LEPT_TOKEN_INVALID = 0,
+    LEPT_TOKEN_NULL,
+    LEPT_TOKEN_TRUE,
+    LEPT_TOKEN_FALSE,
+    LEPT_TOKEN_NUMBER,
+    LEPT_TOKEN_STRING,
+    LEPT_TOKEN_ARRAY,
+    LEPT_TOKEN_OBJECT
+};
+
+static const unsigned char lept_token[256] = {
+    ['n'] = LEPT_TOKEN_NULL, ['t'] = LEPT_TOKEN_TRUE, ['f'] = LEPT_TOKEN_FALSE,
+    ['-'] = LEPT_TOKEN_NUMBER, ['0'] = LEPT_TOKEN_NUMBER, ['1'] = LEPT_TOKEN_NUMBER, ['2'] = LEPT_TOKEN_NUMBER,
+    ['3'] = LEPT_TOKEN_NUMBER, ['4'] = LEPT_TOKEN_NUMBER, ['5'] = LEPT_TOKEN_NUMBER, ['6'] = LEPT_TOKEN_NUMBER,
+    ['7'] = LEPT_TOKEN_NUMBER, ['8'] = LEPT_TOKEN_NUMBER, ['9'] = LEPT_TOKEN_NUMBER,
+    ['"'] = LEPT_TOKEN_STRING, ['['] = LEPT_TOKEN_ARRAY, ['{'] = LEPT_TOKEN_OBJECT
+};
 
-#define ISDIGIT1TO9(ch) ((ch) >= '1' && (ch) <= '9')
+#define CHAR_CLASS(ch) lept_ctype[(unsigned char) (ch)]
+
+#define ISWS(ch) (CHAR_CLASS(ch) & LEPT_CHAR_WS)
+
+#define ISDIGIT(ch) (CHAR_CLASS(ch) & LEPT_CHAR_DIGIT)
+
+#define ISDIGIT1TO9(ch) ((ch) != '0' && ISDIGIT(ch))
 
 #define STRING_ERROR(ret) do { c->top = head; return ret; } while(0)
 
@@ -44,6 +163,8 @@
  */
 typedef struct {
     const char *json;
+    /* 输入末尾（不含）：所有扫描都以此为界，因此输入不要求以 '\0' 结尾 */
+    const char *end;
     /*
      * 缓冲区：解析字符串/对象/数组时把结果存储在临时缓冲区，再用 lept_set_xxx 完成设值
      * 动态扩展：完成解析之前，缓冲区的大小不能预知，因此采用动态数组结构（用索引，不要用指针）
@@ -51,9 +172,19 @@ typedef struct {
      */
     char *stack;
     size_t size, top;
+    /* 原地解析：输入缓冲区可写，字符串直接在其中解码并引用 */
+    int insitu;
+    /* 解析选项（LEPT_PARSE_OPT_*） */
+    unsigned flags;
+    /* 数组和对象的最大嵌套层数，0 表示不限制 */
+    size_t max_depth;
+    /* 非 NULL 时构建的值从文档的区块中分配 */
+    lept_document *doc;
 } lept_context;
 
 static int lept_parse_value(lept_context *c, lept_value *v);
+static int lept_parse_parallel(lept_value *v, const char *json, size_t len, const lept_parse_options *opts);
+static char *lept_strndup(const char *s, size_t len);
 
 /**
  * 堆栈压入
@@ -95,463 +226,5593 @@ static void *lept_context_pop(lept_context *c, size_t size) {
     return c->stack + (c->top -= size);
 }
 
+/* 64 字节块中各类字符的位图，第 i 位对应块中第 i 个字节 */
+typedef struct {
+    uint64_t backslash, quote, op, ws;
+} lept_block_masks;
+
 /**
- * 去除有效文本前面所有的空白字符
- *
- * @param c
+ * 各指令集级别的扫描函数
+ * 所有函数都只读取 [p, end) 范围内的字节
  */
-static void lept_parse_whitespace(lept_context *c) {
-    const char *p = c->json;
-    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+typedef struct {
+    /* 跳过空白，返回第一个非空白字符的位置（或 end） */
+    const char *(*skip_whitespace)(const char *p, const char *end);
+    /* 返回字符串中第一个需要特殊处理的字符（'"'、'\\' 或控制字符）的位置（或 end） */
+    const char *(*scan_string)(const char *p, const char *end);
+    /* 同上，并校验 UTF-8：也停在不合法的序列的首字节上（LEPT_PARSE_OPT_VALIDATE_UTF8） */
+    const char *(*scan_string_utf8)(const char *p, const char *end);
+    /* 对 p 开始的 64 个字节分类：反斜杠、引号、结构字符（{}[]:,）、空白 */
+    void (*classify)(const char *p, lept_block_masks *m);
+} lept_simd_ops;
+
+static const char *lept_skip_whitespace_scalar(const char *p, const char *end) {
+    while (p < end && ISWS(*p)) {
         p++;
     }
-    c->json = p;
+    return p;
 }
 
-/**
- * 解析 null
- *
- * @param c
- * @param v
- * @param judge_arr
- * @return
- */
-static int lept_parse_null(lept_context *c, lept_value *v) {
-    EXPECT(c, 'n');
-    const char *p = "ull";
-    while (*p != '\0') {
-        if (c->json[0] != *p) {
-            return LEPT_PARSE_INVALID_VALUE;
+/* SWAR：在 64 位整数的 8 个字节中并行查找 */
+#define LEPT_SWAR_ONES  0x0101010101010101ULL
+#define LEPT_SWAR_HIGHS 0x8080808080808080ULL
+/* 存在等于 0 的字节 */
+#define LEPT_SWAR_HAS_ZERO(x) (((x) - LEPT_SWAR_ONES) & ~(x) & LEPT_SWAR_HIGHS)
+/* 存在小于 n 的字节（n <= 128） */
+#define LEPT_SWAR_HAS_LESS(x, n) (((x) - LEPT_SWAR_ONES * (n)) & ~(x) & LEPT_SWAR_HIGHS)
+
+static const char *lept_scan_string_scalar(const char *p, const char *end) {
+    while (end - p >= 8) {
+        unsigned long long x;
+        memcpy(&x, p, 8);
+        if (LEPT_SWAR_HAS_ZERO(x ^ (LEPT_SWAR_ONES * '"')) | LEPT_SWAR_HAS_ZERO(x ^ (LEPT_SWAR_ONES * '\\')) |
+            LEPT_SWAR_HAS_LESS(x, 0x20)) {
+            break;
         }
-        c->json++;
+        p += 8;
+    }
+    while (p < end && !(CHAR_CLASS(*p) & LEPT_CHAR_STRING)) {
         p++;
     }
-    v->type = LEPT_NULL;
-    return LEPT_PARSE_OK;
+    return p;
 }
 
-/**
- * 解析 null、true、false
- *
- * @param c
- * @param v
- * @param literal
- * @param type
- * @return
- */
-static int lept_parse_literal(lept_context *c, lept_value *v, const char *literal, lept_type type) {
-
-    /* C 语言中表示数组长度、索引值 */
-    size_t i;
-    EXPECT(c, literal[0]);
-    for (i = 0; literal[i + 1]; i++)
-        if (c->json[i] != literal[i + 1])
-            return LEPT_PARSE_INVALID_VALUE;
-    c->json += i;
-    v->type = type;
-    return LEPT_PARSE_OK;
+static void lept_classify_scalar(const char *p, lept_block_masks *m) {
+    int i;
+    m->backslash = m->quote = m->op = m->ws = 0;
+    for (i = 0; i < 64; i++) {
+        uint64_t bit = (uint64_t) 1 << i;
+        unsigned char cls = CHAR_CLASS(p[i]);
+        m->backslash |= p[i] == '\\' ? bit : 0;
+        m->quote |= p[i] == '"' ? bit : 0;
+        m->op |= cls & LEPT_CHAR_STRUCT ? bit : 0;
+        m->ws |= cls & LEPT_CHAR_WS ? bit : 0;
+    }
 }
 
-
 /**
- * 解析 number
+ * p 处（首字节 >= 0x80）UTF-8 序列的长度（RFC 3629：不允许超长编码、代理项及大于 U+10FFFF 的码点）
  *
- * @param c
- * @param v
- * @return
+ * @param p
+ * @param end
+ * @return 不合法或不完整时返回 0
  */
-static int lept_parse_number(lept_context *c, lept_value *v) {
-    const char *p = c->json;
-
-    /* 负号 */
-    if (*p == '-') {
-        p++;
+static size_t lept_utf8_sequence(const char *p, const char *end) {
+    const unsigned char *s = (const unsigned char *) p;
+    unsigned char lo = 0x80, hi = 0xBF;
+    size_t n, i;
+    if (s[0] >= 0xC2 && s[0] <= 0xDF) {
+        n = 2;
+    } else if (s[0] >= 0xE0 && s[0] <= 0xEF) {
+        n = 3;
+        if (s[0] == 0xE0)
+            lo = 0xA0;
+        else if (s[0] == 0xED)
+            hi = 0x9F;
+    } else if (s[0] >= 0xF0 && s[0] <= 0xF4) {
+        n = 4;
+        if (s[0] == 0xF0)
+            lo = 0x90;
+        else if (s[0] == 0xF4)
+            hi = 0x8F;
+    } else {
+        return 0;
     }
+    if ((size_t) (end - p) < n || s[1] < lo || s[1] > hi) {
+        return 0;
+    }
+    for (i = 2; i < n; i++) {
+        if ((s[i] & 0xC0) != 0x80)
+            return 0;
+    }
+    return n;
+}
 
-    /* 整数 */
-    if (*p == '0') {
-        p++;
-    } else {
-        if (!ISDIGIT1TO9(*p)) {
-            return LEPT_PARSE_INVALID_VALUE;
+/* 与 scan_string 相同，另外停在不合法的 UTF-8 序列的首字节上（该字节 >= 0x80） */
+static const char *lept_scan_string_utf8_scalar(const char *p, const char *end) {
+    for (;;) {
+        size_t n;
+        while (end - p >= 8) {
+            unsigned long long x;
+            memcpy(&x, p, 8);
+            if (LEPT_SWAR_HAS_ZERO(x ^ (LEPT_SWAR_ONES * '"')) | LEPT_SWAR_HAS_ZERO(x ^ (LEPT_SWAR_ONES * '\\')) |
+                LEPT_SWAR_HAS_LESS(x, 0x20) | (x & LEPT_SWAR_HIGHS)) {
+                break;
+            }
+            p += 8;
+        }
+        while (p < end && (unsigned char) *p < 0x80 && !(CHAR_CLASS(*p) & LEPT_CHAR_STRING)) {
+            p++;
+        }
+        if (p == end || (unsigned char) *p < 0x80 || !(n = lept_utf8_sequence(p, end))) {
+            return p;
         }
-        for (p++; ISDIGIT(*p); p++);
+        p += n;
     }
+}
 
-    /* 小数 */
-    if (*p == '.') {
-        p++;
-        if (!ISDIGIT(*p)) {
-            return LEPT_PARSE_INVALID_VALUE;
+#ifdef LEPT_SIMD_X86
+
+LEPT_TARGET("sse2")
+static const char *lept_skip_whitespace_sse2(const char *p, const char *end) {
+    const __m128i sp = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *) p);
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, sp), _mm_cmpeq_epi8(x, tab)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(x, lf), _mm_cmpeq_epi8(x, cr)));
+        unsigned mask = ~(unsigned) _mm_movemask_epi8(ws) & 0xFFFF;
+        if (mask) {
+            return p + __builtin_ctz(mask);
         }
-        for (p++; ISDIGIT(*p); p++);
+        p += 16;
     }
+    return lept_skip_whitespace_scalar(p, end);
+}
 
-    /* 指数 */
-    if (*p == 'e' || *p == 'E') {
-        p++;
-        if (*p == '+' || *p == '-') {
-            p++;
-        }
-        if (!ISDIGIT(*p)) {
-            return LEPT_PARSE_INVALID_VALUE;
+LEPT_TARGET("sse2")
+static const char *lept_scan_string_sse2(const char *p, const char *end) {
+    const __m128i quote = _mm_set1_epi8('"'), slash = _mm_set1_epi8('\\'), ctrl = _mm_set1_epi8(0x1F);
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *) p);
+        /* 无符号 x <= 0x1F 等价于 min(x, 0x1F) == x */
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, slash)),
+                                       _mm_cmpeq_epi8(_mm_min_epu8(x, ctrl), x));
+        unsigned mask = (unsigned) _mm_movemask_epi8(special);
+        if (mask) {
+            return p + __builtin_ctz(mask);
         }
-        for (p++; ISDIGIT(*p); p++);
+        p += 16;
     }
+    return lept_scan_string_scalar(p, end);
+}
 
-    /* 转换成二进制，并处理过大的值 */
-    errno = 0;
-    v->u.n = strtod(c->json, NULL);
-    if (errno == ERANGE && (v->u.n == HUGE_VAL || v->u.n == -HUGE_VAL)) {
-        return LEPT_PARSE_NUMBER_TOO_BIG;
+/* SSE2 没有查表指令（pshufb），只向量化 ASCII 部分，非 ASCII 的字符逐个校验 */
+LEPT_TARGET("sse2")
+static const char *lept_scan_string_utf8_sse2(const char *p, const char *end) {
+    const __m128i quote = _mm_set1_epi8('"'), slash = _mm_set1_epi8('\\'), ctrl = _mm_set1_epi8(0x1F);
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *) p);
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, slash)),
+                                       _mm_cmpeq_epi8(_mm_min_epu8(x, ctrl), x));
+        /* movemask 直接取出各字节的最高位，即非 ASCII 字节 */
+        unsigned mask = (unsigned) (_mm_movemask_epi8(special) | _mm_movemask_epi8(x));
+        size_t n;
+        if (!mask) {
+            p += 16;
+            continue;
+        }
+        p += __builtin_ctz(mask);
+        if ((unsigned char) *p < 0x80)
+            return p;
+        do {
+            if (!(n = lept_utf8_sequence(p, end)))
+                return p;
+            p += n;
+        } while (p < end && (unsigned char) *p >= 0x80);
     }
-    v->type = LEPT_NUMBER;
-    c->json = p;
-    return LEPT_PARSE_OK;
+    return lept_scan_string_utf8_scalar(p, end);
 }
 
-/**
- * 解析 4 位十六进制数字
- *
- * @param p
- * @param u
- * @return
- */
-static const char *lept_parse_hex4(const char *p, unsigned *u) {
+LEPT_TARGET("sse2")
+static void lept_classify_sse2(const char *p, lept_block_masks *m) {
+    const __m128i backslash = _mm_set1_epi8('\\'), quote = _mm_set1_epi8('"');
+    const __m128i lower = _mm_set1_epi8(0x20), curly_open = _mm_set1_epi8('{'), curly_close = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':'), comma = _mm_set1_epi8(',');
+    const __m128i sp = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
     int i;
-    *u = 0;
-    for (i = 0; i < 4; i++) {
-        char ch = *p++;
-        *u <<= 4;
-        if (ch >= '0' && ch <= '9') {
-            *u |= ch - '0';
-        } else if (ch >= 'A' && ch <= 'F') {
-            *u |= ch - ('A' - 10);
-        } else if (ch >= 'a' && ch <= 'f') {
-            *u |= ch - ('a' - 10);
-        } else {
-            return NULL;
+    m->backslash = m->quote = m->op = m->ws = 0;
+    for (i = 0; i < 64; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (p + i));
+        /* '[' | 0x20 == '{'，']' | 0x20 == '}' */
+        __m128i y = _mm_or_si128(x, lower);
+        __m128i op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(y, curly_open), _mm_cmpeq_epi8(y, curly_close)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(x, colon), _mm_cmpeq_epi8(x, comma)));
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, sp), _mm_cmpeq_epi8(x, tab)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(x, lf), _mm_cmpeq_epi8(x, cr)));
+        m->backslash |= (uint64_t) (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(x, backslash)) << i;
+        m->quote |= (uint64_t) (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(x, quote)) << i;
+        m->op |= (uint64_t) (unsigned) _mm_movemask_epi8(op) << i;
+        m->ws |= (uint64_t) (unsigned) _mm_movemask_epi8(ws) << i;
+    }
+}
+
+LEPT_TARGET("avx2")
+static const char *lept_skip_whitespace_avx2(const char *p, const char *end) {
+    const __m256i sp = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) p);
+        __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, sp), _mm256_cmpeq_epi8(x, tab)),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(x, lf), _mm256_cmpeq_epi8(x, cr)));
+        unsigned mask = ~(unsigned) _mm256_movemask_epi8(ws);
+        if (mask) {
+            return p + __builtin_ctz(mask);
         }
+        p += 32;
     }
-    return p;
+    return lept_skip_whitespace_sse2(p, end);
+}
+
+LEPT_TARGET("avx2")
+static const char *lept_scan_string_avx2(const char *p, const char *end) {
+    const __m256i quote = _mm256_set1_epi8('"'), slash = _mm256_set1_epi8('\\'), ctrl = _mm256_set1_epi8(0x1F);
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) p);
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, quote), _mm256_cmpeq_epi8(x, slash)),
+                                          _mm256_cmpeq_epi8(_mm256_min_epu8(x, ctrl), x));
+        unsigned mask = (unsigned) _mm256_movemask_epi8(special);
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    return lept_scan_string_sse2(p, end);
 }
 
+/*
+ * 查表校验 UTF-8（Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"）：
+ * 每个字节与其前一个字节的高、低 4 位及自身的高 4 位各查一张表，三者按位与，非 0 即为错误；
+ * 另外第 3、4 字节的位置必须是后续字节
+ */
+#define LEPT_UTF8_TOO_SHORT     0x01    /* 首字节之后不是后续字节 */
+#define LEPT_UTF8_TOO_LONG      0x02    /* ASCII 之后是后续字节 */
+#define LEPT_UTF8_OVERLONG_3    0x04
+#define LEPT_UTF8_TOO_LARGE     0x08
+#define LEPT_UTF8_SURROGATE     0x10
+#define LEPT_UTF8_OVERLONG_2    0x20
+#define LEPT_UTF8_TOO_LARGE_1000 0x40
+#define LEPT_UTF8_OVERLONG_4    0x40
+#define LEPT_UTF8_TWO_CONTS     0x80    /* 两个连续的后续字节 */
+#define LEPT_UTF8_CARRY         (LEPT_UTF8_TOO_SHORT | LEPT_UTF8_TOO_LONG | LEPT_UTF8_TWO_CONTS)
+
+/* 按前一个字节的高 4 位 */
+static const unsigned char lept_utf8_byte_1_high[16] = {
+    LEPT_UTF8_TOO_LONG, LEPT_UTF8_TOO_LONG, LEPT_UTF8_TOO_LONG, LEPT_UTF8_TOO_LONG,
+    LEPT_UTF8_TOO_LONG, LEPT_UTF8_TOO_LONG, LEPT_UTF8_TOO_LONG, LEPT_UTF8_TOO_LONG,
+    LEPT_UTF8_TWO_CONTS, LEPT_UTF8_TWO_CONTS, LEPT_UTF8_TWO_CONTS, LEPT_UTF8_TWO_CONTS,
+    LEPT_UTF8_TOO_SHORT | LEPT_UTF8_OVERLONG_2,
+    LEPT_UTF8_TOO_SHORT,
+    LEPT_UTF8_TOO_SHORT | LEPT_UTF8_OVERLONG_3 | LEPT_UTF8_SURROGATE,
+    LEPT_UTF8_TOO_SHORT | LEPT_UTF8_TOO_LARGE | LEPT_UTF8_TOO_LARGE_1000 | LEPT_UTF8_OVERLONG_4
+};
+
+/* 按前一个字节的低 4 位 */
+static const unsigned char lept_utf8_byte_1_low[16] = {
+    LEPT_UTF8_CARRY | LEPT_UTF8_OVERLONG_3 | LEPT_UTF8_OVERLONG_2 | LEPT_UTF8_OVERLONG_4,
+    LEPT_UTF8_CARRY | LEPT_UTF8_OVERLONG_2,
+    LEPT_UTF8_CARRY,
+    LEPT_UTF8_CARRY,
+    LEPT_UTF8_CARRY | LEPT_UTF8_TOO_LARGE,
+    LEPT_UTF8_CARRY | LEPT_UTF8_TOO_LARGE | LEPT_UTF8_TOO_LARGE_1000,
+    LEPT_UTF8_CARRY | LEPT_UTF8_TOO_LARGE | LEPT_UTF8_TOO_LARGE_1000,
+    LEPT_UTF8_CARRY | LEPT_UTF8_TOO_LARGE | LEPT_UTF8_TOO_LARGE_1000,
+    LEPT_UTF8_CARRY | LEPT_UTF8_TOO_LARGE | LEPT_UTF8_TOO_LARGE_1000,
+    LEPT_UTF8_CARRY | LEPT_UTF8_TOO_LARGE | LEPT_UTF8_TOO_LARGE_1000,
+    LEPT_UTF8_CARRY | LEPT_UTF8_TOO_LARGE | LEPT_UTF8_TOO_LARGE_1000,
+    LEPT_UTF8_CARRY | LEPT_UTF8_TOO_LARGE | LEPT_UTF8_TOO_LARGE_1000,
+    LEPT_UTF8_CARRY | LEPT_UTF8_TOO_LARGE | LEPT_UTF8_TOO_LARGE_1000,
+    LEPT_UTF8_CARRY | LEPT_UTF8_TOO_LARGE | LEPT_UTF8_TOO_LARGE_1000 | LEPT_UTF8_SURROGATE,
+    LEPT_UTF8_CARRY | LEPT_UTF8_TOO_LARGE | LEPT_UTF8_TOO_LARGE_1000,
+    LEPT_UTF8_CARRY | LEPT_UTF8_TOO_LARGE | LEPT_UTF8_TOO_LARGE_1000
+};
+
+/* 按当前字节的高 4 位 */
+static const unsigned char lept_utf8_byte_2_high[16] = {
+    LEPT_UTF8_TOO_SHORT, LEPT_UTF8_TOO_SHORT, LEPT_UTF8_TOO_SHORT, LEPT_UTF8_TOO_SHORT,
+    LEPT_UTF8_TOO_SHORT, LEPT_UTF8_TOO_SHORT, LEPT_UTF8_TOO_SHORT, LEPT_UTF8_TOO_SHORT,
+    LEPT_UTF8_TOO_LONG | LEPT_UTF8_OVERLONG_2 | LEPT_UTF8_TWO_CONTS | LEPT_UTF8_OVERLONG_3 |
+        LEPT_UTF8_TOO_LARGE_1000 | LEPT_UTF8_OVERLONG_4,
+    LEPT_UTF8_TOO_LONG | LEPT_UTF8_OVERLONG_2 | LEPT_UTF8_TWO_CONTS | LEPT_UTF8_OVERLONG_3 | LEPT_UTF8_TOO_LARGE,
+    LEPT_UTF8_TOO_LONG | LEPT_UTF8_OVERLONG_2 | LEPT_UTF8_TWO_CONTS | LEPT_UTF8_SURROGATE | LEPT_UTF8_TOO_LARGE,
+    LEPT_UTF8_TOO_LONG | LEPT_UTF8_OVERLONG_2 | LEPT_UTF8_TWO_CONTS | LEPT_UTF8_SURROGATE | LEPT_UTF8_TOO_LARGE,
+    LEPT_UTF8_TOO_SHORT, LEPT_UTF8_TOO_SHORT, LEPT_UTF8_TOO_SHORT, LEPT_UTF8_TOO_SHORT
+};
+
+static const unsigned char lept_utf8_index[32] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31
+};
+
 /**
- * UTF-8 编码
+ * 校验 32 个字节（接在上一块 prev 之后）
  *
- * @param c
- * @param u
+ * @param x
+ * @param prev
+ * @return 非 0 的字节表示错误
  */
-static void lept_encode_utf8(lept_context *c, unsigned u) {
-    if (u <= 0x7F) {
-        PUTC(c, u & 0xFF);
-    } else if (u <= 0x7FF) {
-        PUTC(c, 0xC0 | ((u >> 6) & 0xFF));
-        PUTC(c, 0x80 | (u & 0x3F));
-    } else if (u <= 0xFFFF) {
-        PUTC(c, 0xE0 | ((u >> 12) & 0xFF));
-        PUTC(c, 0x80 | ((u >> 6) & 0x3F));
-        PUTC(c, 0x80 | (u & 0x3F));
-    } else {
-        assert(u <= 0x10FFFF);
-        PUTC(c, 0xF0 | ((u >> 18) & 0xFF));
-        PUTC(c, 0x80 | ((u >> 12) & 0x3F));
-        PUTC(c, 0x80 | ((u >> 6) & 0x3F));
-        PUTC(c, 0x80 | (u & 0x3F));
-    }
+LEPT_TARGET("avx2")
+static __m256i lept_utf8_check_avx2(__m256i x, __m256i prev) {
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i byte_1_high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) lept_utf8_byte_1_high));
+    const __m256i byte_1_low = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) lept_utf8_byte_1_low));
+    const __m256i byte_2_high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) lept_utf8_byte_2_high));
+    /* 前 1～3 个字节：alignr 只在 128 位通道内移动，先拼出跨通道的部分 */
+    __m256i shifted = _mm256_permute2x128_si256(prev, x, 0x21);
+    __m256i prev1 = _mm256_alignr_epi8(x, shifted, 15);
+    __m256i prev2 = _mm256_alignr_epi8(x, shifted, 14);
+    __m256i prev3 = _mm256_alignr_epi8(x, shifted, 13);
+    __m256i sc = _mm256_and_si256(
+        _mm256_and_si256(_mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                         _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, nibble))),
+        _mm256_shuffle_epi8(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+    /* 前 2 个字节 >= 0xE0 或前 3 个字节 >= 0xF0 时，当前字节必须是后续字节（表中对应 TWO_CONTS） */
+    __m256i must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8((char) (0xE0 - 0x80))),
+                                     _mm256_subs_epu8(prev3, _mm256_set1_epi8((char) (0xF0 - 0x80))));
+    return _mm256_xor_si256(_mm256_and_si256(must23, _mm256_set1_epi8((char) 0x80)), sc);
 }
 
 /**
+ * 向量部分结束时回到 p 之前未完的序列的首字节（p 之前的内容已校验），由逐字符的实现接着处理
  *
- * @param c
- * @param str
- * @param len
+ * @param start
+ * @param p
  * @return
  */
-static int lept_parse_string_raw(lept_context *c, char **str, size_t *len) {
-    size_t head = c->top;
-    unsigned u, u2;
-    const char *p;
-    EXPECT(c, '\"');
-    p = c->json;
-    for (;;) {
-        char ch = *p++;
-        switch (ch) {
-            /* 找到末尾的引号 */
-            case '\"':
-                *len = c->top - head;
-                *str = lept_context_pop(c, *len);
-                c->json = p;
-                return LEPT_PARSE_OK;
-                /* 找到反斜杠，添加转义字符 */
-            case '\\':
-                switch (*p++) {
-                    case '\"':
-                        PUTC(c, '\"');
-                        break;
-                    case '\\':
-                        PUTC(c, '\\');
-                        break;
-                    case '/':
-                        PUTC(c, '/');
-                        break;
-                    case 'b':
-                        PUTC(c, '\b');
-                        break;
-                    case 'f':
-                        PUTC(c, '\f');
-                        break;
-                    case 'n':
-                        PUTC(c, '\n');
-                        break;
-                    case 'r':
-                        PUTC(c, '\r');
-                        break;
-                    case 't':
-                        PUTC(c, '\t');
-                        break;
-                    case 'u':
-                        if (!(p = lept_parse_hex4(p, &u)))
-                            STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_HEX);
-                        if (u >= 0xD800 && u <= 0xDBFF) { /* surrogate pair */
-                            if (*p++ != '\\')
-                                STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_SURROGATE);
-                            if (*p++ != 'u')
-                                STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_SURROGATE);
-                            if (!(p = lept_parse_hex4(p, &u2)))
-                                STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_HEX);
-                            if (u2 < 0xDC00 || u2 > 0xDFFF)
-                                STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_SURROGATE);
-                            u = (((u - 0xD800) << 10) | (u2 - 0xDC00)) + 0x10000;
-                        }
-                        lept_encode_utf8(c, u);
-                        break;
-                    default:
-                        STRING_ERROR(LEPT_PARSE_INVALID_STRING_ESCAPE);
-                }
+static const char *lept_utf8_boundary(const char *start, const char *p) {
+    const char *q;
+    for (q = p; q > start && q > p - 3; q--) {
+        unsigned char ch = (unsigned char) q[-1];
+        if (ch < 0x80)
+            break;
+        if (ch >= 0xC0)
+            return q - 1;
+    }
+    return p;
+}
+
+LEPT_TARGET("avx2")
+static const char *lept_scan_string_utf8_avx2(const char *p, const char *end) {
+    const __m256i quote = _mm256_set1_epi8('"'), slash = _mm256_set1_epi8('\\'), ctrl = _mm256_set1_epi8(0x1F);
+    const char *start = p;
+    __m256i prev = _mm256_setzero_si256();
+    int tail = 0;   /* 上一块含有非 ASCII 字节，其结尾的序列可能未完 */
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) p), error;
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, quote), _mm256_cmpeq_epi8(x, slash)),
+                                          _mm256_cmpeq_epi8(_mm256_min_epu8(x, ctrl), x));
+        unsigned mask;
+        /* 常见情况：全是 ASCII 且不含结束字符，与 scan_string 相比只多一次按位或 */
+        if (!tail && _mm256_movemask_epi8(_mm256_or_si256(special, x)) == 0) {
+            p += 32;
+            continue;
+        }
+        if ((mask = (unsigned) _mm256_movemask_epi8(special)) != 0) {
+            /* 只校验结束字符之前的部分：之后的字节清零（视为 ASCII），在此截断的序列即为错误 */
+            __m256i keep = _mm256_cmpgt_epi8(_mm256_set1_epi8((char) __builtin_ctz(mask)),
+                                             _mm256_loadu_si256((const __m256i *) lept_utf8_index));
+            error = lept_utf8_check_avx2(_mm256_and_si256(x, keep), prev);
+            if (!_mm256_testz_si256(error, error))
                 break;
-            case '\0':
-                STRING_ERROR(LEPT_PARSE_MISS_QUOTATION_MARK);
-            default:
-                if ((unsigned char) ch < 0x20)
-                    STRING_ERROR(LEPT_PARSE_INVALID_STRING_CHAR);
-                PUTC(c, ch);
+            return p + __builtin_ctz(mask);
         }
+        error = lept_utf8_check_avx2(x, prev);
+        if (!_mm256_testz_si256(error, error))
+            break;
+        tail = _mm256_movemask_epi8(x) != 0;
+        prev = x;
+        p += 32;
+    }
+    /* 不足一块，或发现错误（由逐字符的实现找出其位置） */
+    return lept_scan_string_utf8_sse2(lept_utf8_boundary(start, p), end);
+}
+
+LEPT_TARGET("avx2")
+static void lept_classify_avx2(const char *p, lept_block_masks *m) {
+    const __m256i backslash = _mm256_set1_epi8('\\'), quote = _mm256_set1_epi8('"');
+    const __m256i lower = _mm256_set1_epi8(0x20), curly_open = _mm256_set1_epi8('{');
+    const __m256i curly_close = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':'), comma = _mm256_set1_epi8(',');
+    const __m256i sp = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+    int i;
+    m->backslash = m->quote = m->op = m->ws = 0;
+    for (i = 0; i < 64; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (p + i));
+        __m256i y = _mm256_or_si256(x, lower);
+        __m256i op = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(y, curly_open), _mm256_cmpeq_epi8(y, curly_close)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(x, colon), _mm256_cmpeq_epi8(x, comma)));
+        __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, sp), _mm256_cmpeq_epi8(x, tab)),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(x, lf), _mm256_cmpeq_epi8(x, cr)));
+        m->backslash |= (uint64_t) (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, backslash)) << i;
+        m->quote |= (uint64_t) (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, quote)) << i;
+        m->op |= (uint64_t) (unsigned) _mm256_movemask_epi8(op) << i;
+        m->ws |= (uint64_t) (unsigned) _mm256_movemask_epi8(ws) << i;
     }
 }
 
+#endif
+
+static const lept_simd_ops lept_simd_ops_table[] = {
+    /* LEPT_SIMD_SCALAR */
+    {lept_skip_whitespace_scalar, lept_scan_string_scalar, lept_scan_string_utf8_scalar, lept_classify_scalar},
+#ifdef LEPT_SIMD_X86
+    /* LEPT_SIMD_SSE2 */
+    {lept_skip_whitespace_sse2,   lept_scan_string_sse2,   lept_scan_string_utf8_sse2,   lept_classify_sse2},
+    /* LEPT_SIMD_AVX2 */
+    {lept_skip_whitespace_avx2,   lept_scan_string_avx2,   lept_scan_string_utf8_avx2,   lept_classify_avx2},
+#endif
+};
+
+/* 当前使用的实现，首次解析时初始化 */
+static const lept_simd_ops *lept_simd = NULL;
+static lept_simd_level lept_simd_current = LEPT_SIMD_SCALAR;
+
 /**
- * 解析 string
+ * 检测 CPU 支持的最高级别
  *
- * @param c
- * @param v
  * @return
  */
-static int lept_parse_string(lept_context *c, lept_value *v) {
-    int ret;
-    char *s;
-    size_t len;
-    if ((ret = lept_parse_string_raw(c, &s, &len)) == LEPT_PARSE_OK) {
-        lept_set_string(v, s, len);
+static lept_simd_level lept_simd_detect(void) {
+#ifdef LEPT_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return LEPT_SIMD_AVX2;
     }
-    return ret;
+    if (__builtin_cpu_supports("sse2")) {
+        return LEPT_SIMD_SSE2;
+    }
+#endif
+    return LEPT_SIMD_SCALAR;
 }
 
 /**
- * 解析 array
+ * 按级别选择实现，超出 CPU 支持范围时降到所支持的最高级别
  *
- * @param c
- * @param v
- * @return
+ * @param level
+ * @return 实际使用的级别
  */
-static int lept_parse_array(lept_context *c, lept_value *v) {
-    size_t i, size = 0;
-    int ret;
-    EXPECT(c, '[');
-    lept_parse_whitespace(c);
-
-    /* 空数组 */
-    if (*c->json == ']') {
-        c->json++;
-        lept_set_array(v, 0);
-        return LEPT_PARSE_OK;
+static lept_simd_level lept_simd_select(lept_simd_level level) {
+    lept_simd_level max = lept_simd_detect();
+    /* 不合法的级别按 LEPT_SIMD_AUTO 处理，保证表的下标在范围内 */
+    if (level < LEPT_SIMD_SCALAR || level > max) {
+        level = max;
     }
-    for (;;) {
-        lept_value e;
-        lept_init(&e);
-        /* 解析当前元素，解析失败则退出循环 */
-        if ((ret = lept_parse_value(c, &e)) != LEPT_PARSE_OK) {
-            break;;
-        }
-        /* 为 c 分配 sizeof(lept_value) 个字节的内存*/
-        void *mem = lept_context_push(c, sizeof(lept_value));
-        /* 把 &e 的 sizeof(lept_value) 个字节复制到 lept_context_push(c, sizeof(lept_value)) */
-        memcpy(mem, &e, sizeof(lept_value));
-        size++;
-        lept_parse_whitespace(c);
+    lept_simd_current = level;
+    lept_simd = &lept_simd_ops_table[level];
+    return level;
+}
 
-        /* 解析一个元素后遇到逗号，跳过 */
-        if (*c->json == ',') {
-            c->json++;
-            lept_parse_whitespace(c);
-        } else if (*c->json == ']') {
-            c->json++;
-            v->type = LEPT_ARRAY;
-            v->u.a.size = size;
-            size *= sizeof(lept_value);
-            memcpy(v->u.a.e = (lept_value *) malloc(size), lept_context_pop(c, size), size);
-            return LEPT_PARSE_OK;
-        } else {
-            ret = LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
-            break;
+/**
+ * 选择实现：默认为 CPU 支持的最高级别，可用环境变量 LEPT_SIMD=scalar|sse2|avx2 指定
+ */
+static void lept_simd_init(void) {
+    lept_simd_level level = LEPT_SIMD_AUTO;
+    const char *env = getenv("LEPT_SIMD");
+    if (env != NULL) {
+        if (strcmp(env, "scalar") == 0) {
+            level = LEPT_SIMD_SCALAR;
+        } else if (strcmp(env, "sse2") == 0) {
+            level = LEPT_SIMD_SSE2;
+        } else if (strcmp(env, "avx2") == 0) {
+            level = LEPT_SIMD_AVX2;
         }
     }
-    for (i = 0; i < size; i++) {
-        lept_free((lept_value *) lept_context_pop(c, sizeof(lept_value)));
-    }
-    return ret;
+    lept_simd_select(level);
 }
 
+/* 首次使用前初始化：多个线程同时首次解析时只初始化一次 */
+#ifdef LEPT_THREADS
+static pthread_once_t lept_simd_once = PTHREAD_ONCE_INIT;
+#define LEPT_SIMD_INIT() pthread_once(&lept_simd_once, lept_simd_init)
+#else
+#define LEPT_SIMD_INIT() do { if (lept_simd == NULL) lept_simd_init(); } while(0)
+#endif
+
 /**
+ * 设置扫描使用的指令集级别，超出 CPU 支持范围时降到所支持的最高级别
  *
- * @param c
- * @param v
- * @return
+ * @param level
+ * @return 实际使用的级别
  */
-static int lept_parse_object(lept_context *c, lept_value *v) {
-    size_t i, size;
-    lept_member m;
-    int ret;
-    EXPECT(c, '{');
-    lept_parse_whitespace(c);
-    if (*c->json == '}') {
-        c->json++;
-        lept_set_object(v, 0);
-        return LEPT_PARSE_OK;
-    }
-    m.k = NULL;
-    size = 0;
-    for (;;) {
-        char *str;
-        lept_init(&m.v);
-        /* parse key */
-        if (*c->json != '"') {
-            ret = LEPT_PARSE_MISS_KEY;
-            break;
-        }
-        if ((ret = lept_parse_string_raw(c, &str, &m.klen)) != LEPT_PARSE_OK) {
-            break;
-        }
-        memcpy(m.k = (char *) malloc(m.klen + 1), str, m.klen);
-        m.k[m.klen] = '\0';
-        /* parse ws colon ws */
-        lept_parse_whitespace(c);
-        if (*c->json != ':') {
-            ret = LEPT_PARSE_MISS_COLON;
-            break;
-        }
-        c->json++;
-        lept_parse_whitespace(c);
-        /* parse value */
-        if ((ret = lept_parse_value(c, &m.v)) != LEPT_PARSE_OK)
-            break;
-        memcpy(lept_context_push(c, sizeof(lept_member)), &m, sizeof(lept_member));
-        size++;
-        m.k = NULL; /* ownership is transferred to member on stack */
-        /* parse ws [comma | right-curly-brace] ws */
-        lept_parse_whitespace(c);
-        if (*c->json == ',') {
-            c->json++;
-            lept_parse_whitespace(c);
-        } else if (*c->json == '}') {
-            c->json++;
-            lept_set_object(v, size);
-            memcpy(v->u.o.m, lept_context_pop(c, sizeof(lept_member) * size), sizeof(lept_member) * size);
-            v->u.o.size = size;
-            return LEPT_PARSE_OK;
-        } else {
-            ret = LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
-            break;
-        }
-    }
-    /* Pop and free members on the stack */
-    free(m.k);
-    for (i = 0; i < size; i++) {
-        lept_member *m = (lept_member *) lept_context_pop(c, sizeof(lept_member));
-        free(m->k);
-        lept_free(&m->v);
-    }
-    v->type = LEPT_NULL;
-    return ret;
+lept_simd_level lept_set_simd_level(lept_simd_level level) {
+    /* 先完成默认的初始化，之后的首次解析不会覆盖这里的设置 */
+    LEPT_SIMD_INIT();
+    return lept_simd_select(level);
 }
 
 /**
- * 解析 JSON 值
+ * 获取当前使用的指令集级别
  *
- * @param c
- * @param v
  * @return
  */
-static int lept_parse_value(lept_context *c, lept_value *v) {
-    /* 根据首字符选择判断分支 */
-    switch (*c->json) {
-        case 'n':
-            return lept_parse_literal(c, v, "null", LEPT_NULL);
-        case 't':
-            return lept_parse_literal(c, v, "true", LEPT_TRUE);
+lept_simd_level lept_get_simd_level(void) {
+    LEPT_SIMD_INIT();
+    return lept_simd_current;
+}
+
+/**
+ * 去除有效文本前面所有的空白字符
+ * 值之间通常没有空白或只有一个空白，先用标量判断，较长的空白（缩进等）再交给向量实现
+ *
+ * @param c
+ */
+static void lept_parse_whitespace(lept_context *c) {
+    const char *p = c->json, *end = c->end;
+    if (p == end || !ISWS(*p)) {
+        return;
+    }
+    if (++p == end || !ISWS(*p)) {
+        c->json = p;
+        return;
+    }
+    c->json = lept_simd->skip_whitespace(p, end);
+}
+
+/**
+ * 解析 null、true、false
+ *
+ * @param c
+ * @param v
+ * @param literal
+ * @param type
+ * @return
+ */
+static int lept_parse_literal(lept_context *c, lept_value *v, const char *literal, lept_type type) {
+
+    /* C 语言中表示数组长度、索引值 */
+    size_t i;
+    EXPECT(c, literal[0]);
+    for (i = 0; literal[i + 1]; i++)
+        if (c->json + i >= c->end || c->json[i] != literal[i + 1])
+            return LEPT_PARSE_INVALID_VALUE;
+    c->json += i;
+    v->type = type;
+    return LEPT_PARSE_OK;
+}
+
+
+/*
+ * 十进制数转换为 double：不使用 strtod()，因此与区域设置（小数点字符）无关，也不依赖 errno
+ * 1. 有效数字不超过 19 位时，先尝试 Clinger 快速路径（尾数与 10 的幂都能精确表示）
+ * 2. 否则用 Eisel-Lemire 算法：尾数乘以 128 位精度的 5 的幂，绝大多数情况下可直接得到正确舍入的结果
+ * 3. 极少数无法判定舍入方向的情况，用高精度十进制数逐步移位的慢速方法
+ */
+
+#define LEPT_POW5_MIN_Q (-342)
+#define LEPT_POW5_MAX_Q 308
+
+/* 5^q（q = -342..308）截断到 128 位，最高位对齐到第 127 位，每项依次为高、低 64 位 */
+static const uint64_t lept_pow5_128[] = {
+    0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL,
+    0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+    0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL,
+    0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+    0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL,
+    0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+    0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL,
+    0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+    0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL,
+    0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+    0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL,
+    0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+    0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL,
+    0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+    0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL,
+    0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+    0x84a57695fe98746dULL, 0x014bb630f7604b57ULL,
+    0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+    0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL,
+    0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+    0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL,
+    0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+    0xfd00b897478238d0ULL, 0x8920b098955522b4ULL,
+    0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+    0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL,
+    0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+    0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL,
+    0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+    0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL,
+    0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+    0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL,
+    0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+    0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL,
+    0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+    0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL,
+    0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+    0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL,
+    0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+    0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL,
+    0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+    0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL,
+    0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+    0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL,
+    0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+    0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL,
+    0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+    0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL,
+    0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+    0xa37fce126597973cULL, 0xe50ff107bab528a0ULL,
+    0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+    0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL,
+    0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+    0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL,
+    0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+    0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL,
+    0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+    0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL,
+    0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+    0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL,
+    0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+    0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL,
+    0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+    0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL,
+    0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+    0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL,
+    0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+    0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL,
+    0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+    0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL,
+    0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+    0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL,
+    0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+    0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL,
+    0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+    0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL,
+    0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+    0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL,
+    0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+    0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL,
+    0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+    0xc987434744ac874eULL, 0xa327ffb266b56220ULL,
+    0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+    0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL,
+    0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+    0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL,
+    0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+    0xc0314325637a1939ULL, 0xfa911155fefb5308ULL,
+    0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+    0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL,
+    0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+    0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL,
+    0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+    0xb749faed14125d36ULL, 0xcef980ec671f667bULL,
+    0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+    0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL,
+    0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+    0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL,
+    0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+    0xaecc49914078536dULL, 0x58fae9f773886e18ULL,
+    0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+    0x888f99797a5e012dULL, 0x6d8406c952429603ULL,
+    0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+    0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL,
+    0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+    0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL,
+    0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+    0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL,
+    0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+    0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL,
+    0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+    0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL,
+    0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+    0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL,
+    0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+    0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL,
+    0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+    0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL,
+    0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+    0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL,
+    0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+    0xb913179899f68584ULL, 0x28e2557b59846e3fULL,
+    0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+    0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL,
+    0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+    0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL,
+    0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+    0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL,
+    0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+    0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL,
+    0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+    0xd77485cb25823ac7ULL, 0x7d633293366b828bULL,
+    0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+    0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL,
+    0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+    0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL,
+    0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+    0xcd795be870516656ULL, 0x67902e276c921f8bULL,
+    0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+    0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL,
+    0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+    0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL,
+    0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+    0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL,
+    0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+    0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL,
+    0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+    0xef340a98172aace4ULL, 0x86fb897116c87c34ULL,
+    0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+    0xbae0a846d2195712ULL, 0x8974836059cca109ULL,
+    0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+    0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL,
+    0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+    0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL,
+    0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+    0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL,
+    0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+    0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL,
+    0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+    0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL,
+    0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+    0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL,
+    0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+    0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL,
+    0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+    0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL,
+    0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+    0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL,
+    0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+    0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL,
+    0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+    0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL,
+    0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+    0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL,
+    0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+    0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL,
+    0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+    0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL,
+    0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+    0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL,
+    0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+    0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL,
+    0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+    0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL,
+    0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+    0x8c974f7383725573ULL, 0x1e414218c73a13fbULL,
+    0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+    0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL,
+    0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+    0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL,
+    0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+    0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL,
+    0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+    0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL,
+    0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+    0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL,
+    0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+    0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL,
+    0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+    0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL,
+    0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+    0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL,
+    0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+    0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL,
+    0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+    0xbe89523386091465ULL, 0xf6bbb397f1135823ULL,
+    0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+    0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL,
+    0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+    0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL,
+    0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+    0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL,
+    0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+    0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL,
+    0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+    0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL,
+    0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+    0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL,
+    0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+    0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL,
+    0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+    0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL,
+    0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+    0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL,
+    0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+    0x811ccc668829b887ULL, 0x0806357d5a3f525fULL,
+    0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+    0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL,
+    0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+    0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL,
+    0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+    0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL,
+    0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+    0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL,
+    0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+    0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL,
+    0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+    0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL,
+    0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+    0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL,
+    0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+    0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL,
+    0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+    0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL,
+    0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+    0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL,
+    0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+    0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL,
+    0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+    0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL,
+    0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+    0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL,
+    0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+    0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL,
+    0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+    0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL,
+    0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+    0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL,
+    0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+    0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL,
+    0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+    0xc24452da229b021bULL, 0xfbe85badce996168ULL,
+    0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+    0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL,
+    0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+    0xed246723473e3813ULL, 0x290123e9aab23b68ULL,
+    0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+    0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL,
+    0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+    0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL,
+    0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+    0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL,
+    0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+    0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL,
+    0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+    0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL,
+    0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+    0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL,
+    0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+    0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL,
+    0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+    0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL,
+    0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+    0xcdb02555653131b6ULL, 0x3792f412cb06794dULL,
+    0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+    0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL,
+    0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+    0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL,
+    0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+    0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL,
+    0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+    0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL,
+    0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+    0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL,
+    0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+    0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL,
+    0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+    0x9226712162ab070dULL, 0xcab3961304ca70e8ULL,
+    0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+    0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL,
+    0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+    0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL,
+    0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+    0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL,
+    0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+    0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL,
+    0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+    0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL,
+    0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+    0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL,
+    0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+    0xcfb11ead453994baULL, 0x67de18eda5814af2ULL,
+    0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+    0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL,
+    0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+    0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL,
+    0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+    0xc612062576589ddaULL, 0x95364afe032a819eULL,
+    0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+    0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL,
+    0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+    0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL,
+    0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+    0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL,
+    0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+    0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL,
+    0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+    0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL,
+    0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+    0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL,
+    0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+    0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL,
+    0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+    0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL,
+    0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+    0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL,
+    0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+    0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL,
+    0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+    0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL,
+    0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+    0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL,
+    0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+    0x8000000000000000ULL, 0x0000000000000000ULL,
+    0xa000000000000000ULL, 0x0000000000000000ULL,
+    0xc800000000000000ULL, 0x0000000000000000ULL,
+    0xfa00000000000000ULL, 0x0000000000000000ULL,
+    0x9c40000000000000ULL, 0x0000000000000000ULL,
+    0xc350000000000000ULL, 0x0000000000000000ULL,
+    0xf424000000000000ULL, 0x0000000000000000ULL,
+    0x9896800000000000ULL, 0x0000000000000000ULL,
+    0xbebc200000000000ULL, 0x0000000000000000ULL,
+    0xee6b280000000000ULL, 0x0000000000000000ULL,
+    0x9502f90000000000ULL, 0x0000000000000000ULL,
+    0xba43b74000000000ULL, 0x0000000000000000ULL,
+    0xe8d4a51000000000ULL, 0x0000000000000000ULL,
+    0x9184e72a00000000ULL, 0x0000000000000000ULL,
+    0xb5e620f480000000ULL, 0x0000000000000000ULL,
+    0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+    0x8e1bc9bf04000000ULL, 0x0000000000000000ULL,
+    0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+    0xde0b6b3a76400000ULL, 0x0000000000000000ULL,
+    0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+    0xad78ebc5ac620000ULL, 0x0000000000000000ULL,
+    0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+    0x878678326eac9000ULL, 0x0000000000000000ULL,
+    0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+    0xd3c21bcecceda100ULL, 0x0000000000000000ULL,
+    0x84595161401484a0ULL, 0x0000000000000000ULL,
+    0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL,
+    0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+    0x813f3978f8940984ULL, 0x4000000000000000ULL,
+    0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+    0xc9f2c9cd04674edeULL, 0xa400000000000000ULL,
+    0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+    0x9dc5ada82b70b59dULL, 0xf020000000000000ULL,
+    0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+    0xf684df56c3e01bc6ULL, 0xc732000000000000ULL,
+    0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+    0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL,
+    0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+    0x96769950b50d88f4ULL, 0x1314448000000000ULL,
+    0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+    0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL,
+    0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+    0xb7abc627050305adULL, 0xf14a3d9e40000000ULL,
+    0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+    0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL,
+    0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+    0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL,
+    0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+    0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL,
+    0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+    0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL,
+    0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+    0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL,
+    0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+    0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL,
+    0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+    0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL,
+    0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+    0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL,
+    0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+    0x9f4f2726179a2245ULL, 0x01d762422c946590ULL,
+    0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+    0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL,
+    0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+    0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL,
+    0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+    0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL,
+    0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+    0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL,
+    0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+    0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL,
+    0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+    0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL,
+    0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+    0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL,
+    0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+    0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL,
+    0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+    0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL,
+    0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+    0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL,
+    0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+    0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL,
+    0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+    0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL,
+    0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+    0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL,
+    0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+    0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL,
+    0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+    0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL,
+    0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+    0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL,
+    0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+    0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL,
+    0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+    0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL,
+    0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+    0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL,
+    0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+    0x924d692ca61be758ULL, 0x593c2626705f9c56ULL,
+    0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+    0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL,
+    0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+    0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL,
+    0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+    0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL,
+    0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+    0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL,
+    0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+    0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL,
+    0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+    0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL,
+    0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+    0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL,
+    0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+    0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL,
+    0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+    0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL,
+    0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+    0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL,
+    0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+    0x9ae757596946075fULL, 0x3375788de9b06958ULL,
+    0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+    0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL,
+    0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+    0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL,
+    0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+    0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL,
+    0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+    0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL,
+    0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+    0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL,
+    0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+    0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL,
+    0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+    0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL,
+    0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+    0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL,
+    0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+    0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL,
+    0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+    0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL,
+    0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+    0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL,
+    0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+    0x802221226be55a64ULL, 0xc2494954da2c9789ULL,
+    0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+    0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL,
+    0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+    0x9c69a97284b578d7ULL, 0xff2a760414536efbULL,
+    0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+    0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL,
+    0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+    0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL,
+    0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+    0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL,
+    0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+    0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL,
+    0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+    0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL,
+    0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+    0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL,
+    0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+    0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL,
+    0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+    0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL,
+    0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+    0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL,
+    0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+    0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL,
+    0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+    0xa59bc234db398c25ULL, 0x43fab9837e699095ULL,
+    0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+    0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL,
+    0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+    0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL,
+    0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+    0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL,
+    0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+    0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL,
+    0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+    0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL,
+    0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+    0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL,
+    0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+    0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL,
+    0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+    0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL,
+    0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+    0x8fa475791a569d10ULL, 0xf96e017d694487bcULL,
+    0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+    0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL,
+    0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+    0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL,
+    0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+    0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL,
+    0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+    0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL,
+    0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+    0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL,
+    0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+    0x82a45b450226b39cULL, 0xecc0024661173473ULL,
+    0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+    0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL,
+    0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+    0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL,
+    0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+    0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL,
+    0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+    0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL,
+    0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+    0x98165af37b2153deULL, 0xc3727a337a8b704aULL,
+    0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+    0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL,
+    0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+    0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL,
+    0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+    0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL,
+    0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+    0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL,
+    0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+    0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL,
+    0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+    0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL,
+    0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+    0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL,
+    0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+    0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL,
+    0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+    0x83ea2b892091e44dULL, 0x934aed0aab460432ULL,
+    0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+    0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL,
+    0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+    0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL,
+    0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+    0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL,
+    0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+    0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL,
+    0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+    0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL,
+    0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+    0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL,
+    0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+    0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL,
+    0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+    0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL,
+    0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+    0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL,
+    0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+    0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL,
+    0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+    0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL,
+    0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+    0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL,
+    0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+    0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL,
+    0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+    0x8533285c936b35deULL, 0xd53a88958f87275fULL,
+    0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+    0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL,
+    0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+    0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL,
+    0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+    0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL,
+    0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+    0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL,
+    0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+    0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL,
+    0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+    0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL,
+    0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+    0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL,
+    0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+    0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL,
+    0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+    0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL,
+    0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+    0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL,
+    0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+    0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL,
+    0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+    0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL,
+    0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+    0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL,
+    0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+    0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL,
+    0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+    0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL,
+    0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+    0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL,
+    0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+    0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL,
+    0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+    0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL,
+    0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+    0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL,
+    0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+    0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL,
+    0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+    0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL,
+    0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+    0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL,
+    0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+    0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL,
+    0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+    0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL,
+    0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+    0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL
+};
+
+/* 可精确表示的 10 的幂 */
+static const double lept_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * 64 位乘法，返回 128 位结果的低 64 位，高 64 位存入 hi
+ *
+ * @param a
+ * @param b
+ * @param hi
+ * @return
+ */
+static uint64_t lept_mul128(uint64_t a, uint64_t b, uint64_t *hi) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 r = (unsigned __int128) a * b;
+    *hi = (uint64_t) (r >> 64);
+    return (uint64_t) r;
+#else
+    uint64_t a_lo = (uint32_t) a, a_hi = a >> 32, b_lo = (uint32_t) b, b_hi = b >> 32;
+    uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+    uint64_t mid = (p0 >> 32) + (uint32_t) p1 + (uint32_t) p2;
+    *hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+    return (mid << 32) | (uint32_t) p0;
+#endif
+}
+
+/**
+ * 前导 0 的个数，x 不为 0
+ *
+ * @param x
+ * @return
+ */
+static int lept_clz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & ((uint64_t) 1 << 63))) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/**
+ * Eisel-Lemire 算法：计算 w * 10^q 最接近的 double（不含符号位）
+ *
+ * @param q
+ * @param w
+ * @param bits  IEEE 754 双精度的位表示
+ * @return 成功返回 0，无法确定正确舍入时返回 -1
+ */
+static int lept_eisel_lemire(int64_t q, uint64_t w, uint64_t *bits) {
+    uint64_t lo, hi, hi2, mantissa;
+    int64_t power2;
+    int lz, upperbit;
+    size_t index;
+    if (w == 0 || q < LEPT_POW5_MIN_Q) {
+        *bits = 0;
+        return 0;
+    }
+    if (q > LEPT_POW5_MAX_Q) {
+        *bits = (uint64_t) 0x7FF << 52;
+        return 0;
+    }
+    lz = lept_clz64(w);
+    w <<= lz;
+    /* 只需 55 位精度：低位全为 1 时才需要乘以 5 的幂的低 64 位修正 */
+    index = 2 * (size_t) (q - LEPT_POW5_MIN_Q);
+    lo = lept_mul128(w, lept_pow5_128[index], &hi);
+    if ((hi & 0x1FF) == 0x1FF) {
+        lept_mul128(w, lept_pow5_128[index + 1], &hi2);
+        lo += hi2;
+        if (hi2 > lo) {
+            hi++;
+        }
+    }
+    if (lo == UINT64_MAX && (q < -27 || q > 55)) {
+        return -1;
+    }
+    upperbit = (int) (hi >> 63);
+    mantissa = hi >> (upperbit + 9);
+    /* floor(log2(10^q)) = floor(q * log2(10))，再加上偏置 1023 */
+    power2 = (((152170 + 65536) * q) >> 16) + 63 + upperbit - lz + 1023;
+    if (power2 <= 0) {
+        /* 非规格化数 */
+        if (-power2 + 1 >= 64) {
+            *bits = 0;
+            return 0;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < ((uint64_t) 1 << 52) ? 0 : 1;
+        *bits = mantissa | (uint64_t) power2 << 52;
+        return 0;
+    }
+    /* 恰好在两个 double 正中间时舍入到偶数 */
+    if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << (upperbit + 9)) == hi) {
+        mantissa &= ~(uint64_t) 1;
+    }
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= ((uint64_t) 2 << 52)) {
+        mantissa = (uint64_t) 1 << 52;
+        power2++;
+    }
+    mantissa &= ~((uint64_t) 1 << 52);
+    if (power2 >= 0x7FF) {
+        power2 = 0x7FF;
+        mantissa = 0;
+    }
+    *bits = mantissa | (uint64_t) power2 << 52;
+    return 0;
+}
+
+/* 慢速路径使用的高精度十进制数：0.d[0]d[1]...d[nd-1] * 10^dp */
+#define LEPT_DECIMAL_DIGITS 800
+
+/* 每次移位的最大位数，保证中间结果不超过 64 位 */
+#define LEPT_DECIMAL_MAX_SHIFT 60
+
+typedef struct {
+    int nd, dp;
+    int trunc;      /* d 之后还有被丢弃的非零数字 */
+    unsigned char d[LEPT_DECIMAL_DIGITS];
+} lept_decimal;
+
+static void lept_decimal_trim(lept_decimal *a) {
+    while (a->nd > 0 && a->d[a->nd - 1] == 0) {
+        a->nd--;
+    }
+    if (a->nd == 0) {
+        a->dp = 0;
+    }
+}
+
+/**
+ * 从已经过语法检查的数字文本（不含负号）读入
+ *
+ * @param a
+ * @param p
+ * @param end
+ */
+static void lept_decimal_set(lept_decimal *a, const char *p, const char *end) {
+    int ndigits = 0, sawdot = 0, e = 0, eneg = 0;
+    a->nd = a->dp = a->trunc = 0;
+    for (; p < end; p++) {
+        if (*p == '.') {
+            sawdot = 1;
+            a->dp = ndigits;
+        } else if (ISDIGIT(*p)) {
+            if (*p == '0' && a->nd == 0) {
+                /* 忽略前导 0 */
+                a->dp--;
+                continue;
+            }
+            ndigits++;
+            if (a->nd < LEPT_DECIMAL_DIGITS) {
+                a->d[a->nd++] = (unsigned char) (*p - '0');
+            } else if (*p != '0') {
+                a->trunc = 1;
+            }
+        } else {
+            break;
+        }
+    }
+    if (!sawdot) {
+        a->dp = ndigits;
+    }
+    if (p < end) {
+        /* 指数 */
+        p++;
+        if (*p == '+' || *p == '-') {
+            eneg = *p++ == '-';
+        }
+        for (; p < end; p++) {
+            if (e < 100000) {
+                e = e * 10 + (*p - '0');
+            }
+        }
+        a->dp += eneg ? -e : e;
+    }
+    lept_decimal_trim(a);
+}
+
+static void lept_decimal_left_shift(lept_decimal *a, unsigned k) {
+    /* 乘以 2^60 最多增加 19 位数字 */
+    unsigned char buf[LEPT_DECIMAL_DIGITS + 20];
+    int r = a->nd, w = a->nd + 20, count, i;
+    uint64_t n = 0;
+    while (r > 0) {
+        n += (uint64_t) a->d[--r] << k;
+        buf[--w] = (unsigned char) (n % 10);
+        n /= 10;
+    }
+    while (n > 0) {
+        buf[--w] = (unsigned char) (n % 10);
+        n /= 10;
+    }
+    count = a->nd + 20 - w;
+    a->dp += count - a->nd;
+    if (count > LEPT_DECIMAL_DIGITS) {
+        for (i = LEPT_DECIMAL_DIGITS; i < count; i++) {
+            if (buf[w + i] != 0) {
+                a->trunc = 1;
+            }
+        }
+        count = LEPT_DECIMAL_DIGITS;
+    }
+    memcpy(a->d, buf + w, count);
+    a->nd = count;
+    lept_decimal_trim(a);
+}
+
+static void lept_decimal_right_shift(lept_decimal *a, unsigned k) {
+    int r = 0, w = 0;
+    uint64_t n = 0, mask = ((uint64_t) 1 << k) - 1;
+    /* 先取足够的高位数字 */
+    for (; (n >> k) == 0; r++) {
+        if (r >= a->nd) {
+            if (n == 0) {
+                a->nd = 0;
+                return;
+            }
+            while ((n >> k) == 0) {
+                n *= 10;
+                r++;
+            }
+            break;
+        }
+        n = n * 10 + a->d[r];
+    }
+    a->dp -= r - 1;
+    for (; r < a->nd; r++) {
+        uint64_t dig = n >> k;
+        n &= mask;
+        a->d[w++] = (unsigned char) dig;
+        n = n * 10 + a->d[r];
+    }
+    while (n > 0) {
+        uint64_t dig = n >> k;
+        n &= mask;
+        if (w < LEPT_DECIMAL_DIGITS) {
+            a->d[w++] = (unsigned char) dig;
+        } else if (dig > 0) {
+            a->trunc = 1;
+        }
+        n *= 10;
+    }
+    a->nd = w;
+    lept_decimal_trim(a);
+}
+
+/**
+ * 乘以 2^k（k 可为负）
+ *
+ * @param a
+ * @param k
+ */
+static void lept_decimal_shift(lept_decimal *a, int k) {
+    if (a->nd == 0) {
+        return;
+    }
+    if (k > 0) {
+        for (; k > LEPT_DECIMAL_MAX_SHIFT; k -= LEPT_DECIMAL_MAX_SHIFT) {
+            lept_decimal_left_shift(a, LEPT_DECIMAL_MAX_SHIFT);
+        }
+        lept_decimal_left_shift(a, (unsigned) k);
+    } else if (k < 0) {
+        for (; k < -LEPT_DECIMAL_MAX_SHIFT; k += LEPT_DECIMAL_MAX_SHIFT) {
+            lept_decimal_right_shift(a, LEPT_DECIMAL_MAX_SHIFT);
+        }
+        lept_decimal_right_shift(a, (unsigned) -k);
+    }
+}
+
+/**
+ * 舍入到整数（四舍六入，恰好一半时取偶数）
+ *
+ * @param a
+ * @return
+ */
+static uint64_t lept_decimal_rounded_integer(const lept_decimal *a) {
+    uint64_t n = 0;
+    int i, round_up = 0;
+    if (a->dp > 20) {
+        return UINT64_MAX;
+    }
+    for (i = 0; i < a->dp && i < a->nd; i++) {
+        n = n * 10 + a->d[i];
+    }
+    for (; i < a->dp; i++) {
+        n *= 10;
+    }
+    if (a->dp >= 0 && a->dp < a->nd) {
+        if (a->d[a->dp] == 5 && a->dp + 1 == a->nd) {
+            round_up = a->trunc || (a->dp > 0 && a->d[a->dp - 1] % 2 == 1);
+        } else {
+            round_up = a->d[a->dp] >= 5;
+        }
+    }
+    return n + round_up;
+}
+
+/**
+ * 慢速路径：把高精度十进制数逐步乘除 2 的幂，直到整数部分恰好为 53 位尾数
+ *
+ * @param a
+ * @return IEEE 754 双精度的位表示（不含符号）
+ */
+static uint64_t lept_decimal_to_bits(lept_decimal *a) {
+    static const int powtab[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+    int exp;
+    uint64_t mantissa;
+    if (a->nd == 0 || a->dp < -330) {
+        return 0;
+    }
+    if (a->dp > 310) {
+        return (uint64_t) 0x7FF << 52;
+    }
+    /* 缩放到 [0.5, 1) */
+    exp = 0;
+    while (a->dp > 0) {
+        int n = a->dp >= 9 ? 27 : powtab[a->dp];
+        lept_decimal_shift(a, -n);
+        exp += n;
+    }
+    while (a->dp < 0 || (a->dp == 0 && a->d[0] < 5)) {
+        int n = -a->dp >= 9 ? 27 : powtab[-a->dp];
+        lept_decimal_shift(a, n);
+        exp -= n;
+    }
+    /* 换算到 [1, 2) */
+    exp--;
+    /* 非规格化数 */
+    if (exp < -1022) {
+        lept_decimal_shift(a, exp + 1022);
+        exp = -1022;
+    }
+    if (exp + 1023 >= 0x7FF) {
+        return (uint64_t) 0x7FF << 52;
+    }
+    lept_decimal_shift(a, 53);
+    mantissa = lept_decimal_rounded_integer(a);
+    /* 舍入进位 */
+    if (mantissa == (uint64_t) 2 << 52) {
+        mantissa >>= 1;
+        exp++;
+        if (exp + 1023 >= 0x7FF) {
+            return (uint64_t) 0x7FF << 52;
+        }
+    }
+    if (!(mantissa & ((uint64_t) 1 << 52))) {
+        exp = -1023;
+    }
+    return (mantissa & (((uint64_t) 1 << 52) - 1)) | (uint64_t) (exp + 1023) << 52;
+}
+
+#ifdef LEPT_LITTLE_ENDIAN
+/* SWAR：判断 8 个字节是否都是数字 */
+static int lept_is_8digits(uint64_t x) {
+    return ((x & 0xF0F0F0F0F0F0F0F0ULL) | (((x + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+           0x3333333333333333ULL;
+}
+
+/* SWAR：把 8 个数字字符一次转换为整数 */
+static uint32_t lept_parse_8digits(uint64_t x) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL; /* 100 + (1000000 << 32) */
+    const uint64_t mul2 = 0x0000271000000001ULL; /* 1 + (10000 << 32) */
+    x -= 0x3030303030303030ULL;
+    x = (x * 10) + (x >> 8);
+    x = (((x & mask) * mul1) + (((x >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t) x;
+}
+#endif
+
+/**
+ * 读取连续的数字并累加到 w（超过 19 位时会溢出，由调用者处理）
+ *
+ * @param p
+ * @param end
+ * @param w
+ * @return 第一个非数字字符的位置
+ */
+static const char *lept_parse_digits(const char *p, const char *end, uint64_t *w) {
+    uint64_t x = *w;
+#ifdef LEPT_LITTLE_ENDIAN
+    while (end - p >= 8) {
+        uint64_t chunk;
+        memcpy(&chunk, p, 8);
+        if (!lept_is_8digits(chunk)) {
+            break;
+        }
+        x = x * 100000000 + lept_parse_8digits(chunk);
+        p += 8;
+    }
+#endif
+    for (; p < end && ISDIGIT(*p); p++) {
+        x = x * 10 + (*p - '0');
+    }
+    *w = x;
+    return p;
+}
+
+/**
+ * 解析 number
+ *
+ * @param c
+ * @param v
+ * @return
+ */
+static int lept_parse_number(lept_context *c, lept_value *v) {
+    const char *p = c->json, *end = c->end, *digits, *frac;
+    uint64_t w = 0, bits, bits2;
+    int64_t exp10 = 0, e = 0;
+    size_t ndigits;
+    int neg = 0, truncated = 0;
+
+    /* 负号 */
+    if (p < end && *p == '-') {
+        neg = 1;
+        p++;
+    }
+
+    /* 整数 */
+    digits = p;
+    if (p < end && *p == '0') {
+        p++;
+    } else {
+        if (p == end || !ISDIGIT1TO9(*p)) {
+            return LEPT_PARSE_INVALID_VALUE;
+        }
+        p = lept_parse_digits(p, end, &w);
+    }
+    ndigits = p - digits;
+
+    /* 小数 */
+    if (p < end && *p == '.') {
+        p++;
+        if (p == end || !ISDIGIT(*p)) {
+            return LEPT_PARSE_INVALID_VALUE;
+        }
+        frac = p;
+        p = lept_parse_digits(p, end, &w);
+        exp10 = -(int64_t) (p - frac);
+        ndigits += p - frac;
+    }
+
+    /* 指数：绝对值过大时已必然溢出或下溢，不再累加 */
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        int eneg = 0;
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) {
+            eneg = *p++ == '-';
+        }
+        if (p == end || !ISDIGIT(*p)) {
+            return LEPT_PARSE_INVALID_VALUE;
+        }
+        for (; p < end && ISDIGIT(*p); p++) {
+            if (e < 0x10000000) {
+                e = e * 10 + (*p - '0');
+            }
+        }
+        if (eneg) {
+            e = -e;
+        }
+    }
+
+    /* 不含小数和指数的整数：在 int64_t/uint64_t 范围内时精确保存，"-0" 仍为 double 以保留符号 */
+    if ((size_t) (p - digits) == ndigits && !(neg && *digits == '0') && ndigits <= 20) {
+        int fits = 1;
+        if (ndigits == 20) {
+            /* 20 位时 w 已溢出，按前 19 位与末位判断是否不超过 UINT64_MAX（18446744073709551615） */
+            const char *q;
+            uint64_t hi = 0;
+            for (q = digits; q < p - 1; q++) {
+                hi = hi * 10 + (*q - '0');
+            }
+            fits = hi < 1844674407370955161ULL || (hi == 1844674407370955161ULL && p[-1] <= '5');
+        }
+        if (fits && (!neg || w <= (uint64_t) 1 << 63)) {
+            if (neg) {
+                v->u.i64 = -(int64_t) (w - 1) - 1;
+                v->flags = LEPT_FLAG_INT64;
+            } else if (w <= (uint64_t) INT64_MAX) {
+                v->u.i64 = (int64_t) w;
+                v->flags = LEPT_FLAG_INT64;
+            } else {
+                v->u.u64 = w;
+                v->flags = LEPT_FLAG_UINT64;
+            }
+            v->type = LEPT_NUMBER;
+            c->json = p;
+            return LEPT_PARSE_OK;
+        }
+    }
+
+    if (ndigits > 19) {
+        /* 有效数字超过 19 位：只取前 19 位，后面的非零数字记为截断 */
+        const char *q;
+        int sig = 0, in_frac = 0;
+        w = 0;
+        exp10 = 0;
+        for (q = digits; q < p && *q != 'e' && *q != 'E'; q++) {
+            if (*q == '.') {
+                in_frac = 1;
+            } else if (sig < 19) {
+                w = w * 10 + (*q - '0');
+                sig += w != 0;
+                exp10 -= in_frac;
+            } else {
+                exp10 += !in_frac;
+                truncated |= *q != '0';
+            }
+        }
+    }
+    exp10 += e;
+
+    /* 转换成二进制，并处理过大的值 */
+    if (w == 0) {
+        bits = 0;
+    }
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    else if (!truncated && w <= ((uint64_t) 1 << 53) && exp10 >= -22 && exp10 <= 22) {
+        /* 尾数与 10 的幂都能精确表示，一次乘除法即可得到正确舍入的结果 */
+        double d = (double) w;
+        d = exp10 < 0 ? d / lept_pow10[-exp10] : d * lept_pow10[exp10];
+        memcpy(&bits, &d, sizeof(bits));
+    }
+#endif
+    else if (lept_eisel_lemire(exp10, w, &bits) != 0 ||
+             (truncated && (lept_eisel_lemire(exp10, w + 1, &bits2) != 0 || bits != bits2))) {
+        /* 截断时 w 与 w + 1 的结果相同才能确定，否则使用慢速路径 */
+        lept_decimal d;
+        lept_decimal_set(&d, digits, p);
+        bits = lept_decimal_to_bits(&d);
+    }
+    if ((bits >> 52) == 0x7FF) {
+        return LEPT_PARSE_NUMBER_TOO_BIG;
+    }
+    bits |= (uint64_t) neg << 63;
+    memcpy(&v->u.n, &bits, sizeof(bits));
+    v->flags = 0;
+    v->type = LEPT_NUMBER;
+    c->json = p;
+    return LEPT_PARSE_OK;
+}
+
+/**
+ * 解析 4 位十六进制数字
+ *
+ * @param p
+ * @param end   输入末尾，不足 4 位时视为不合法
+ * @param u
+ * @return
+ */
+static const char *lept_parse_hex4(const char *p, const char *end, unsigned *u) {
+#ifdef LEPT_LITTLE_ENDIAN
+    uint32_t x, lower, digit, alpha, h;
+    if (end - p < 4) {
+        return NULL;
+    }
+    /* SWAR：4 个字符同时判断与转换。对 ASCII 字节，加上 0x80 - a 后最高位为 1 当且仅当字节不小于 a */
+    memcpy(&x, p, 4);
+    lower = x | 0x20202020;
+    digit = (x + 0x50505050) & ~(x + 0x46464646);           /* '0'～'9' */
+    alpha = (lower + 0x1F1F1F1F) & ~(lower + 0x19191919);   /* 'a'～'f'（含大写） */
+    if ((((digit | alpha) & ~x) & 0x80808080) != 0x80808080) {
+        return NULL;
+    }
+    h = (lower & 0x0F0F0F0F) + ((alpha >> 7) & 0x01010101) * 9;
+    /* 每个字节一个数字，p[0] 在最低字节：合并为 (h0 h1) (h2 h3) 两个字节 */
+    h = ((h & 0x0F000F00) >> 8) | ((h & 0x000F000F) << 4);
+    *u = ((h & 0xFF) << 8) | ((h >> 16) & 0xFF);
+    return p + 4;
+#else
+    unsigned h0, h1, h2, h3;
+    if (end - p < 4) {
+        return NULL;
+    }
+    h0 = lept_hex_value[(unsigned char) p[0]];
+    h1 = lept_hex_value[(unsigned char) p[1]];
+    h2 = lept_hex_value[(unsigned char) p[2]];
+    h3 = lept_hex_value[(unsigned char) p[3]];
+    /* 非十六进制数字的值为 0xFF，合并后只需判断一次 */
+    if ((h0 | h1 | h2 | h3) & 0xF0) {
+        return NULL;
+    }
+    *u = (h0 << 12) | (h1 << 8) | (h2 << 4) | h3;
+    return p + 4;
+#endif
+}
+
+/**
+ * UTF-8 编码
+ *
+ * @param out   至少 4 个字节
+ * @param u
+ * @return 写入的字节数
+ */
+static size_t lept_encode_utf8(char *out, unsigned u) {
+#ifdef LEPT_LITTLE_ENDIAN
+    /* 在一个 32 位整数中拼出所有字节，一次写入（多写的字节由调用者忽略） */
+    uint32_t w;
+    size_t n;
+    if (u <= 0x7F) {
+        out[0] = (char) u;
+        return 1;
+    } else if (u <= 0x7FF) {
+        w = 0x80C0 | (u >> 6) | ((u & 0x3F) << 8);
+        n = 2;
+    } else if (u <= 0xFFFF) {
+        w = 0x8080E0 | (u >> 12) | ((u >> 6 & 0x3F) << 8) | ((u & 0x3F) << 16);
+        n = 3;
+    } else {
+        assert(u <= 0x10FFFF);
+        w = 0x808080F0 | (u >> 18) | ((u >> 12 & 0x3F) << 8) | ((u >> 6 & 0x3F) << 16) | ((uint32_t) (u & 0x3F) << 24);
+        n = 4;
+    }
+    memcpy(out, &w, 4);
+    return n;
+#else
+    if (u <= 0x7F) {
+        out[0] = (char) (u & 0xFF);
+        return 1;
+    } else if (u <= 0x7FF) {
+        out[0] = (char) (0xC0 | ((u >> 6) & 0xFF));
+        out[1] = (char) (0x80 | (u & 0x3F));
+        return 2;
+    } else if (u <= 0xFFFF) {
+        out[0] = (char) (0xE0 | ((u >> 12) & 0xFF));
+        out[1] = (char) (0x80 | ((u >> 6) & 0x3F));
+        out[2] = (char) (0x80 | (u & 0x3F));
+        return 3;
+    } else {
+        assert(u <= 0x10FFFF);
+        out[0] = (char) (0xF0 | ((u >> 18) & 0xFF));
+        out[1] = (char) (0x80 | ((u >> 12) & 0x3F));
+        out[2] = (char) (0x80 | ((u >> 6) & 0x3F));
+        out[3] = (char) (0x80 | (u & 0x3F));
+        return 4;
+    }
+#endif
+}
+
+/**
+ * 解析反斜杠之后的转义序列，读完整个序列后才写入 out，
+ * 且写入的字节数不超过序列长度，因此原地解析时 out 可以指向序列本身
+ *
+ * @param p     反斜杠之后的位置
+ * @param end
+ * @param out   至少 4 个字节
+ * @param n     写入的字节数
+ * @param ret   出错时的错误码
+ * @return 转义序列之后的位置，出错时返回 NULL
+ */
+static const char *lept_parse_escape(const char *p, const char *end, char *out, size_t *n, int *ret) {
+    unsigned u, u2;
+    *n = 1;
+    if (p == end) {
+        *ret = LEPT_PARSE_INVALID_STRING_ESCAPE;
+        return NULL;
+    }
+    switch (*p++) {
+        case '\"':
+            *out = '\"';
+            return p;
+        case '\\':
+            *out = '\\';
+            return p;
+        case '/':
+            *out = '/';
+            return p;
+        case 'b':
+            *out = '\b';
+            return p;
         case 'f':
-            return lept_parse_literal(c, v, "false", LEPT_FALSE);
+            *out = '\f';
+            return p;
+        case 'n':
+            *out = '\n';
+            return p;
+        case 'r':
+            *out = '\r';
+            return p;
+        case 't':
+            *out = '\t';
+            return p;
+        case 'u':
+            if (!(p = lept_parse_hex4(p, end, &u))) {
+                *ret = LEPT_PARSE_INVALID_UNICODE_HEX;
+                return NULL;
+            }
+            if (u >= 0xD800 && u <= 0xDBFF) { /* surrogate pair */
+                if (p == end || *p++ != '\\' || p == end || *p++ != 'u') {
+                    *ret = LEPT_PARSE_INVALID_UNICODE_SURROGATE;
+                    return NULL;
+                }
+                if (!(p = lept_parse_hex4(p, end, &u2))) {
+                    *ret = LEPT_PARSE_INVALID_UNICODE_HEX;
+                    return NULL;
+                }
+                if (u2 < 0xDC00 || u2 > 0xDFFF) {
+                    *ret = LEPT_PARSE_INVALID_UNICODE_SURROGATE;
+                    return NULL;
+                }
+                u = (((u - 0xD800) << 10) | (u2 - 0xDC00)) + 0x10000;
+            }
+            *n = lept_encode_utf8(out, u);
+            return p;
+        default:
+            *ret = LEPT_PARSE_INVALID_STRING_ESCAPE;
+            return NULL;
+    }
+}
+
+/* 扫描字符串内容，按选项同时校验 UTF-8 */
+#define LEPT_SCAN_STRING(c, p, end) \
+    ((c)->flags & LEPT_PARSE_OPT_VALIDATE_UTF8 ? lept_simd->scan_string_utf8(p, end) : lept_simd->scan_string(p, end))
+
+/**
+ * 原地解析 string：在输入缓冲区中解码，以 '\0' 结尾（写在结尾引号或更靠前的位置），
+ * *str 指向输入缓冲区
+ *
+ * @param c
+ * @param str
+ * @param len
+ * @return
+ */
+static int lept_parse_string_insitu(lept_context *c, char **str, size_t *len) {
+    const char *p, *end = c->end;
+    char *head, *w;
+    int ret;
+    EXPECT(c, '\"');
+    /* 原地解析时输入缓冲区可写 */
+    p = c->json;
+    head = w = (char *) p;
+    for (;;) {
+        size_t n;
+        const char *q = LEPT_SCAN_STRING(c, p, end);
+        if (q != p) {
+            /* 遇到过转义后解码结果落后于输入，需要前移 */
+            if (w != p)
+                memmove(w, p, q - p);
+            w += q - p;
+            p = q;
+        }
+        if (p == end)
+            return LEPT_PARSE_MISS_QUOTATION_MARK;
+        switch (*p++) {
+            case '\"':
+                *w = '\0';
+                *str = head;
+                *len = w - head;
+                c->json = p;
+                return LEPT_PARSE_OK;
+            case '\\':
+                /* 连续的转义逐个解码，不再经过扫描 */
+                for (;;) {
+                    if (!(p = lept_parse_escape(p, end, w, &n, &ret)))
+                        return ret;
+                    w += n;
+                    if (p == end || *p != '\\')
+                        break;
+                    p++;
+                }
+                break;
+            default:
+                if ((unsigned char) p[-1] >= 0x80)
+                    return LEPT_PARSE_INVALID_UTF8;
+                assert((unsigned char) p[-1] < 0x20);
+                return LEPT_PARSE_INVALID_STRING_CHAR;
+        }
+    }
+}
+
+/**
+ * 解析 string 的内容
+ *
+ * @param c
+ * @param str       结果：在堆栈上（由调用者复制），或 *borrowed 时引用输入
+ * @param len
+ * @param borrowed  结果是否引用输入（原地解析，或 LEPT_PARSE_OPT_BORROW 下不含转义的字符串）
+ * @return
+ */
+static int lept_parse_string_raw(lept_context *c, char **str, size_t *len, int *borrowed) {
+    size_t head = c->top, n;
+    int ret;
+    const char *p, *end = c->end;
+    *borrowed = c->insitu;
+    if (c->insitu) {
+        return lept_parse_string_insitu(c, str, len);
+    }
+    EXPECT(c, '\"');
+    p = c->json;
+    for (;;) {
+        char ch;
+        /* 不含转义及控制字符的一段内容一次性入栈 */
+        const char *q = LEPT_SCAN_STRING(c, p, end);
+        if ((c->flags & LEPT_PARSE_OPT_BORROW) && p == c->json && q != end && *q == '\"') {
+            /* 整个字符串不含转义：直接引用输入，不入栈 */
+            *str = (char *) p;
+            *len = q - p;
+            *borrowed = 1;
+            c->json = q + 1;
+            return LEPT_PARSE_OK;
+        }
+        if (q != p) {
+            PUTS(c, p, q - p);
+            p = q;
+        }
+        /* 到达输入末尾仍未找到结尾的引号 */
+        if (p == end)
+            STRING_ERROR(LEPT_PARSE_MISS_QUOTATION_MARK);
+        ch = *p++;
+        switch (ch) {
+            /* 找到末尾的引号 */
+            case '\"':
+                *len = c->top - head;
+                *str = lept_context_pop(c, *len);
+                c->json = p;
+                return LEPT_PARSE_OK;
+                /* 找到反斜杠，添加转义字符 */
+            case '\\':
+                /* 连续的转义（如全部以 \\u 转义的非 ASCII 字符）逐个解码，不再经过扫描；直接写入堆栈 */
+                for (;;) {
+                    char *out = (char *) lept_context_push(c, 4);
+                    if (!(p = lept_parse_escape(p, end, out, &n, &ret)))
+                        STRING_ERROR(ret);
+                    c->top -= 4 - n;
+                    if (p == end || *p != '\\')
+                        break;
+                    p++;
+                }
+                break;
+            default:
+                /* scan_string_utf8 停在不合法的 UTF-8 序列上 */
+                if ((unsigned char) ch >= 0x80)
+                    STRING_ERROR(LEPT_PARSE_INVALID_UTF8);
+                /* 否则只会停在控制字符上，包括 '\0' 在内的控制字符都不允许直接出现在字符串中 */
+                assert((unsigned char) ch < 0x20);
+                STRING_ERROR(LEPT_PARSE_INVALID_STRING_CHAR);
+        }
+    }
+}
+
+/**
+ * 构建 lept_value 时每层数组或对象压入堆栈的帧：其上依次是已解析的元素（lept_value）或成员（lept_member）
+ */
+typedef struct {
+    size_t parent;      /* 外层帧在堆栈中的偏移，最外层为 LEPT_NO_FRAME */
+    size_t size;        /* 已解析的元素或成员个数 */
+    lept_type type;     /* LEPT_ARRAY 或 LEPT_OBJECT */
+    lept_member m;      /* 对象：已解析键、正在解析值的成员 */
+} lept_frame;
+
+#define LEPT_NO_FRAME ((size_t) -1)
+
+/* 帧的地址：堆栈可能重新分配，压栈后须重新计算 */
+#define LEPT_FRAME(c, offset) ((lept_frame *) ((c)->stack + (offset)))
+
+/* 共享的对象键（LEPT_FLAG_SHARED）：引用计数存放在字符串之前 */
+#define LEPT_KEY_REFS(k) (((size_t *) (k))[-1])
+
+/**
+ * 分配共享的键，引用计数为 1
+ *
+ * @param k
+ * @param len
+ * @return
+ */
+static char *lept_key_share(const char *k, size_t len) {
+    size_t *refs = (size_t *) malloc(sizeof(size_t) + len + 1);
+    char *s = (char *) (refs + 1);
+    *refs = 1;
+    memcpy(s, k, len);
+    s[len] = '\0';
+    return s;
+}
+
+/**
+ * 释放成员的键：引用输入的不释放，共享的减少引用计数
+ *
+ * @param k
+ * @param kflags
+ */
+static void lept_key_free(char *k, unsigned char kflags) {
+    if (kflags & LEPT_FLAG_BORROWED)
+        return;
+    if (kflags & LEPT_FLAG_SHARED) {
+        if (--LEPT_KEY_REFS(k) == 0)
+            free(&LEPT_KEY_REFS(k));
+    } else {
+        free(k);
+    }
+}
+
+/**
+ * 出错时逐层弹出帧，释放已解析的元素、成员以及尚未配对的键
+ *
+ * @param c
+ * @param frame
+ */
+static void lept_parse_unwind(lept_context *c, size_t frame) {
+    size_t i;
+    while (frame != LEPT_NO_FRAME) {
+        lept_frame *f = LEPT_FRAME(c, frame);
+        size_t size = f->size;
+        if (f->type == LEPT_ARRAY) {
+            for (i = 0; i < size; i++) {
+                lept_free((lept_value *) lept_context_pop(c, sizeof(lept_value)));
+            }
+        } else {
+            for (i = 0; i < size; i++) {
+                lept_member *m = (lept_member *) lept_context_pop(c, sizeof(lept_member));
+                lept_key_free(m->k, m->kflags);
+                lept_free(&m->v);
+            }
+        }
+        f = (lept_frame *) lept_context_pop(c, sizeof(lept_frame));
+        if (f->m.k != NULL)
+            lept_key_free(f->m.k, f->m.kflags);
+        frame = f->parent;
+    }
+}
+
+/**
+ * 延迟解析：校验并跳过一个字符串，不解码、不入栈
+ *
+ * @param c
+ * @return
+ */
+static int lept_skip_string(lept_context *c) {
+    size_t n;
+    int ret;
+    char buf[4];
+    const char *p, *end = c->end;
+    EXPECT(c, '\"');
+    p = c->json;
+    for (;;) {
+        p = LEPT_SCAN_STRING(c, p, end);
+        if (p == end)
+            return LEPT_PARSE_MISS_QUOTATION_MARK;
+        switch (*p++) {
+            case '\"':
+                c->json = p;
+                return LEPT_PARSE_OK;
+            case '\\':
+                if (!(p = lept_parse_escape(p, end, buf, &n, &ret)))
+                    return ret;
+                break;
+            default:
+                return (unsigned char) p[-1] >= 0x80 ? LEPT_PARSE_INVALID_UTF8 : LEPT_PARSE_INVALID_STRING_CHAR;
+        }
+    }
+}
+
+/**
+ * 延迟解析：跳过对象成员的键及其后的冒号
+ *
+ * @param c
+ * @return
+ */
+static int lept_skip_member_key(lept_context *c) {
+    int ret;
+    if (PEEK(c) != '"') {
+        return LEPT_PARSE_MISS_KEY;
+    }
+    if ((ret = lept_skip_string(c)) != LEPT_PARSE_OK) {
+        return ret;
+    }
+    lept_parse_whitespace(c);
+    if (PEEK(c) != ':') {
+        return LEPT_PARSE_MISS_COLON;
+    }
+    c->json++;
+    lept_parse_whitespace(c);
+    return LEPT_PARSE_OK;
+}
+
+/**
+ * 校验并跳过一个数字，不转换。只有带指数或整数部分超过 308 位时才可能超出 double 的范围，
+ * 这时仍须转换才能判断 LEPT_PARSE_NUMBER_TOO_BIG
+ *
+ * @param c
+ * @return
+ */
+static int lept_skip_number(lept_context *c) {
+    const char *p = c->json, *end = c->end, *digits;
+    lept_value e;
+    if (p < end && *p == '-')
+        p++;
+    digits = p;
+    if (p < end && *p == '0') {
+        p++;
+    } else {
+        if (p == end || !ISDIGIT1TO9(*p))
+            return LEPT_PARSE_INVALID_VALUE;
+        for (p++; p < end && ISDIGIT(*p); p++)
+            ;
+    }
+    if (p - digits > DBL_MAX_10_EXP)
+        return lept_parse_number(c, &e);
+    if (p < end && *p == '.') {
+        p++;
+        if (p == end || !ISDIGIT(*p))
+            return LEPT_PARSE_INVALID_VALUE;
+        for (p++; p < end && ISDIGIT(*p); p++)
+            ;
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+        return lept_parse_number(c, &e);
+    c->json = p;
+    return LEPT_PARSE_OK;
+}
+
+/**
+ * 延迟解析：校验并跳过一个非空数组或对象的其余部分（c->json 指向左括号及空白之后），
+ * 不构建任何值。检查的顺序与 lept_sax_parse_value 相同，因此错误码也相同；
+ * 各层尚未配对的右括号压在堆栈上，每层一个字节
+ *
+ * @param c
+ * @param type  LEPT_ARRAY 或 LEPT_OBJECT
+ * @param depth 包括此容器在内已打开的数组和对象层数
+ * @return
+ */
+static int lept_skip_container(lept_context *c, lept_type type, size_t depth) {
+    size_t head = c->top;
+    lept_value e;
+    int ret;
+    PUTC(c, type == LEPT_ARRAY ? ']' : '}');
+    if (type == LEPT_OBJECT && (ret = lept_skip_member_key(c)) != LEPT_PARSE_OK) {
+        c->top = head;
+        return ret;
+    }
+    for (;;) {
+        char close;
+        if (c->json == c->end) {
+            ret = LEPT_PARSE_EXPECT_VALUE;
+            break;
+        }
+        switch (lept_token[(unsigned char) *c->json]) {
+            case LEPT_TOKEN_NULL:
+                ret = lept_parse_literal(c, &e, "null", LEPT_NULL);
+                break;
+            case LEPT_TOKEN_TRUE:
+                ret = lept_parse_literal(c, &e, "true", LEPT_TRUE);
+                break;
+            case LEPT_TOKEN_FALSE:
+                ret = lept_parse_literal(c, &e, "false", LEPT_FALSE);
+                break;
+            case LEPT_TOKEN_NUMBER:
+                ret = lept_skip_number(c);
+                break;
+            case LEPT_TOKEN_STRING:
+                ret = lept_skip_string(c);
+                break;
+            default:
+                ret = LEPT_PARSE_INVALID_VALUE;
+                break;
+            case LEPT_TOKEN_ARRAY:
+            case LEPT_TOKEN_OBJECT:
+                if (c->max_depth != 0 && depth >= c->max_depth) {
+                    ret = LEPT_PARSE_DEPTH_EXCEEDED;
+                    break;
+                }
+                close = *c->json++ == '[' ? ']' : '}';
+                lept_parse_whitespace(c);
+                if (PEEK(c) == close) {
+                    c->json++;
+                    ret = LEPT_PARSE_OK;
+                    break;
+                }
+                PUTC(c, close);
+                depth++;
+                if (close == '}' && (ret = lept_skip_member_key(c)) != LEPT_PARSE_OK) {
+                    break;
+                }
+                continue;
+        }
+        if (ret != LEPT_PARSE_OK) {
+            break;
+        }
+        /* 处理值之后的逗号或结束括号（可能连续结束多层） */
+        while (c->top > head) {
+            close = c->stack[c->top - 1];
+            lept_parse_whitespace(c);
+            if (PEEK(c) == ',') {
+                c->json++;
+                lept_parse_whitespace(c);
+                if (close == '}') {
+                    ret = lept_skip_member_key(c);
+                }
+                break;
+            }
+            if (PEEK(c) != close) {
+                ret = close == ']' ? LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET
+                                   : LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+                break;
+            }
+            c->json++;
+            c->top--;
+            depth--;
+        }
+        if (ret != LEPT_PARSE_OK || c->top == head) {
+            break;
+        }
+    }
+    c->top = head;
+    return ret;
+}
+
+/* 调用事件处理函数，未设置时视为继续 */
+#define LEPT_SAX_CALL(h, cb, args) ((h)->cb != NULL ? (h)->cb args : LEPT_SAX_CONTINUE)
+
+/* 处理函数的返回值是否要求中止解析 */
+#define LEPT_SAX_ABORTED(r) ((r) != LEPT_SAX_CONTINUE && (r) != LEPT_SAX_SKIP)
+
+/**
+ * SAX 解析时每层数组或对象压入堆栈的帧
+ */
+typedef struct {
+    size_t size;        /* 已解析的元素或成员个数 */
+    lept_type type;     /* LEPT_ARRAY 或 LEPT_OBJECT */
+} lept_sax_frame;
+
+/* 当前（最内层）的帧：解析字符串时临时压入的内容在回调之前已经弹出，帧总在栈顶 */
+#define LEPT_SAX_TOP(c) ((lept_sax_frame *) ((c)->stack + (c)->top - sizeof(lept_sax_frame)))
+
+/**
+ * 解析对象成员的键及其后的冒号，产生 on_key 事件
+ *
+ * @param c
+ * @param h
+ * @param ctx
+ * @return
+ */
+static int lept_sax_parse_key(lept_context *c, const lept_sax_handler *h, void *ctx) {
+    char *str;
+    size_t len;
+    int ret, borrowed;
+    if (PEEK(c) != '"') {
+        return LEPT_PARSE_MISS_KEY;
+    }
+    if ((ret = lept_parse_string_raw(c, &str, &len, &borrowed)) != LEPT_PARSE_OK) {
+        return ret;
+    }
+    if (LEPT_SAX_ABORTED(LEPT_SAX_CALL(h, on_key, (ctx, str, len)))) {
+        return LEPT_PARSE_ABORTED;
+    }
+    lept_parse_whitespace(c);
+    if (PEEK(c) != ':') {
+        return LEPT_PARSE_MISS_COLON;
+    }
+    c->json++;
+    lept_parse_whitespace(c);
+    return LEPT_PARSE_OK;
+}
+
+/**
+ * 解析一个 JSON 值，按顺序产生事件，不构建 lept_value。
+ * 数组和对象不递归，每层在堆栈上压入一个帧，因此嵌套层数只受堆内存限制，不占用 C 调用栈
+ *
+ * @param c
+ * @param h
+ * @param ctx
+ * @return
+ */
+static LEPT_INLINE int lept_sax_parse_value(lept_context *c, const lept_sax_handler *h, void *ctx) {
+    size_t head = c->top, depth = 0, size;
+    lept_sax_frame *f;
+    lept_type type;
+    lept_value n;
+    char *str;
+    size_t len;
+    int ret, r, borrowed;
+    for (;;) {
+        /* 解析一个值并产生其事件；遇到非空的数组或对象时压入帧，转而解析其第一个值 */
+        r = LEPT_SAX_CONTINUE;
+        /* 输入已结束 */
+        if (c->json == c->end) {
+            ret = LEPT_PARSE_EXPECT_VALUE;
+            break;
+        }
+        /* 根据首字符查表选择判断分支 */
+        switch (lept_token[(unsigned char) *c->json]) {
+            case LEPT_TOKEN_NULL:
+                if ((ret = lept_parse_literal(c, &n, "null", LEPT_NULL)) == LEPT_PARSE_OK)
+                    r = LEPT_SAX_CALL(h, on_null, (ctx));
+                break;
+            case LEPT_TOKEN_TRUE:
+                if ((ret = lept_parse_literal(c, &n, "true", LEPT_TRUE)) == LEPT_PARSE_OK)
+                    r = LEPT_SAX_CALL(h, on_bool, (ctx, 1));
+                break;
+            case LEPT_TOKEN_FALSE:
+                if ((ret = lept_parse_literal(c, &n, "false", LEPT_FALSE)) == LEPT_PARSE_OK)
+                    r = LEPT_SAX_CALL(h, on_bool, (ctx, 0));
+                break;
+            case LEPT_TOKEN_NUMBER:
+                lept_init(&n);
+                if ((ret = lept_parse_number(c, &n)) == LEPT_PARSE_OK)
+                    r = LEPT_SAX_CALL(h, on_number, (ctx, &n));
+                break;
+            case LEPT_TOKEN_STRING:
+                if ((ret = lept_parse_string_raw(c, &str, &len, &borrowed)) == LEPT_PARSE_OK)
+                    r = LEPT_SAX_CALL(h, on_string, (ctx, str, len));
+                break;
+            default:
+                ret = LEPT_PARSE_INVALID_VALUE;
+                break;
+            case LEPT_TOKEN_ARRAY:
+            case LEPT_TOKEN_OBJECT:
+                if (c->max_depth != 0 && depth >= c->max_depth) {
+                    ret = LEPT_PARSE_DEPTH_EXCEEDED;
+                    break;
+                }
+                type = *c->json++ == '[' ? LEPT_ARRAY : LEPT_OBJECT;
+                r = type == LEPT_ARRAY ? LEPT_SAX_CALL(h, on_start_array, (ctx))
+                                       : LEPT_SAX_CALL(h, on_start_object, (ctx));
+                if (LEPT_SAX_ABORTED(r)) {
+                    ret = LEPT_PARSE_ABORTED;
+                    break;
+                }
+                lept_parse_whitespace(c);
+                ret = LEPT_PARSE_OK;
+                /* 空数组或空对象，或处理函数要求跳过（仍须校验）其内容 */
+                if (PEEK(c) == (type == LEPT_ARRAY ? ']' : '}')) {
+                    c->json++;
+                } else if (r == LEPT_SAX_SKIP) {
+                    ret = lept_skip_container(c, type, depth + 1);
+                } else {
+                    f = (lept_sax_frame *) lept_context_push(c, sizeof(lept_sax_frame));
+                    f->size = 0;
+                    f->type = type;
+                    depth++;
+                    /* 对象先解析第一个成员的键 */
+                    if (type == LEPT_OBJECT && (ret = lept_sax_parse_key(c, h, ctx)) != LEPT_PARSE_OK) {
+                        break;
+                    }
+                    continue;
+                }
+                if (ret == LEPT_PARSE_OK) {
+                    r = type == LEPT_ARRAY ? LEPT_SAX_CALL(h, on_end_array, (ctx, 0))
+                                           : LEPT_SAX_CALL(h, on_end_object, (ctx, 0));
+                }
+                break;
+        }
+        if (ret == LEPT_PARSE_OK && LEPT_SAX_ABORTED(r)) {
+            ret = LEPT_PARSE_ABORTED;
+        }
+        if (ret != LEPT_PARSE_OK) {
+            break;
+        }
+
+        /* 值已完成：处理其后的逗号或结束括号（可能连续结束多层） */
+        while (c->top > head) {
+            f = LEPT_SAX_TOP(c);
+            f->size++;
+            lept_parse_whitespace(c);
+            if (PEEK(c) == ',') {
+                c->json++;
+                lept_parse_whitespace(c);
+                if (f->type == LEPT_OBJECT) {
+                    ret = lept_sax_parse_key(c, h, ctx);
+                }
+                break;
+            }
+            if (f->type == LEPT_ARRAY ? PEEK(c) != ']' : PEEK(c) != '}') {
+                ret = f->type == LEPT_ARRAY ? LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET
+                                            : LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+                break;
+            }
+            c->json++;
+            size = f->size;
+            type = f->type;
+            c->top -= sizeof(lept_sax_frame);
+            depth--;
+            r = type == LEPT_ARRAY ? LEPT_SAX_CALL(h, on_end_array, (ctx, size))
+                                   : LEPT_SAX_CALL(h, on_end_object, (ctx, size));
+            if (LEPT_SAX_ABORTED(r)) {
+                ret = LEPT_PARSE_ABORTED;
+                break;
+            }
+        }
+        if (ret != LEPT_PARSE_OK || c->top == head) {
+            break;
+        }
+    }
+    c->top = head;
+    return ret;
+}
+
+/**
+ * 对象键的散列值（FNV-1a）
+ *
+ * @param k
+ * @param len
+ * @return
+ */
+static LEPT_INLINE uint32_t lept_hash_key(const char *k, size_t len) {
+    uint32_t hash = 2166136261u;
+    size_t i;
+    for (i = 0; i < len; i++)
+        hash = (hash ^ (unsigned char) k[i]) * 16777619u;
+    return hash;
+}
+
+/* 键表中不同的键最多有多少个，更多的键不再共享（如以 ID 为键的大对象） */
+#define LEPT_INTERN_MAX 4096
+
+/* 键表的一项 */
+typedef struct {
+    char *k;            /* 共享的键，NULL 表示空位 */
+    size_t len;
+    uint32_t hash;
+} lept_intern_entry;
+
+/* 一次解析内的键表（LEPT_PARSE_OPT_INTERN_KEYS）：开放定址，容量为 2 的幂；表本身持有每个键的一个引用 */
+typedef struct {
+    lept_intern_entry *e;
+    size_t mask;        /* 容量 - 1 */
+    size_t count;
+} lept_intern;
+
+static void lept_intern_init(lept_intern *t) {
+    t->e = NULL;
+    t->mask = t->count = 0;
+}
+
+/**
+ * 释放键表持有的引用，键仍由各成员共享
+ *
+ * @param t
+ */
+static void lept_intern_free(lept_intern *t) {
+    size_t i;
+    if (t->e == NULL)
+        return;
+    for (i = 0; i <= t->mask; i++) {
+        if (t->e[i].k != NULL)
+            lept_key_free(t->e[i].k, LEPT_FLAG_SHARED);
+    }
+    free(t->e);
+    lept_intern_init(t);
+}
+
+/**
+ * 查找或加入键
+ *
+ * @param t
+ * @param k
+ * @param len
+ * @return 增加了一个引用的共享键；表已满时返回 NULL，由调用者单独分配
+ */
+static char *lept_intern_key(lept_intern *t, const char *k, size_t len) {
+    uint32_t hash = lept_hash_key(k, len);
+    size_t i;
+    lept_intern_entry *e;
+    if (t->e != NULL) {
+        for (i = hash & t->mask; (e = &t->e[i])->k != NULL; i = (i + 1) & t->mask) {
+            if (e->hash == hash && e->len == len && memcmp(e->k, k, len) == 0) {
+                LEPT_KEY_REFS(e->k)++;
+                return e->k;
+            }
+        }
+    }
+    if (t->count >= LEPT_INTERN_MAX)
+        return NULL;
+    /* 负载不超过一半 */
+    if ((t->count + 1) * 2 > t->mask + 1) {
+        lept_intern_entry *old = t->e;
+        size_t j, n = old ? t->mask + 1 : 0;
+        t->mask = n ? n * 2 - 1 : 15;
+        t->e = (lept_intern_entry *) calloc(t->mask + 1, sizeof(lept_intern_entry));
+        for (j = 0; j < n; j++) {
+            if (old[j].k == NULL)
+                continue;
+            for (i = old[j].hash & t->mask; t->e[i].k != NULL; i = (i + 1) & t->mask)
+                ;
+            t->e[i] = old[j];
+        }
+        free(old);
+    }
+    /* 在（可能已扩容的）表中找到空位 */
+    for (i = hash & t->mask; (e = &t->e[i])->k != NULL; i = (i + 1) & t->mask)
+        ;
+    e->k = lept_key_share(k, len);
+    e->len = len;
+    e->hash = hash;
+    t->count++;
+    LEPT_KEY_REFS(e->k)++;
+    return e->k;
+}
+
+/* 形状的键数上限：查找表的一项为 unsigned char（键的下标 + 1），更大的对象照常保存成员 */
+#define LEPT_SHAPE_MAX_KEYS 64
+
+/* 一次解析中不同形状最多有多少个，更多的键序列不再建立形状 */
+#define LEPT_SHAPES_MAX 1024
+
+/* 形状中的键：与 lept_member 的键部分相同 */
+typedef struct {
+    char *k;
+    size_t klen;
+    unsigned char kflags;
+} lept_shape_key;
+
+/*
+ * 对象的形状（LEPT_PARSE_OPT_SHAPES）：键序列相同的对象共享的有序键表及按键查找的开放定址表，
+ * 与结构体一次分配，按引用计数释放
+ */
+struct lept_shape {
+    size_t refs;
+    size_t size;            /* 键的个数 */
+    size_t mask;            /* 查找表的容量 - 1 */
+    uint32_t hash;          /* 键序列的散列值 */
+    lept_shape_key *keys;
+    unsigned char *table;   /* 键的下标 + 1，0 表示空位 */
+};
+
+/* object 的成员个数 */
+#define LEPT_OBJECT_SIZE(v) (((v)->flags & LEPT_FLAG_SHAPED) ? (v)->u.h.shape->size : (v)->u.o.size)
+
+/**
+ * 由 n 个成员的键建立形状，键的所有权转给形状；重复的键只有第一个可查找
+ *
+ * @param m
+ * @param n
+ * @param hash  键序列的散列值
+ * @return      引用计数为 1
+ */
+static lept_shape *lept_shape_new(const lept_member *m, size_t n, uint32_t hash) {
+    size_t mask = 7, i, j;
+    lept_shape *s;
+    assert(n > 0 && n <= LEPT_SHAPE_MAX_KEYS);
+    while (mask + 1 < n * 2)
+        mask = mask * 2 + 1;
+    s = (lept_shape *) malloc(sizeof(lept_shape) + n * sizeof(lept_shape_key) + mask + 1);
+    s->refs = 1;
+    s->size = n;
+    s->mask = mask;
+    s->hash = hash;
+    s->keys = (lept_shape_key *) (s + 1);
+    s->table = (unsigned char *) (s->keys + n);
+    memset(s->table, 0, mask + 1);
+    for (i = 0; i < n; i++) {
+        lept_shape_key *k = &s->keys[i];
+        k->k = m[i].k;
+        k->klen = m[i].klen;
+        k->kflags = m[i].kflags;
+        for (j = lept_hash_key(k->k, k->klen) & mask; s->table[j] != 0; j = (j + 1) & mask) {
+            const lept_shape_key *x = &s->keys[s->table[j] - 1];
+            if (x->klen == k->klen && memcmp(x->k, k->k, k->klen) == 0)
+                break;
+        }
+        if (s->table[j] == 0)
+            s->table[j] = (unsigned char) (i + 1);
+    }
+    return s;
+}
+
+/**
+ * 减少形状的引用计数，为 0 时释放形状及其键
+ *
+ * @param s
+ */
+static void lept_shape_release(lept_shape *s) {
+    size_t i;
+    if (--s->refs > 0)
+        return;
+    for (i = 0; i < s->size; i++)
+        lept_key_free(s->keys[i].k, s->keys[i].kflags);
+    free(s);
+}
+
+/**
+ * 形状中是否有引用输入的键（LEPT_PARSE_OPT_BORROW）
+ *
+ * @param s
+ * @return
+ */
+static int lept_shape_borrowed(const lept_shape *s) {
+    size_t i;
+    for (i = 0; i < s->size; i++) {
+        if (s->keys[i].kflags & LEPT_FLAG_BORROWED)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * 在形状中查找键
+ *
+ * @param s
+ * @param key
+ * @param klen
+ * @return  键的下标，不存在时为 LEPT_KEY_NOT_EXIST
+ */
+static size_t lept_shape_find(const lept_shape *s, const char *key, size_t klen) {
+    size_t i, j;
+    for (i = lept_hash_key(key, klen) & s->mask; (j = s->table[i]) != 0; i = (i + 1) & s->mask) {
+        const lept_shape_key *k = &s->keys[j - 1];
+        if (k->klen == klen && memcmp(k->k, key, klen) == 0)
+            return j - 1;
+    }
+    return LEPT_KEY_NOT_EXIST;
+}
+
+/**
+ * 形状的键序列是否与 n 个成员的键相同；驻留的键只需比较指针
+ *
+ * @param s
+ * @param m
+ * @param n
+ * @return
+ */
+static int lept_shape_match(const lept_shape *s, const lept_member *m, size_t n) {
+    size_t i;
+    if (s->size != n)
+        return 0;
+    for (i = 0; i < n; i++) {
+        const lept_shape_key *k = &s->keys[i];
+        if (k->k != m[i].k && (k->klen != m[i].klen || memcmp(k->k, m[i].k, k->klen) != 0))
+            return 0;
+    }
+    return 1;
+}
+
+/* 一次解析内的形状表：开放定址，容量为 2 的幂；表本身持有每个形状的一个引用 */
+typedef struct {
+    lept_shape **e;
+    size_t mask;        /* 容量 - 1 */
+    size_t count;
+    lept_shape *last;   /* 最近使用的形状：对象数组中相邻的记录通常形状相同，先与之比较 */
+} lept_shapes;
+
+static void lept_shapes_init(lept_shapes *t) {
+    t->e = NULL;
+    t->mask = t->count = 0;
+    t->last = NULL;
+}
+
+/**
+ * 释放形状表持有的引用，形状仍由各对象共享
+ *
+ * @param t
+ */
+static void lept_shapes_free(lept_shapes *t) {
+    size_t i;
+    if (t->e == NULL)
+        return;
+    for (i = 0; i <= t->mask; i++) {
+        if (t->e[i] != NULL)
+            lept_shape_release(t->e[i]);
+    }
+    free(t->e);
+    lept_shapes_init(t);
+}
+
+/**
+ * 查找或建立 n 个成员的键序列对应的形状。找到已有的形状时释放成员的键，
+ * 新建时成员的键转给形状
+ *
+ * @param t
+ * @param m
+ * @param n
+ * @return 增加了一个引用的形状；键数或形状数超过上限时返回 NULL，成员不变
+ */
+static lept_shape *lept_shapes_get(lept_shapes *t, const lept_member *m, size_t n) {
+    uint32_t hash = 2166136261u;
+    size_t i;
+    lept_shape *s;
+    if (n == 0 || n > LEPT_SHAPE_MAX_KEYS)
+        return NULL;
+    if ((s = t->last) == NULL || !lept_shape_match(s, m, n)) {
+        for (i = 0; i < n; i++)
+            hash = (hash ^ lept_hash_key(m[i].k, m[i].klen)) * 16777619u;
+        s = NULL;
+        if (t->e != NULL) {
+            for (i = hash & t->mask; t->e[i] != NULL; i = (i + 1) & t->mask) {
+                if (t->e[i]->hash == hash && lept_shape_match(t->e[i], m, n)) {
+                    s = t->e[i];
+                    break;
+                }
+            }
+        }
+        if (s == NULL) {
+            if (t->count >= LEPT_SHAPES_MAX)
+                return NULL;
+            /* 负载不超过一半 */
+            if ((t->count + 1) * 2 > t->mask + 1) {
+                lept_shape **old = t->e;
+                size_t j, size = old ? t->mask + 1 : 0;
+                t->mask = size ? size * 2 - 1 : 15;
+                t->e = (lept_shape **) calloc(t->mask + 1, sizeof(lept_shape *));
+                for (j = 0; j < size; j++) {
+                    if (old[j] == NULL)
+                        continue;
+                    for (i = old[j]->hash & t->mask; t->e[i] != NULL; i = (i + 1) & t->mask)
+                        ;
+                    t->e[i] = old[j];
+                }
+                free(old);
+                for (i = hash & t->mask; t->e[i] != NULL; i = (i + 1) & t->mask)
+                    ;
+            }
+            t->e[i] = lept_shape_new(m, n, hash);
+            t->count++;
+            t->last = t->e[i];
+            t->last->refs++;
+            return t->last;
+        }
+        t->last = s;
+    }
+    for (i = 0; i < n; i++)
+        lept_key_free(m[i].k, m[i].kflags);
+    s->refs++;
+    return s;
+}
+
+/* 文档区块的默认大小 */
+#define LEPT_DOCUMENT_CHUNK_SIZE 65536
+
+/* 区块中数组和对象的元素（成员）数组按此对齐，字符串不对齐 */
+#define LEPT_DOCUMENT_ALIGN 8
+
+/* 文档的区块：结构体之后即为 size 字节的可分配空间 */
+struct lept_chunk {
+    lept_chunk *next;
+    size_t size;
+};
+
+/**
+ * 当前区块放不下时换到下一个区块：依次重用 reset 后保留的区块（放不下的跳过），
+ * 都用完时新分配，大小为前一个的两倍且至少为 size
+ *
+ * @param d
+ * @param size
+ * @return 新区块的起始位置
+ */
+static char *lept_document_grow(lept_document *d, size_t size) {
+    lept_chunk *k;
+    while ((k = d->current ? d->current->next : d->chunks) != NULL) {
+        d->current = k;
+        if (k->size >= size)
+            break;
+    }
+    if (k == NULL) {
+        size_t n = d->current ? d->current->size * 2 : d->chunk_size;
+        if (n < size)
+            n = size;
+        k = (lept_chunk *) malloc(sizeof(lept_chunk) + n);
+        k->next = NULL;
+        k->size = n;
+        if (d->current)
+            d->current->next = k;
+        else
+            d->chunks = k;
+        d->current = k;
+    }
+    d->end = (char *) (k + 1) + k->size;
+    return (char *) (k + 1);
+}
+
+/**
+ * 从文档的区块中分配
+ *
+ * @param d
+ * @param size  大于 0
+ * @param align 1 或 LEPT_DOCUMENT_ALIGN
+ * @return
+ */
+static LEPT_INLINE void *lept_document_alloc(lept_document *d, size_t size, size_t align) {
+    char *p = (char *) (((uintptr_t) d->top + align - 1) & ~(uintptr_t) (align - 1));
+    if (p > d->end || (size_t) (d->end - p) < size)
+        p = lept_document_grow(d, size);
+    d->top = p + size;
+    return p;
+}
+
+/**
+ * 在文档的区块中复制字符串并以 '\0' 结尾
+ *
+ * @param d
+ * @param s
+ * @param len
+ * @return
+ */
+static char *lept_document_strndup(lept_document *d, const char *s, size_t len) {
+    char *p = (char *) lept_document_alloc(d, len + 1, 1);
+    memcpy(p, s, len);
+    p[len] = '\0';
+    return p;
+}
+
+/*
+ * 构建多个值时保留的键表和形状表：并行解析时每个线程一份，NDJSON 每块一份，
+ * 使各元素（记录）之间也能共享键和形状
+ */
+typedef struct {
+    lept_intern keys;
+    lept_shapes shapes;
+} lept_dom_tables;
+
+static void lept_dom_tables_init(lept_dom_tables *t) {
+    lept_intern_init(&t->keys);
+    lept_shapes_init(&t->shapes);
+}
+
+static void lept_dom_tables_free(lept_dom_tables *t) {
+    lept_intern_free(&t->keys);
+    lept_shapes_free(&t->shapes);
+}
+
+/**
+ * 构建 lept_value 的事件处理上下文：帧（lept_frame）及其上已完成的元素或成员压在自己的堆栈上，
+ * 与驱动解析的堆栈分开
+ */
+typedef struct {
+    lept_context *in;   /* 驱动解析的上下文：判断字符串是否引用输入、延迟解析时读取当前位置 */
+    const char *begin;  /* 输入的起始位置 */
+    unsigned flags;     /* 解析选项（LEPT_PARSE_OPT_*） */
+    lept_context s;     /* 只用其中的堆栈 */
+    size_t frame;       /* 最内层帧的偏移 */
+    const char *lazy;   /* 延迟解析：正被跳过的容器的起始位置 */
+    lept_value v;       /* 完成的根值 */
+    lept_intern keys;   /* LEPT_PARSE_OPT_INTERN_KEYS 或 LEPT_PARSE_OPT_SHAPES 时的键表 */
+    lept_shapes shapes; /* LEPT_PARSE_OPT_SHAPES 时的形状表 */
+    lept_document *doc; /* 非 NULL 时字符串、键和元素数组从文档的区块中分配 */
+} lept_dom;
+
+/**
+ * 字符串能否直接引用：原地解析，或 LEPT_PARSE_OPT_BORROW 下位于输入中（不含转义）
+ *
+ * @param d
+ * @param s
+ * @return
+ */
+static int lept_dom_borrow(const lept_dom *d, const char *s) {
+    return d->in->insitu || ((d->flags & LEPT_PARSE_OPT_BORROW) && s >= d->begin && s <= d->in->end);
+}
+
+/**
+ * 把已完成的值加入外层的数组或对象，没有外层时即为根值
+ *
+ * @param d
+ * @param e
+ * @return
+ */
+static LEPT_INLINE int lept_dom_add(lept_dom *d, const lept_value *e) {
+    lept_frame *f;
+    if (d->frame == LEPT_NO_FRAME) {
+        memcpy(&d->v, e, sizeof(lept_value));
+        return LEPT_SAX_CONTINUE;
+    }
+    if (LEPT_FRAME(&d->s, d->frame)->type == LEPT_ARRAY) {
+        memcpy(lept_context_push(&d->s, sizeof(lept_value)), e, sizeof(lept_value));
+        f = LEPT_FRAME(&d->s, d->frame);
+    } else {
+        lept_member *m = (lept_member *) lept_context_push(&d->s, sizeof(lept_member));
+        f = LEPT_FRAME(&d->s, d->frame);
+        f->m.v = *e;
+        memcpy(m, &f->m, sizeof(lept_member));
+        f->m.k = NULL; /* ownership is transferred to member on stack */
+    }
+    f->size++;
+    return LEPT_SAX_CONTINUE;
+}
+
+static int lept_dom_null(void *ctx) {
+    lept_value e;
+    lept_init(&e);
+    return lept_dom_add((lept_dom *) ctx, &e);
+}
+
+static int lept_dom_bool(void *ctx, int b) {
+    lept_value e;
+    lept_init(&e);
+    e.type = b ? LEPT_TRUE : LEPT_FALSE;
+    return lept_dom_add((lept_dom *) ctx, &e);
+}
+
+static int lept_dom_number(void *ctx, const lept_value *n) {
+    return lept_dom_add((lept_dom *) ctx, n);
+}
+
+static int lept_dom_string(void *ctx, const char *s, size_t len) {
+    lept_dom *d = (lept_dom *) ctx;
+    lept_value e;
+    lept_init(&e);
+    if (lept_dom_borrow(d, s)) {
+        /* 引用输入，lept_free 时不释放 */
+        e.u.s.s = (char *) s;
+        e.u.s.len = len;
+        e.flags = LEPT_FLAG_BORROWED;
+        e.type = LEPT_STRING;
+    } else if (d->doc) {
+        /* 在文档的区块中，同样不由 lept_free 释放 */
+        e.u.s.s = lept_document_strndup(d->doc, s, len);
+        e.u.s.len = len;
+        e.flags = LEPT_FLAG_BORROWED;
+        e.type = LEPT_STRING;
+    } else {
+        lept_set_string(&e, s, len);
+    }
+    return lept_dom_add(d, &e);
+}
+
+static int lept_dom_key(void *ctx, const char *k, size_t len) {
+    lept_dom *d = (lept_dom *) ctx;
+    lept_frame *f = LEPT_FRAME(&d->s, d->frame);
+    f->m.klen = len;
+    if (lept_dom_borrow(d, k)) {
+        f->m.k = (char *) k;
+        f->m.kflags = LEPT_FLAG_BORROWED;
+    } else if (d->doc) {
+        f->m.k = lept_document_strndup(d->doc, k, len);
+        f->m.kflags = LEPT_FLAG_BORROWED;
+    } else if ((d->flags & (LEPT_PARSE_OPT_INTERN_KEYS | LEPT_PARSE_OPT_SHAPES)) &&
+               (f->m.k = lept_intern_key(&d->keys, k, len)) != NULL) {
+        /* 相同的键共享一份内存；按形状保存时与形状比较只需比较指针 */
+        f->m.kflags = LEPT_FLAG_SHARED;
+    } else {
+        memcpy(f->m.k = (char *) malloc(len + 1), k, len);
+        f->m.k[len] = '\0';
+        f->m.kflags = 0;
+    }
+    return LEPT_SAX_CONTINUE;
+}
+
+/**
+ * 开始数组或对象：压入帧；延迟解析时根值以下的容器改为跳过
+ *
+ * @param d
+ * @param type
+ * @return
+ */
+static int lept_dom_start(lept_dom *d, lept_type type) {
+    lept_frame *f;
+    if ((d->flags & LEPT_PARSE_OPT_LAZY) && d->frame != LEPT_NO_FRAME) {
+        /* 事件在左括号之后产生 */
+        d->lazy = d->in->json - 1;
+        return LEPT_SAX_SKIP;
+    }
+    f = (lept_frame *) lept_context_push(&d->s, sizeof(lept_frame));
+    f->parent = d->frame;
+    f->size = 0;
+    f->type = type;
+    f->m.k = NULL;
+    d->frame = (char *) f - d->s.stack;
+    return LEPT_SAX_CONTINUE;
+}
+
+/**
+ * 结束数组或对象：元素出栈构成值，再弹出帧；被跳过的容器记录源文本区间
+ *
+ * @param d
+ * @param type
+ * @param size
+ * @return
+ */
+static int lept_dom_end(lept_dom *d, lept_type type, size_t size) {
+    lept_value e;
+    lept_init(&e);
+    if (d->lazy != NULL) {
+        const char *p = d->lazy + 1;
+        while (ISWS(*p))
+            p++;
+        if (p + 1 == d->in->json) {
+            /* 空容器直接构建 */
+            type == LEPT_ARRAY ? lept_set_array(&e, 0) : lept_set_object(&e, 0);
+        } else {
+            e.type = type;
+            e.flags = LEPT_FLAG_LAZY;
+            e.u.l.json = d->lazy;
+            e.u.l.len = d->in->json - d->lazy;
+            e.u.l.flags = d->flags;
+        }
+        d->lazy = NULL;
+        return lept_dom_add(d, &e);
+    }
+    assert(LEPT_FRAME(&d->s, d->frame)->size == size);
+    if (d->doc && size > 0) {
+        /* 元素（成员）数组在文档的区块中，容量即为元素个数 */
+        size_t n = size * (type == LEPT_ARRAY ? sizeof(lept_value) : sizeof(lept_member));
+        void *p = lept_document_alloc(d->doc, n, LEPT_DOCUMENT_ALIGN);
+        memcpy(p, lept_context_pop(&d->s, n), n);
+        e.type = type;
+        e.flags = LEPT_FLAG_BORROWED;
+        if (type == LEPT_ARRAY) {
+            e.u.a.e = (lept_value *) p;
+            e.u.a.size = e.u.a.capacity = size;
+        } else {
+            e.u.o.m = (lept_member *) p;
+            e.u.o.size = e.u.o.capacity = size;
+        }
+    } else if (type == LEPT_ARRAY) {
+        lept_set_array(&e, size);
+        if (size > 0)
+            memcpy(e.u.a.e, lept_context_pop(&d->s, size * sizeof(lept_value)), size * sizeof(lept_value));
+        e.u.a.size = size;
+    } else {
+        const lept_member *m = (const lept_member *) lept_context_pop(&d->s, size * sizeof(lept_member));
+        lept_shape *shape;
+        if ((d->flags & LEPT_PARSE_OPT_SHAPES) && (shape = lept_shapes_get(&d->shapes, m, size)) != NULL) {
+            /* 键由形状保存，对象只保存值 */
+            size_t i;
+            e.type = LEPT_OBJECT;
+            e.flags = LEPT_FLAG_SHAPED;
+            e.u.h.shape = shape;
+            e.u.h.v = (lept_value *) malloc(size * sizeof(lept_value));
+            for (i = 0; i < size; i++)
+                memcpy(&e.u.h.v[i], &m[i].v, sizeof(lept_value));
+        } else {
+            lept_set_object(&e, size);
+            if (size > 0)
+                memcpy(e.u.o.m, m, size * sizeof(lept_member));
+            e.u.o.size = size;
+        }
+    }
+    d->frame = ((lept_frame *) lept_context_pop(&d->s, sizeof(lept_frame)))->parent;
+    return lept_dom_add(d, &e);
+}
+
+static int lept_dom_start_object(void *ctx) {
+    return lept_dom_start((lept_dom *) ctx, LEPT_OBJECT);
+}
+
+static int lept_dom_end_object(void *ctx, size_t size) {
+    return lept_dom_end((lept_dom *) ctx, LEPT_OBJECT, size);
+}
+
+static int lept_dom_start_array(void *ctx) {
+    return lept_dom_start((lept_dom *) ctx, LEPT_ARRAY);
+}
+
+static int lept_dom_end_array(void *ctx, size_t size) {
+    return lept_dom_end((lept_dom *) ctx, LEPT_ARRAY, size);
+}
+
+static const lept_sax_handler lept_dom_handler = {
+    lept_dom_null,
+    lept_dom_bool,
+    lept_dom_number,
+    lept_dom_string,
+    lept_dom_key,
+    lept_dom_start_object,
+    lept_dom_end_object,
+    lept_dom_start_array,
+    lept_dom_end_array
+};
+
+/**
+ * 解析 JSON 值并构建 lept_value：由 SAX 事件驱动，出错时释放已构建的部分
+ *
+ * @param c
+ * @param s     构建用的堆栈（只用其中的堆栈），可在多次解析间重用
+ * @param v
+ * @param t     非 NULL 时使用并保留其中的键表和形状表，否则只在本次解析中使用
+ * @return
+ */
+static int lept_parse_value_stack(lept_context *c, lept_context *s, lept_value *v, lept_dom_tables *t) {
+    lept_dom d;
+    unsigned flags = c->flags;
+    int ret;
+    d.in = c;
+    d.begin = c->json;
+    d.flags = flags;
+    d.s = *s;
+    d.frame = LEPT_NO_FRAME;
+    d.lazy = NULL;
+    if (t) {
+        d.keys = t->keys;
+        d.shapes = t->shapes;
+    } else {
+        lept_intern_init(&d.keys);
+        lept_shapes_init(&d.shapes);
+    }
+    d.doc = c->doc;
+    /* 事件中的字符串不含转义时总是直接指向输入，是否引用由 lept_dom_borrow 按选项决定 */
+    c->flags |= LEPT_PARSE_OPT_BORROW;
+    ret = lept_sax_parse_value(c, &lept_dom_handler, &d);
+    c->flags = flags;
+    if (t) {
+        t->keys = d.keys;
+        t->shapes = d.shapes;
+    } else {
+        lept_intern_free(&d.keys);
+        lept_shapes_free(&d.shapes);
+    }
+    if (ret == LEPT_PARSE_OK) {
+        assert(d.frame == LEPT_NO_FRAME && d.s.top == 0);
+        memcpy(v, &d.v, sizeof(lept_value));
+    } else {
+        lept_parse_unwind(&d.s, d.frame);
+    }
+    *s = d.s;
+    return ret;
+}
+
+/**
+ * 解析 JSON 值并构建 lept_value
+ *
+ * @param c
+ * @param v
+ * @return
+ */
+static int lept_parse_value(lept_context *c, lept_value *v) {
+    lept_context s;
+    int ret;
+    s.stack = NULL;
+    s.size = s.top = 0;
+    ret = lept_parse_value_stack(c, &s, v, NULL);
+    free(s.stack);
+    return ret;
+}
+
+/**
+ * 初始化解析上下文，并在首次解析时选择扫描函数
+ *
+ * @param c
+ * @param json
+ * @param len
+ * @param insitu
+ * @param opts  解析选项，NULL 时使用默认值
+ */
+static void lept_context_init(lept_context *c, const char *json, size_t len, int insitu, const lept_parse_options *opts) {
+    c->json = json;
+    c->end = json + len;
+    c->stack = NULL;
+    c->size = c->top = 0;
+    c->insitu = insitu;
+    c->flags = opts ? opts->flags : 0;
+    c->max_depth = opts ? opts->max_depth : 0;
+    c->doc = NULL;
+    LEPT_SIMD_INIT();
+}
+
+/**
+ * 解析 JSON 文本开头的一个值（及其后的空白）
+ *
+ * @param v
+ * @param json
+ * @param len
+ * @param singular  是否要求值之后再无其他字符
+ * @param insitu    是否原地解析（json 可写）
+ * @param opts      解析选项，NULL 时使用默认值
+ * @param consumed  非 NULL 时返回解析停止处相对 json 的偏移
+ * @param w         非 NULL 时使用并保留其中的堆栈，否则使用临时的堆栈
+ * @param doc       非 NULL 时构建的值从文档的区块中分配
+ * @return
+ */
+static int lept_parse_root(lept_value *v, const char *json, size_t len, int singular, int insitu,
+                           const lept_parse_options *opts, size_t *consumed, lept_workspace *w, lept_document *doc) {
+    lept_context c, s;
+    int ret;
+    assert(v != NULL && (json != NULL || len == 0));
+    lept_context_init(&c, json, len, insitu, opts);
+    c.doc = doc;
+    lept_init(v);
+    s.stack = NULL;
+    s.size = s.top = 0;
+    if (w) {
+        c.stack = w->stack;
+        c.size = w->ssize;
+        s.stack = w->values;
+        s.size = w->vsize;
+    }
+
+    /* 去除空白、换行符、制表符 */
+    lept_parse_whitespace(&c);
+
+    /**
+     * 解析结果并判断结果
+     * JSON 文本应该有 3 部分：JSON-text = ws value ws；
+     * 以下判断第三部分，即解析空白然后检查 JSON 文本是否完结
+     */
+    if ((ret = lept_parse_value_stack(&c, &s, v, NULL)) == LEPT_PARSE_OK) {
+        /* 解析成功后，再跳过后面的空白，判断是否已到末尾 */
+        lept_parse_whitespace(&c);
+        if (singular && c.json != c.end) {
+            lept_free(v);
+            ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+        }
+    }
+    if (consumed) {
+        *consumed = c.json - json;
+    }
+    /* 最后确保所有数据从缓冲区弹出 */
+    assert(c.top == 0 && s.top == 0);
+    if (w) {
+        w->stack = c.stack;
+        w->ssize = c.size;
+        w->values = s.stack;
+        w->vsize = s.size;
+    } else {
+        free(c.stack);
+        free(s.stack);
+    }
+    return ret;
+}
+
+/**
+ * 解析 JSON
+ *
+ * @param v
+ * @param json
+ * @return
+ */
+int lept_parse(lept_value *v, const char *json) {
+    assert(json != NULL);
+    return lept_parse_root(v, json, strlen(json), 1, 0, NULL, NULL, NULL, NULL);
+}
+
+/**
+ * 解析长度为 len 的 JSON，不要求以 '\0' 结尾
+ *
+ * @param v
+ * @param json
+ * @param len
+ * @return
+ */
+int lept_parse_n(lept_value *v, const char *json, size_t len) {
+    return lept_parse_root(v, json, len, 1, 0, NULL, NULL, NULL, NULL);
+}
+
+/**
+ * 解析 JSON 开头的一个值，允许其后还有其他内容
+ *
+ * @param v
+ * @param json
+ * @param len
+ * @param consumed
+ * @return
+ */
+int lept_parse_prefix(lept_value *v, const char *json, size_t len, size_t *consumed) {
+    return lept_parse_root(v, json, len, 0, 0, NULL, consumed, NULL, NULL);
+}
+
+/**
+ * 原地解析：字符串和键在 buf 中解码并引用 buf
+ *
+ * @param v
+ * @param buf
+ * @param len
+ * @return
+ */
+int lept_parse_insitu(lept_value *v, char *buf, size_t len) {
+    return lept_parse_root(v, buf, len, 1, 1, NULL, NULL, NULL, NULL);
+}
+
+/**
+ * 按选项解析
+ *
+ * @param v
+ * @param json
+ * @param len
+ * @param opts
+ * @return
+ */
+int lept_parse_opts(lept_value *v, const char *json, size_t len, const lept_parse_options *opts) {
+    if (opts && opts->nthreads > 1) {
+        return lept_parse_parallel(v, json, len, opts);
+    }
+    return lept_parse_root(v, json, len, 1, 0, opts, NULL, NULL, NULL);
+}
+
+/**
+ * 把文件读入堆上的缓冲区（无法映射的文件，如管道，以及不支持 mmap 的平台）
+ *
+ * @param f
+ * @param path
+ * @return
+ */
+static int lept_file_read(lept_file *f, const char *path) {
+    FILE *fp = fopen(path, "rb");
+    char *buf = NULL;
+    size_t size = 0, len = 0, n;
+    if (fp == NULL) {
+        return LEPT_PARSE_IO_ERROR;
+    }
+    do {
+        if (len == size) {
+            char *p;
+            size = size ? size + (size >> 1) : 65536;
+            if ((p = (char *) realloc(buf, size)) == NULL) {
+                free(buf);
+                fclose(fp);
+                return LEPT_PARSE_IO_ERROR;
+            }
+            buf = p;
+        }
+        n = fread(buf + len, 1, size - len, fp);
+        len += n;
+    } while (n > 0);
+    if (ferror(fp)) {
+        free(buf);
+        fclose(fp);
+        return LEPT_PARSE_IO_ERROR;
+    }
+    fclose(fp);
+    f->json = buf;
+    f->len = len;
+    f->mapped = 0;
+    return LEPT_PARSE_OK;
+}
+
+/**
+ * 只读映射文件
+ *
+ * @param f
+ * @param path
+ * @return
+ */
+int lept_file_open(lept_file *f, const char *path) {
+#ifdef LEPT_MMAP
+    struct stat st;
+    void *p;
+    int fd;
+#endif
+    assert(f != NULL && path != NULL);
+    f->json = NULL;
+    f->len = 0;
+    f->mapped = 0;
+#ifdef LEPT_MMAP
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return LEPT_PARSE_IO_ERROR;
+    }
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return LEPT_PARSE_IO_ERROR;
+    }
+    /* 空文件不能映射，直接得到长度为 0 的内容 */
+    if (S_ISREG(st.st_mode) && st.st_size == 0) {
+        close(fd);
+        return LEPT_PARSE_OK;
+    }
+    if (S_ISREG(st.st_mode) && (uint64_t) st.st_size <= (size_t) -1) {
+        p = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        /* 映射建立后即可关闭文件 */
+        close(fd);
+        if (p != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+            /* 解析顺序访问：内核可以加大预读并及早回收读过的页 */
+            madvise(p, (size_t) st.st_size, MADV_SEQUENTIAL);
+#endif
+            f->json = (const char *) p;
+            f->len = (size_t) st.st_size;
+            f->mapped = 1;
+            return LEPT_PARSE_OK;
+        }
+    } else {
+        close(fd);
+    }
+#endif
+    return lept_file_read(f, path);
+}
+
+/**
+ * 解除映射
+ *
+ * @param f
+ */
+void lept_file_close(lept_file *f) {
+    assert(f != NULL);
+#ifdef LEPT_MMAP
+    if (f->mapped) {
+        munmap((void *) f->json, f->len);
+    } else
+#endif
+    {
+        free((void *) f->json);
+    }
+    f->json = NULL;
+    f->len = 0;
+    f->mapped = 0;
+}
+
+/**
+ * 映射并解析文件
+ *
+ * @param v
+ * @param path
+ * @param opts
+ * @return
+ */
+int lept_parse_file(lept_value *v, const char *path, const lept_parse_options *opts) {
+    lept_parse_options o = {0};
+    lept_file f;
+    int ret;
+    assert(v != NULL);
+    if ((ret = lept_file_open(&f, path)) != LEPT_PARSE_OK) {
+        lept_init(v);
+        return ret;
+    }
+    /* 映射在返回前解除，结果不能引用文件内容 */
+    if (opts) {
+        o = *opts;
+        o.flags &= ~(unsigned) (LEPT_PARSE_OPT_BORROW | LEPT_PARSE_OPT_LAZY);
+    }
+    ret = lept_parse_opts(v, f.json, f.len, &o);
+    lept_file_close(&f);
+    return ret;
+}
+
+/* 校验时各层右括号存放在调用栈上的缓冲区中，更深的嵌套才改用堆 */
+#define LEPT_VALIDATE_STACK_SIZE 1024
+
+/**
+ * 校验一个值，不构建、不解码
+ *
+ * @param c
+ * @return
+ */
+static int lept_skip_value(lept_context *c) {
+    lept_value e;
+    char close;
+    if (c->json == c->end) {
+        return LEPT_PARSE_EXPECT_VALUE;
+    }
+    switch (lept_token[(unsigned char) *c->json]) {
+        case LEPT_TOKEN_NULL:
+            return lept_parse_literal(c, &e, "null", LEPT_NULL);
+        case LEPT_TOKEN_TRUE:
+            return lept_parse_literal(c, &e, "true", LEPT_TRUE);
+        case LEPT_TOKEN_FALSE:
+            return lept_parse_literal(c, &e, "false", LEPT_FALSE);
+        case LEPT_TOKEN_NUMBER:
+            return lept_skip_number(c);
+        case LEPT_TOKEN_STRING:
+            return lept_skip_string(c);
+        case LEPT_TOKEN_ARRAY:
+        case LEPT_TOKEN_OBJECT:
+            close = *c->json++ == '[' ? ']' : '}';
+            lept_parse_whitespace(c);
+            if (PEEK(c) == close) {
+                c->json++;
+                return LEPT_PARSE_OK;
+            }
+            return lept_skip_container(c, close == ']' ? LEPT_ARRAY : LEPT_OBJECT, 1);
+        default:
+            return LEPT_PARSE_INVALID_VALUE;
+    }
+}
+
+/**
+ * 只校验，不分配内存（嵌套超过 1023 层时除外）
+ *
+ * @param json
+ * @param len
+ * @return
+ */
+int lept_validate(const char *json, size_t len) {
+    char buf[LEPT_VALIDATE_STACK_SIZE];
+    lept_context c;
+    int ret;
+    assert(json != NULL || len == 0);
+    lept_context_init(&c, json, len, 0, NULL);
+    /* 缓冲区足够时堆栈不会扩展：每层一个字节，嵌套层数限制为缓冲区大小减一 */
+    c.stack = buf;
+    c.size = sizeof(buf);
+    c.max_depth = sizeof(buf) - 1;
+    lept_parse_whitespace(&c);
+    if ((ret = lept_skip_value(&c)) == LEPT_PARSE_DEPTH_EXCEEDED) {
+        /* 嵌套更深：从头用堆上的堆栈重新校验 */
+        lept_context_init(&c, json, len, 0, NULL);
+        lept_parse_whitespace(&c);
+        ret = lept_skip_value(&c);
+        free(c.stack);
+    }
+    if (ret == LEPT_PARSE_OK) {
+        lept_parse_whitespace(&c);
+        if (c.json != c.end) {
+            ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+        }
+    }
+    return ret;
+}
+
+/* 路径中的一个记号 */
+typedef struct {
+    const char *s;      /* 已还原 "~1"、"~0" 的记号 */
+    size_t len;
+    size_t index;       /* 记号是数组下标时为其值，否则为 LEPT_SELECT_NO_INDEX */
+    int wildcard;       /* "*"：匹配任何成员或元素 */
+} lept_select_token;
+
+#define LEPT_SELECT_NO_INDEX ((size_t) -1)
+
+/* 按 JSON Pointer 选择性解析的状态 */
+typedef struct {
+    lept_select_token *tokens;  /* 各路径的记号依次存放 */
+    size_t *first, *count;      /* 各路径首个记号的位置及记号数 */
+    size_t npaths;
+    size_t *active;             /* 各层仍匹配的路径：第 d 层的列表在 active + d * npaths */
+    lept_context values;        /* 构建选中子树时重用的堆栈 */
+} lept_select;
+
+/**
+ * 把路径拆成记号，记号的内容写入 buf（不长于路径本身）
+ *
+ * @param s
+ * @param pointer
+ * @param buf
+ * @return 记号数
+ */
+static size_t lept_select_compile(lept_select *s, const char *pointer, char *buf) {
+    size_t n = 0;
+    const char *p = pointer;
+    /* "" 表示整个文档 */
+    assert(*p == '\0' || *p == '/');
+    while (*p == '/') {
+        lept_select_token *t = &s->tokens[s->first[s->npaths] + n++];
+        char *q = buf;
+        for (p++; *p != '\0' && *p != '/'; p++) {
+            if (*p == '~' && (p[1] == '0' || p[1] == '1')) {
+                *q++ = *++p == '0' ? '~' : '/';
+            } else {
+                *q++ = *p;
+            }
+        }
+        t->s = buf;
+        t->len = q - buf;
+        t->wildcard = t->len == 1 && *buf == '*';
+        /* 下标："0" 或不以 0 开头的数字 */
+        t->index = LEPT_SELECT_NO_INDEX;
+        if (t->len > 0 && t->len < 20 && (t->len == 1 || *buf != '0')) {
+            size_t i, index = 0;
+            for (i = 0; i < t->len && ISDIGIT(buf[i]); i++)
+                index = index * 10 + (buf[i] - '0');
+            if (i == t->len)
+                t->index = index;
+        }
+        buf = q;
+    }
+    return n;
+}
+
+/**
+ * 选出第 depth 个记号与成员键（key 非 NULL）或元素下标匹配的路径
+ *
+ * @param s
+ * @param depth
+ * @param nactive
+ * @param key
+ * @param len
+ * @param index
+ * @return 匹配的路径数，列表写在第 depth + 1 层
+ */
+static size_t lept_select_match(const lept_select *s, size_t depth, size_t nactive, const char *key, size_t len, size_t index) {
+    const size_t *active = s->active + depth * s->npaths;
+    size_t *next = s->active + (depth + 1) * s->npaths;
+    size_t i, n = 0;
+    for (i = 0; i < nactive; i++) {
+        const lept_select_token *t = &s->tokens[s->first[active[i]] + depth];
+        if (t->wildcard || (key ? t->len == len && memcmp(t->s, key, len) == 0 : t->index == index))
+            next[n++] = active[i];
+    }
+    return n;
+}
+
+/**
+ * 解析一个值，只构建第 depth 层仍匹配的路径所选中的部分，其余只校验
+ *
+ * @param s
+ * @param c
+ * @param nactive   仍匹配的路径数（> 0）
+ * @param depth
+ * @param v
+ * @param selected  值是否被选中：完整的路径终点，或路径经过的数组和对象
+ * @return
+ */
+static int lept_select_value(lept_select *s, lept_context *c, size_t nactive, size_t depth, lept_value *v, int *selected) {
+    const size_t *active = s->active + depth * s->npaths;
+    lept_value *e = NULL;
+    lept_member *m = NULL;
+    size_t i, n = 0, capacity = 0, index = 0;
+    char close;
+    int ret;
+    lept_init(v);
+    *selected = 1;
+    for (i = 0; i < nactive; i++) {
+        if (s->count[active[i]] == depth)
+            return lept_parse_value_stack(c, &s->values, v, NULL);
+    }
+    /* 路径还要继续深入，标量不被选中 */
+    if (PEEK(c) != '[' && PEEK(c) != '{') {
+        *selected = 0;
+        return lept_skip_value(c);
+    }
+    close = *c->json++ == '[' ? ']' : '}';
+    lept_parse_whitespace(c);
+    if (PEEK(c) == close) {
+        c->json++;
+        close == ']' ? lept_set_array(v, 0) : lept_set_object(v, 0);
+        return LEPT_PARSE_OK;
+    }
+    for (;;) {
+        lept_value child;
+        char *key = NULL;
+        size_t len = 0, nnext;
+        int borrowed, sel = 0;
+        if (close == '}') {
+            if (PEEK(c) != '"') {
+                ret = LEPT_PARSE_MISS_KEY;
+                break;
+            }
+            c->flags |= LEPT_PARSE_OPT_BORROW;
+            ret = lept_parse_string_raw(c, &key, &len, &borrowed);
+            c->flags &= ~LEPT_PARSE_OPT_BORROW;
+            if (ret != LEPT_PARSE_OK)
+                break;
+            nnext = lept_select_match(s, depth, nactive, key, len, 0);
+            lept_parse_whitespace(c);
+            if (PEEK(c) != ':') {
+                ret = LEPT_PARSE_MISS_COLON;
+                break;
+            }
+            c->json++;
+            lept_parse_whitespace(c);
+            /* 键可能在堆栈上，解析值之前复制 */
+            key = nnext > 0 ? lept_strndup(key, len) : NULL;
+        } else {
+            nnext = lept_select_match(s, depth, nactive, NULL, 0, index);
+        }
+        ret = nnext > 0 ? lept_select_value(s, c, nnext, depth + 1, &child, &sel) : lept_skip_value(c);
+        if (ret != LEPT_PARSE_OK || !sel) {
+            free(key);
+        } else if (close == '}') {
+            if (n == capacity) {
+                capacity = capacity ? capacity + (capacity >> 1) : 4;
+                m = (lept_member *) realloc(m, capacity * sizeof(lept_member));
+            }
+            m[n].k = key;
+            m[n].klen = len;
+            m[n].kflags = 0;
+            memcpy(&m[n++].v, &child, sizeof(lept_value));
+        } else {
+            /* 未选中的元素在选中的元素之前时以 null 占位，下标与原文档相同 */
+            if (index >= capacity) {
+                capacity = index + 1 > capacity + (capacity >> 1) ? index + 1 : capacity + (capacity >> 1);
+                e = (lept_value *) realloc(e, capacity * sizeof(lept_value));
+            }
+            for (; n < index; n++)
+                lept_init(&e[n]);
+            memcpy(&e[n++], &child, sizeof(lept_value));
+        }
+        if (ret != LEPT_PARSE_OK)
+            break;
+        index++;
+        lept_parse_whitespace(c);
+        if (PEEK(c) == ',') {
+            c->json++;
+            lept_parse_whitespace(c);
+            continue;
+        }
+        if (PEEK(c) == close) {
+            c->json++;
+            break;
+        }
+        ret = close == ']' ? LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET : LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+        break;
+    }
+    if (close == ']') {
+        lept_set_array(v, n);
+        if (n > 0)
+            memcpy(v->u.a.e, e, n * sizeof(lept_value));
+        v->u.a.size = n;
+    } else {
+        lept_set_object(v, n);
+        if (n > 0)
+            memcpy(v->u.o.m, m, n * sizeof(lept_member));
+        v->u.o.size = n;
+    }
+    free(e);
+    free(m);
+    if (ret != LEPT_PARSE_OK)
+        lept_free(v);
+    return ret;
+}
+
+/**
+ * 只构建 JSON Pointer 选中的部分
+ *
+ * @param v
+ * @param json
+ * @param len
+ * @param pointers
+ * @param n
+ * @return
+ */
+int lept_parse_select(lept_value *v, const char *json, size_t len, const char **pointers, size_t n) {
+    lept_select s;
+    lept_context c;
+    size_t i, ntokens = 0, size = 0, maxdepth = 0;
+    char *buf;
+    int ret, selected;
+    assert(v != NULL && (json != NULL || len == 0) && (pointers != NULL || n == 0));
+    for (i = 0; i < n; i++) {
+        const char *p;
+        for (p = pointers[i]; *p != '\0'; p++)
+            ntokens += *p == '/';
+        size += p - pointers[i];
+    }
+    s.tokens = (lept_select_token *) malloc((ntokens + 1) * sizeof(lept_select_token));
+    s.first = (size_t *) malloc((n + 1) * 2 * sizeof(size_t));
+    s.count = s.first + n + 1;
+    buf = (char *) malloc(size + 1);
+    s.npaths = 0;
+    s.first[0] = 0;
+    for (i = 0, size = 0; i < n; i++) {
+        s.count[i] = lept_select_compile(&s, pointers[i], buf + size);
+        size += strlen(pointers[i]);
+        s.first[i + 1] = s.first[i] + s.count[i];
+        s.npaths++;
+        if (s.count[i] > maxdepth)
+            maxdepth = s.count[i];
+    }
+    s.active = (size_t *) malloc((maxdepth + 1) * (n + 1) * sizeof(size_t));
+    s.values.stack = NULL;
+    s.values.size = s.values.top = 0;
+
+    lept_context_init(&c, json, len, 0, NULL);
+    lept_init(v);
+    lept_parse_whitespace(&c);
+    for (i = 0; i < n; i++)
+        s.active[i] = i;
+    ret = n > 0 ? lept_select_value(&s, &c, n, 0, v, &selected) : lept_skip_value(&c);
+    if (ret == LEPT_PARSE_OK) {
+        lept_parse_whitespace(&c);
+        if (c.json != c.end) {
+            lept_free(v);
+            ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+        }
+    }
+    assert(c.top == 0);
+    free(c.stack);
+    free(s.values.stack);
+    free(s.active);
+    free(s.tokens);
+    free(s.first);
+    free(buf);
+    return ret;
+}
+
+/**
+ * 以事件方式解析，不构建 lept_value
+ *
+ * @param json
+ * @param len
+ * @param handler
+ * @param ctx
+ * @param opts
+ * @return
+ */
+int lept_parse_sax(const char *json, size_t len, const lept_sax_handler *handler, void *ctx,
+                   const lept_parse_options *opts) {
+    lept_context c;
+    int ret;
+    assert(handler != NULL && (json != NULL || len == 0));
+    lept_context_init(&c, json, len, 0, opts);
+    /* 事件中的字符串只在回调期间有效，不含转义时直接指向输入 */
+    c.flags |= LEPT_PARSE_OPT_BORROW;
+    lept_parse_whitespace(&c);
+    if ((ret = lept_sax_parse_value(&c, handler, ctx)) == LEPT_PARSE_OK) {
+        lept_parse_whitespace(&c);
+        if (c.json != c.end) {
+            ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+        }
+    }
+    assert(c.top == 0);
+    free(c.stack);
+    return ret;
+}
+
+/* 读取器的状态 */
+#define LEPT_READER_VALUE   0   /* 期待一个值 */
+#define LEPT_READER_FIRST   1   /* 刚进入数组或对象：期待第一个值（或键）或结束括号 */
+#define LEPT_READER_KEY     2   /* 期待对象成员的键 */
+#define LEPT_READER_AFTER   3   /* 值之后：期待逗号、结束括号或输入结束 */
+#define LEPT_READER_DONE    4
+#define LEPT_READER_FAILED  5
+
+/**
+ * 读取器与解析上下文互相转换，以便复用解析函数
+ *
+ * @param r
+ * @param c
+ */
+static void lept_reader_load(const lept_reader *r, lept_context *c) {
+    c->json = r->json;
+    c->end = r->end;
+    c->stack = r->stack;
+    c->size = r->size;
+    c->top = r->top;
+    c->insitu = 0;
+    c->flags = 0;
+    c->max_depth = 0;
+    c->doc = NULL;
+}
+
+static void lept_reader_store(lept_reader *r, const lept_context *c) {
+    r->json = c->json;
+    r->stack = c->stack;
+    r->size = c->size;
+    r->top = c->top;
+}
+
+/**
+ * 初始化读取器
+ *
+ * @param r
+ * @param json
+ * @param len
+ */
+void lept_reader_init(lept_reader *r, const char *json, size_t len) {
+    lept_context c;
+    assert(r != NULL && (json != NULL || len == 0));
+    lept_context_init(&c, json, len, 0, NULL);
+    lept_parse_whitespace(&c);
+    lept_reader_store(r, &c);
+    r->end = c.end;
+    r->state = LEPT_READER_VALUE;
+    r->error = LEPT_PARSE_OK;
+    r->span = json;
+    r->len = 0;
+    r->escaped = 0;
+    lept_init(&r->number);
+}
+
+/**
+ * 释放读取器
+ *
+ * @param r
+ */
+void lept_reader_free(lept_reader *r) {
+    assert(r != NULL);
+    free(r->stack);
+    r->stack = NULL;
+    r->size = r->top = 0;
+}
+
+/**
+ * 校验字符串（c->json 指向引号）并记录其内容的区间，不解码
+ *
+ * @param r
+ * @param c
+ * @return
+ */
+static int lept_reader_string(lept_reader *r, lept_context *c) {
+    const char *p = c->json + 1, *q = lept_simd->scan_string(p, c->end);
+    int ret;
+    r->span = p;
+    if (q != c->end && *q == '\"') {
+        /* 不含转义 */
+        r->escaped = 0;
+        r->len = q - p;
+        c->json = q + 1;
+        return LEPT_PARSE_OK;
+    }
+    r->escaped = 1;
+    if ((ret = lept_skip_string(c)) != LEPT_PARSE_OK) {
+        return ret;
+    }
+    r->len = c->json - 1 - p;
+    return LEPT_PARSE_OK;
+}
+
+/**
+ * 读取结束括号（已确认与当前容器相符）
+ *
+ * @param r
+ * @param c
+ * @return
+ */
+static lept_read_token lept_reader_close(lept_reader *r, lept_context *c) {
+    char close = c->stack[--c->top];
+    r->span = c->json++;
+    r->len = 1;
+    r->state = LEPT_READER_AFTER;
+    return close == ']' ? LEPT_READ_END_ARRAY : LEPT_READ_END_OBJECT;
+}
+
+/**
+ * 读取一个值：标量整个读完，数组和对象只读左括号
+ *
+ * @param r
+ * @param c
+ * @param ret
+ * @return
+ */
+static lept_read_token lept_reader_value(lept_reader *r, lept_context *c, int *ret) {
+    const char *start = c->json;
+    lept_read_token tok;
+    lept_value e;
+    if (c->json == c->end) {
+        *ret = LEPT_PARSE_EXPECT_VALUE;
+        return LEPT_READ_ERROR;
+    }
+    switch (lept_token[(unsigned char) *c->json]) {
+        case LEPT_TOKEN_NULL:
+            *ret = lept_parse_literal(c, &e, "null", LEPT_NULL);
+            tok = LEPT_READ_NULL;
+            break;
+        case LEPT_TOKEN_TRUE:
+            *ret = lept_parse_literal(c, &e, "true", LEPT_TRUE);
+            tok = LEPT_READ_TRUE;
+            break;
+        case LEPT_TOKEN_FALSE:
+            *ret = lept_parse_literal(c, &e, "false", LEPT_FALSE);
+            tok = LEPT_READ_FALSE;
+            break;
+        case LEPT_TOKEN_NUMBER:
+            *ret = lept_parse_number(c, &r->number);
+            tok = LEPT_READ_NUMBER;
+            break;
+        case LEPT_TOKEN_STRING:
+            r->state = LEPT_READER_AFTER;
+            *ret = lept_reader_string(r, c);
+            return LEPT_READ_STRING;
+        case LEPT_TOKEN_ARRAY:
+        case LEPT_TOKEN_OBJECT:
+            tok = *c->json == '[' ? LEPT_READ_START_ARRAY : LEPT_READ_START_OBJECT;
+            PUTC(c, *c->json++ == '[' ? ']' : '}');
+            r->span = start;
+            r->len = 1;
+            r->state = LEPT_READER_FIRST;
+            return tok;
+        default:
+            *ret = LEPT_PARSE_INVALID_VALUE;
+            return LEPT_READ_ERROR;
+    }
+    r->span = start;
+    r->len = c->json - start;
+    r->state = LEPT_READER_AFTER;
+    return tok;
+}
+
+/**
+ * 读取下一个记号
+ *
+ * @param r
+ * @return
+ */
+lept_read_token lept_reader_next(lept_reader *r) {
+    lept_context c;
+    lept_read_token tok = LEPT_READ_ERROR;
+    int ret = LEPT_PARSE_OK;
+    char close;
+    assert(r != NULL);
+    if (r->state == LEPT_READER_DONE) {
+        return LEPT_READ_EOF;
+    }
+    if (r->state == LEPT_READER_FAILED) {
+        return LEPT_READ_ERROR;
+    }
+    lept_reader_load(r, &c);
+    for (;;) {
+        switch (r->state) {
+            case LEPT_READER_AFTER:
+                lept_parse_whitespace(&c);
+                if (c.top == 0) {
+                    /* 根值已结束 */
+                    if (c.json != c.end) {
+                        ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+                    } else {
+                        r->state = LEPT_READER_DONE;
+                        tok = LEPT_READ_EOF;
+                    }
+                    break;
+                }
+                close = c.stack[c.top - 1];
+                if (PEEK(&c) == ',') {
+                    c.json++;
+                    lept_parse_whitespace(&c);
+                    r->state = close == '}' ? LEPT_READER_KEY : LEPT_READER_VALUE;
+                    continue;
+                }
+                if (PEEK(&c) != close) {
+                    ret = close == ']' ? LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET
+                                       : LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+                    break;
+                }
+                tok = lept_reader_close(r, &c);
+                break;
+            case LEPT_READER_FIRST:
+                lept_parse_whitespace(&c);
+                close = c.stack[c.top - 1];
+                if (PEEK(&c) == close) {
+                    tok = lept_reader_close(r, &c);
+                    break;
+                }
+                r->state = close == '}' ? LEPT_READER_KEY : LEPT_READER_VALUE;
+                continue;
+            case LEPT_READER_KEY:
+                if (PEEK(&c) != '"') {
+                    ret = LEPT_PARSE_MISS_KEY;
+                    break;
+                }
+                if ((ret = lept_reader_string(r, &c)) != LEPT_PARSE_OK) {
+                    break;
+                }
+                lept_parse_whitespace(&c);
+                if (PEEK(&c) != ':') {
+                    ret = LEPT_PARSE_MISS_COLON;
+                    break;
+                }
+                c.json++;
+                lept_parse_whitespace(&c);
+                r->state = LEPT_READER_VALUE;
+                tok = LEPT_READ_KEY;
+                break;
+            default:
+                tok = lept_reader_value(r, &c, &ret);
+                break;
+        }
+        break;
+    }
+    if (ret != LEPT_PARSE_OK) {
+        r->error = ret;
+        r->state = LEPT_READER_FAILED;
+        tok = LEPT_READ_ERROR;
+    }
+    lept_reader_store(r, &c);
+    return tok;
+}
+
+/**
+ * 跳过一个容器
+ *
+ * @param r
+ * @return
+ */
+int lept_reader_skip(lept_reader *r) {
+    lept_context c;
+    lept_read_token tok;
+    size_t depth;
+    int ret;
+    char close;
+    assert(r != NULL);
+    if (r->state == LEPT_READER_FAILED) {
+        return r->error;
+    }
+    if (r->state == LEPT_READER_FIRST) {
+        /* 刚读到左括号：整个容器交给 lept_skip_container */
+        lept_reader_load(r, &c);
+        lept_parse_whitespace(&c);
+        close = c.stack[--c.top];
+        if (PEEK(&c) == close) {
+            c.json++;
+            ret = LEPT_PARSE_OK;
+        } else {
+            ret = lept_skip_container(&c, close == ']' ? LEPT_ARRAY : LEPT_OBJECT, 1);
+        }
+        lept_reader_store(r, &c);
+        if (ret != LEPT_PARSE_OK) {
+            r->error = ret;
+            r->state = LEPT_READER_FAILED;
+        } else {
+            r->state = LEPT_READER_AFTER;
+        }
+        return ret;
+    }
+    /* 跳过当前所在容器的剩余部分：逐个读取，其中的容器整个跳过，直到当前容器结束 */
+    for (depth = r->top; r->top >= depth && depth > 0; ) {
+        tok = lept_reader_next(r);
+        if (tok == LEPT_READ_ERROR) {
+            return r->error;
+        }
+        if ((tok == LEPT_READ_START_ARRAY || tok == LEPT_READ_START_OBJECT) &&
+            (ret = lept_reader_skip(r)) != LEPT_PARSE_OK) {
+            return ret;
+        }
+    }
+    return LEPT_PARSE_OK;
+}
+
+/**
+ * 错误码
+ *
+ * @param r
+ * @return
+ */
+int lept_reader_error(const lept_reader *r) {
+    assert(r != NULL);
+    return r->error;
+}
+
+/**
+ * 当前记号的源文本
+ *
+ * @param r
+ * @param len
+ * @return
+ */
+const char *lept_reader_get_span(const lept_reader *r, size_t *len) {
+    assert(r != NULL && len != NULL);
+    *len = r->len;
+    return r->span;
+}
+
+/**
+ * 解码当前的字符串或键：源文本已校验，解码不会失败
+ *
+ * @param r
+ * @param len
+ * @return
+ */
+const char *lept_reader_get_string(lept_reader *r, size_t *len) {
+    lept_context c;
+    const char *p, *end;
+    size_t head, n;
+    int ret;
+    char buf[4];
+    assert(r != NULL && len != NULL);
+    if (!r->escaped) {
+        *len = r->len;
+        return r->span;
+    }
+    lept_reader_load(r, &c);
+    head = c.top;
+    for (p = r->span, end = r->span + r->len; p < end; ) {
+        const char *q = (const char *) memchr(p, '\\', end - p);
+        if (q == NULL)
+            q = end;
+        if (q != p)
+            PUTS(&c, p, q - p);
+        if (q == end)
+            break;
+        p = lept_parse_escape(q + 1, end, buf, &n, &ret);
+        assert(p != NULL);
+        PUTS(&c, buf, n);
+    }
+    *len = c.top - head;
+    c.top = head;
+    lept_reader_store(r, &c);
+    return c.stack + head;
+}
+
+/**
+ * 当前 number 的值
+ *
+ * @param r
+ * @return
+ */
+const lept_value *lept_reader_get_number(const lept_reader *r) {
+    assert(r != NULL);
+    return &r->number;
+}
+
+/* 增量解析器的状态 */
+#define LEPT_PARSER_VALUE   0   /* 期待一个值 */
+#define LEPT_PARSER_FIRST   1   /* 刚进入数组或对象：期待第一个值（或键）或结束括号 */
+#define LEPT_PARSER_KEY     2   /* 期待对象成员的键 */
+#define LEPT_PARSER_COLON   3   /* 键之后：期待冒号 */
+#define LEPT_PARSER_AFTER   4   /* 值之后：期待逗号、结束括号或输入结束 */
+#define LEPT_PARSER_STRING  5   /* 字符串（或键）中 */
+#define LEPT_PARSER_ESCAPE  6   /* 字符串中的转义序列中 */
+#define LEPT_PARSER_NUMBER  7   /* 数字中 */
+#define LEPT_PARSER_LITERAL 8   /* 字面值中 */
+#define LEPT_PARSER_DONE    9   /* 根值已交给调用者 */
+
+/* 可能属于数字的字符：数字跨块时先收集到这些字符结束为止，再整体转换 */
+#define LEPT_IS_NUMBER_CHAR(ch) (ISDIGIT(ch) || (ch) == '.' || (ch) == 'e' || (ch) == 'E' || (ch) == '+' || (ch) == '-')
+
+static const char *const lept_literals[] = {"null", "false", "true"};
+
+/**
+ * 初始化增量解析器
+ *
+ * @param p
+ * @param opts
+ */
+void lept_parser_init(lept_parser *p, const lept_parse_options *opts) {
+    assert(p != NULL);
+    p->stack = NULL;
+    p->size = p->top = 0;
+    p->values = NULL;
+    p->vsize = p->vtop = 0;
+    p->frame = LEPT_NO_FRAME;
+    p->max_depth = opts ? opts->max_depth : 0;
+    p->head = 0;
+    p->state = LEPT_PARSER_VALUE;
+    p->error = LEPT_PARSE_OK;
+    p->key = 0;
+    p->literal = LEPT_NULL;
+    p->matched = 0;
+    p->nesc = 0;
+    lept_init(&p->v);
+    LEPT_SIMD_INIT();
+}
+
+/**
+ * 解析器与解析上下文（当前块）及构建 lept_value 的上下文互相转换，以便复用解析和构建函数
+ *
+ * @param p
+ * @param c
+ * @param d
+ * @param chunk
+ * @param len
+ */
+static void lept_parser_load(const lept_parser *p, lept_context *c, lept_dom *d, const char *chunk, size_t len) {
+    c->json = chunk;
+    c->end = chunk + len;
+    c->stack = p->stack;
+    c->size = p->size;
+    c->top = p->top;
+    c->insitu = 0;
+    c->flags = 0;
+    c->max_depth = p->max_depth;
+    c->doc = NULL;
+    d->in = c;
+    d->begin = chunk;
+    d->flags = 0;
+    d->s.stack = p->values;
+    d->s.size = p->vsize;
+    d->s.top = p->vtop;
+    d->frame = p->frame;
+    d->lazy = NULL;
+    lept_intern_init(&d->keys);
+    lept_shapes_init(&d->shapes);
+    d->doc = NULL;
+    memcpy(&d->v, &p->v, sizeof(lept_value));
+}
+
+static void lept_parser_store(lept_parser *p, const lept_context *c, const lept_dom *d) {
+    p->stack = c->stack;
+    p->size = c->size;
+    p->top = c->top;
+    p->values = d->s.stack;
+    p->vsize = d->s.size;
+    p->vtop = d->s.top;
+    p->frame = d->frame;
+    memcpy(&p->v, &d->v, sizeof(lept_value));
+}
+
+/**
+ * 值之后出现了逗号、结束括号和空白以外的字符
+ *
+ * @param c
+ * @return
+ */
+static int lept_parser_unexpected(const lept_context *c) {
+    if (c->top == 0) {
+        return LEPT_PARSE_ROOT_NOT_SINGULAR;
+    }
+    return c->stack[c->top - 1] == ']' ? LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET
+                                        : LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+}
+
+/**
+ * 转义序列（从反斜杠起）需要收集的字节数：不足时可能只是尚未到达，收集到此长度
+ * （或已能确定出错）后再交给 lept_parse_escape，保证与完整输入的结果相同
+ *
+ * @param esc
+ * @param n     已收集的字节数
+ * @return
+ */
+static size_t lept_escape_length(const char *esc, size_t n) {
+    unsigned u = 0;
+    int i;
+    if (n < 2 || esc[1] != 'u') {
+        return 2;
+    }
+    if (n < 6) {
+        return 6;
+    }
+    for (i = 2; i < 6; i++) {
+        unsigned char h = lept_hex_value[(unsigned char) esc[i]];
+        if (h == 0xFF)
+            return 6;
+        u = u << 4 | h;
+    }
+    /* 高代理项之后须紧接 "\u" 及低代理项 */
+    if (u < 0xD800 || u > 0xDBFF || (n > 6 && esc[6] != '\\') || (n > 7 && esc[7] != 'u')) {
+        return n;
+    }
+    return 12;
+}
+
+/**
+ * 字符串（或键）结束：内容在堆栈上 p->head 之后
+ *
+ * @param p
+ * @param c
+ * @param d
+ */
+static void lept_parser_string_done(lept_parser *p, lept_context *c, lept_dom *d) {
+    size_t len = c->top - p->head;
+    /* 空字符串跨块时堆栈可能尚未分配 */
+    const char *s = len > 0 ? (const char *) lept_context_pop(c, len) : "";
+    if (p->key) {
+        lept_dom_key(d, s, len);
+        p->state = LEPT_PARSER_COLON;
+    } else {
+        lept_dom_string(d, s, len);
+        p->state = LEPT_PARSER_AFTER;
+    }
+}
+
+/**
+ * 继续解析字符串：不含转义的部分直接入栈，转义序列跨块时先收集在 p->esc 中
+ *
+ * @param p
+ * @param c
+ * @param d
+ * @return
+ */
+static int lept_parser_string(lept_parser *p, lept_context *c, lept_dom *d) {
+    size_t n;
+    int ret;
+    char buf[4];
+    for (;;) {
+        if (p->state == LEPT_PARSER_ESCAPE) {
+            size_t need;
+            while ((need = lept_escape_length(p->esc, p->nesc)) > p->nesc) {
+                if (c->json == c->end)
+                    return LEPT_PARSE_OK;
+                p->esc[p->nesc++] = *c->json++;
+            }
+            if (!lept_parse_escape(p->esc + 1, p->esc + p->nesc, buf, &n, &ret))
+                return ret;
+            PUTS(c, buf, n);
+            p->state = LEPT_PARSER_STRING;
+        }
+        {
+            const char *q = lept_simd->scan_string(c->json, c->end);
+            if (q != c->json)
+                PUTS(c, c->json, q - c->json);
+            c->json = q;
+        }
+        if (c->json == c->end)
+            return LEPT_PARSE_OK;
+        switch (*c->json++) {
+            case '\"':
+                lept_parser_string_done(p, c, d);
+                return LEPT_PARSE_OK;
+            case '\\':
+                p->esc[0] = '\\';
+                p->nesc = 1;
+                p->state = LEPT_PARSER_ESCAPE;
+                break;
+            default:
+                return LEPT_PARSE_INVALID_STRING_CHAR;
+        }
+    }
+}
+
+/**
+ * 开始解析字符串（c->json 指向引号）：整个位于本块且不含转义时直接使用，不入栈
+ *
+ * @param p
+ * @param c
+ * @param d
+ * @param key
+ * @return
+ */
+static int lept_parser_string_start(lept_parser *p, lept_context *c, lept_dom *d, int key) {
+    const char *s = c->json + 1, *q = lept_simd->scan_string(s, c->end);
+    p->key = key;
+    if (q != c->end && *q == '\"') {
+        c->json = q + 1;
+        if (key) {
+            lept_dom_key(d, s, q - s);
+            p->state = LEPT_PARSER_COLON;
+        } else {
+            lept_dom_string(d, s, q - s);
+            p->state = LEPT_PARSER_AFTER;
+        }
+        return LEPT_PARSE_OK;
+    }
+    p->head = c->top;
+    p->state = LEPT_PARSER_STRING;
+    c->json = s;
+    return lept_parser_string(p, c, d);
+}
+
+/**
+ * 转换已收集的数字（在堆栈上 p->head 之后）
+ *
+ * @param p
+ * @param c
+ * @param d
+ * @return
+ */
+static int lept_parser_number_done(lept_parser *p, lept_context *c, lept_dom *d) {
+    lept_context t;
+    lept_value n;
+    int ret;
+    t.json = c->stack + p->head;
+    t.end = c->stack + c->top;
+    lept_init(&n);
+    if ((ret = lept_parse_number(&t, &n)) != LEPT_PARSE_OK) {
+        return ret;
+    }
+    /* 与完整输入一样，数字之后剩下的字符（如 "0123" 中的 "123"）是多余的 */
+    c->top = p->head;
+    if (t.json != t.end) {
+        return lept_parser_unexpected(c);
+    }
+    lept_dom_number(d, &n);
+    p->state = LEPT_PARSER_AFTER;
+    return LEPT_PARSE_OK;
+}
+
+/**
+ * 继续解析数字：收集到数字字符结束为止
+ *
+ * @param p
+ * @param c
+ * @param d
+ * @return
+ */
+static int lept_parser_number(lept_parser *p, lept_context *c, lept_dom *d) {
+    const char *q = c->json;
+    while (q != c->end && LEPT_IS_NUMBER_CHAR(*q))
+        q++;
+    if (q != c->json)
+        PUTS(c, c->json, q - c->json);
+    c->json = q;
+    if (q == c->end) {
+        return LEPT_PARSE_OK;
+    }
+    return lept_parser_number_done(p, c, d);
+}
+
+/**
+ * 继续匹配字面值
+ *
+ * @param p
+ * @param c
+ * @param d
+ * @return
+ */
+static int lept_parser_literal(lept_parser *p, lept_context *c, lept_dom *d) {
+    const char *literal = lept_literals[p->literal];
+    while (literal[p->matched] != '\0') {
+        if (c->json == c->end)
+            return LEPT_PARSE_OK;
+        if (*c->json++ != literal[p->matched++])
+            return LEPT_PARSE_INVALID_VALUE;
+    }
+    if (p->literal == LEPT_NULL)
+        lept_dom_null(d);
+    else
+        lept_dom_bool(d, p->literal == LEPT_TRUE);
+    p->state = LEPT_PARSER_AFTER;
+    return LEPT_PARSE_OK;
+}
+
+/**
+ * 开始解析一个值（c->json 指向其首字符）
+ *
+ * @param p
+ * @param c
+ * @param d
+ * @return
+ */
+static int lept_parser_value(lept_parser *p, lept_context *c, lept_dom *d) {
+    const char *q;
+    lept_value n;
+    int ret;
+    switch (lept_token[(unsigned char) *c->json]) {
+        case LEPT_TOKEN_NULL:
+        case LEPT_TOKEN_TRUE:
+        case LEPT_TOKEN_FALSE:
+            p->literal = *c->json == 'n' ? LEPT_NULL : *c->json == 't' ? LEPT_TRUE : LEPT_FALSE;
+            p->matched = 0;
+            p->state = LEPT_PARSER_LITERAL;
+            return lept_parser_literal(p, c, d);
+        case LEPT_TOKEN_NUMBER:
+            for (q = c->json; q != c->end && LEPT_IS_NUMBER_CHAR(*q); q++)
+                ;
+            if (q != c->end) {
+                /* 整个位于本块：直接转换，其后多余的字符留给 LEPT_PARSER_AFTER 处理 */
+                lept_init(&n);
+                if ((ret = lept_parse_number(c, &n)) != LEPT_PARSE_OK)
+                    return ret;
+                lept_dom_number(d, &n);
+                p->state = LEPT_PARSER_AFTER;
+                return LEPT_PARSE_OK;
+            }
+            p->head = c->top;
+            p->state = LEPT_PARSER_NUMBER;
+            return lept_parser_number(p, c, d);
+        case LEPT_TOKEN_STRING:
+            return lept_parser_string_start(p, c, d, 0);
+        case LEPT_TOKEN_ARRAY:
+        case LEPT_TOKEN_OBJECT:
+            if (c->max_depth != 0 && c->top >= c->max_depth) {
+                return LEPT_PARSE_DEPTH_EXCEEDED;
+            }
+            if (*c->json++ == '[') {
+                lept_dom_start(d, LEPT_ARRAY);
+                PUTC(c, ']');
+            } else {
+                lept_dom_start(d, LEPT_OBJECT);
+                PUTC(c, '}');
+            }
+            p->state = LEPT_PARSER_FIRST;
+            return LEPT_PARSE_OK;
         default:
-            return lept_parse_number(c, v);
-        case '"':
-            return lept_parse_string(c, v);
-        case '[':
-            return lept_parse_array(c, v);
-        case '{':
-            return lept_parse_object(c, v);
-        case '\0':
+            return LEPT_PARSE_INVALID_VALUE;
+    }
+}
+
+/**
+ * 结束当前的数组或对象（c->json 指向相符的结束括号）
+ *
+ * @param p
+ * @param c
+ * @param d
+ */
+static void lept_parser_close(lept_parser *p, lept_context *c, lept_dom *d) {
+    char close = c->stack[--c->top];
+    c->json++;
+    lept_dom_end(d, close == ']' ? LEPT_ARRAY : LEPT_OBJECT, LEPT_FRAME(&d->s, d->frame)->size);
+    p->state = LEPT_PARSER_AFTER;
+}
+
+/**
+ * 解析一块输入，在块末尾（可能在记号中间）暂停
+ *
+ * @param p
+ * @param c
+ * @param d
+ * @return
+ */
+static int lept_parser_run(lept_parser *p, lept_context *c, lept_dom *d) {
+    int ret = LEPT_PARSE_OK;
+    char close;
+    while (ret == LEPT_PARSE_OK) {
+        switch (p->state) {
+            case LEPT_PARSER_STRING:
+            case LEPT_PARSER_ESCAPE:
+                ret = lept_parser_string(p, c, d);
+                break;
+            case LEPT_PARSER_NUMBER:
+                ret = lept_parser_number(p, c, d);
+                break;
+            case LEPT_PARSER_LITERAL:
+                ret = lept_parser_literal(p, c, d);
+                break;
+            default:
+                /* 记号之间：先跳过空白 */
+                lept_parse_whitespace(c);
+                if (c->json == c->end) {
+                    return LEPT_PARSE_OK;
+                }
+                switch (p->state) {
+                    case LEPT_PARSER_VALUE:
+                        ret = lept_parser_value(p, c, d);
+                        break;
+                    case LEPT_PARSER_FIRST:
+                        close = c->stack[c->top - 1];
+                        if (*c->json == close) {
+                            lept_parser_close(p, c, d);
+                        } else {
+                            p->state = close == '}' ? LEPT_PARSER_KEY : LEPT_PARSER_VALUE;
+                        }
+                        break;
+                    case LEPT_PARSER_KEY:
+                        ret = *c->json == '"' ? lept_parser_string_start(p, c, d, 1) : LEPT_PARSE_MISS_KEY;
+                        break;
+                    case LEPT_PARSER_COLON:
+                        if (*c->json != ':') {
+                            ret = LEPT_PARSE_MISS_COLON;
+                            break;
+                        }
+                        c->json++;
+                        p->state = LEPT_PARSER_VALUE;
+                        break;
+                    default:
+                        assert(p->state == LEPT_PARSER_AFTER);
+                        if (c->top == 0) {
+                            ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+                        } else if (*c->json == ',') {
+                            c->json++;
+                            p->state = c->stack[c->top - 1] == '}' ? LEPT_PARSER_KEY : LEPT_PARSER_VALUE;
+                        } else if (*c->json == c->stack[c->top - 1]) {
+                            lept_parser_close(p, c, d);
+                        } else {
+                            ret = lept_parser_unexpected(c);
+                        }
+                        break;
+                }
+                break;
+        }
+        if (c->json == c->end) {
+            break;
+        }
+    }
+    return ret;
+}
+
+/**
+ * 输入结束：按当前状态得出与完整输入相同的结果
+ *
+ * @param p
+ * @param c
+ * @param d
+ * @return
+ */
+static int lept_parser_end(lept_parser *p, lept_context *c, lept_dom *d) {
+    size_t n;
+    int ret;
+    char buf[4];
+    switch (p->state) {
+        case LEPT_PARSER_VALUE:
             return LEPT_PARSE_EXPECT_VALUE;
+        case LEPT_PARSER_FIRST:
+            return c->stack[c->top - 1] == ']' ? LEPT_PARSE_EXPECT_VALUE : LEPT_PARSE_MISS_KEY;
+        case LEPT_PARSER_KEY:
+            return LEPT_PARSE_MISS_KEY;
+        case LEPT_PARSER_COLON:
+            return LEPT_PARSE_MISS_COLON;
+        case LEPT_PARSER_ESCAPE:
+            if (!lept_parse_escape(p->esc + 1, p->esc + p->nesc, buf, &n, &ret))
+                return ret;
+            return LEPT_PARSE_MISS_QUOTATION_MARK;
+        case LEPT_PARSER_STRING:
+            return LEPT_PARSE_MISS_QUOTATION_MARK;
+        case LEPT_PARSER_LITERAL:
+            return LEPT_PARSE_INVALID_VALUE;
+        case LEPT_PARSER_NUMBER:
+            if ((ret = lept_parser_number_done(p, c, d)) != LEPT_PARSE_OK)
+                return ret;
+            /* fall through */
+        default:
+            return c->top == 0 ? LEPT_PARSE_OK : lept_parser_unexpected(c);
+    }
+}
+
+/**
+ * 出错：释放已构建的部分
+ *
+ * @param p
+ * @param d
+ * @param ret
+ */
+static void lept_parser_fail(lept_parser *p, lept_dom *d, int ret) {
+    lept_parse_unwind(&d->s, d->frame);
+    d->frame = LEPT_NO_FRAME;
+    /* 根值只在完成后才设置 */
+    lept_free(&d->v);
+    p->error = ret;
+}
 
+/**
+ * 输入一块
+ *
+ * @param p
+ * @param chunk
+ * @param len
+ * @return
+ */
+int lept_parser_feed(lept_parser *p, const char *chunk, size_t len) {
+    lept_context c;
+    lept_dom d;
+    int ret;
+    assert(p != NULL && (chunk != NULL || len == 0) && p->state != LEPT_PARSER_DONE);
+    if (p->error != LEPT_PARSE_OK || len == 0) {
+        return p->error;
     }
+    lept_parser_load(p, &c, &d, chunk, len);
+    if ((ret = lept_parser_run(p, &c, &d)) != LEPT_PARSE_OK) {
+        lept_parser_fail(p, &d, ret);
+    }
+    lept_parser_store(p, &c, &d);
+    return ret;
 }
 
 /**
- * 解析 JSON
+ * 输入结束，取出结果并释放解析器的内存
+ *
+ * @param p
+ * @param v
+ * @return
+ */
+int lept_parser_finish(lept_parser *p, lept_value *v) {
+    lept_context c;
+    lept_dom d;
+    int ret;
+    assert(p != NULL && v != NULL && p->state != LEPT_PARSER_DONE);
+    lept_init(v);
+    if ((ret = p->error) == LEPT_PARSE_OK) {
+        lept_parser_load(p, &c, &d, "", 0);
+        if ((ret = lept_parser_end(p, &c, &d)) == LEPT_PARSE_OK) {
+            assert(d.frame == LEPT_NO_FRAME && d.s.top == 0);
+            memcpy(v, &d.v, sizeof(lept_value));
+            lept_init(&d.v);
+            p->state = LEPT_PARSER_DONE;
+        } else {
+            lept_parser_fail(p, &d, ret);
+        }
+        lept_parser_store(p, &c, &d);
+    }
+    lept_parser_free(p);
+    return ret;
+}
+
+/**
+ * 释放解析器的内存（包括尚未取出的部分结果）
+ *
+ * @param p
+ */
+void lept_parser_free(lept_parser *p) {
+    assert(p != NULL);
+    if (p->error == LEPT_PARSE_OK && p->state != LEPT_PARSER_DONE) {
+        lept_context c;
+        lept_dom d;
+        lept_parser_load(p, &c, &d, "", 0);
+        lept_parser_fail(p, &d, LEPT_PARSE_EXPECT_VALUE);
+        lept_parser_store(p, &c, &d);
+    }
+    free(p->stack);
+    free(p->values);
+    p->stack = p->values = NULL;
+    p->size = p->top = p->vsize = p->vtop = 0;
+    p->state = LEPT_PARSER_DONE;
+}
+
+/**
+ * 在 n 个线程（包括调用线程）中分别执行 fn(arg + i * stride)，全部完成后返回。
+ * 没有线程支持或创建线程失败时，未能在新线程中执行的部分在调用线程中依次执行
+ *
+ * @param fn
+ * @param arg
+ * @param stride
+ * @param n
+ */
+static void lept_run_threads(void *(*fn)(void *), void *arg, size_t stride, size_t n) {
+    size_t i, started = 0;
+#ifdef LEPT_THREADS
+    pthread_t *threads = n > 1 ? (pthread_t *) malloc((n - 1) * sizeof(pthread_t)) : NULL;
+    for (; started + 1 < n; started++) {
+        if (pthread_create(&threads[started], NULL, fn, (char *) arg + (started + 1) * stride) != 0)
+            break;
+    }
+#endif
+    fn(arg);
+    for (i = started + 1; i < n; i++) {
+        fn((char *) arg + i * stride);
+    }
+#ifdef LEPT_THREADS
+    for (i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+#endif
+}
+
+/**
+ * CPU 核数，未知时为 1
+ *
+ * @return
+ */
+static size_t lept_cpu_count(void) {
+#ifdef LEPT_THREADS
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    return ncpu > 0 ? (size_t) ncpu : 1;
+#else
+    return 1;
+#endif
+}
+
+/* 每块至少这么多字节，避免块过小时加锁和分派的开销占比过高 */
+#ifndef LEPT_NDJSON_MIN_CHUNK
+#define LEPT_NDJSON_MIN_CHUNK (16 * 1024)
+#endif
+
+/* NDJSON 的一条记录的解析结果 */
+typedef struct {
+    size_t offset;
+    int error;
+    lept_value v;
+} lept_ndjson_record;
+
+/* 一块（若干整行）的解析结果，按顺序交付时暂存 */
+typedef struct {
+    lept_ndjson_record *records;
+    size_t size;
+    int ready;
+} lept_ndjson_chunk;
+
+/* 各线程共享的状态，除 json、len 等只读成员外都须持有 lock 访问 */
+typedef struct {
+    const char *json;
+    size_t len, pos, chunk_size;
+    const lept_parse_options *opts;
+    lept_ndjson_callback callback;
+    void *ctx;
+    int unordered, aborted;
+    lept_ndjson_chunk *chunks;  /* 按块号 */
+    size_t nchunks, capacity, next;
+    int delivering;             /* 已有线程在交付 chunks[next] 起已完成的块 */
+#ifdef LEPT_THREADS
+    pthread_mutex_t lock;
+#endif
+} lept_ndjson;
+
+#ifdef LEPT_THREADS
+#define LEPT_NDJSON_LOCK(n) pthread_mutex_lock(&(n)->lock)
+#define LEPT_NDJSON_UNLOCK(n) pthread_mutex_unlock(&(n)->lock)
+#else
+#define LEPT_NDJSON_LOCK(n) ((void) 0)
+#define LEPT_NDJSON_UNLOCK(n) ((void) 0)
+#endif
+
+/**
+ * 解析一条记录，c 和 s 的堆栈在同一线程的各条记录间重用
  *
+ * @param c
+ * @param s
  * @param v
+ * @param t     本块的键表和形状表
  * @param json
+ * @param len
+ * @return 记录只有空白时返回 -1
+ */
+static int lept_ndjson_parse(lept_context *c, lept_context *s, lept_dom_tables *t, lept_value *v, const char *json, size_t len) {
+    int ret;
+    c->json = json;
+    c->end = json + len;
+    c->top = 0;
+    lept_init(v);
+    lept_parse_whitespace(c);
+    if (c->json == c->end) {
+        return -1;
+    }
+    if ((ret = lept_parse_value_stack(c, s, v, t)) == LEPT_PARSE_OK) {
+        lept_parse_whitespace(c);
+        if (c->json != c->end) {
+            lept_free(v);
+            ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+        }
+    }
+    return ret;
+}
+
+/**
+ * 按块号顺序交付已完成的块（调用时持有 lock）。同一时间只有一个线程交付，
+ * 其他线程完成的块由它在循环中接着交付
+ *
+ * @param n
+ */
+static void lept_ndjson_deliver(lept_ndjson *n) {
+    if (n->delivering) {
+        return;
+    }
+    n->delivering = 1;
+    while (n->next < n->nchunks && n->chunks[n->next].ready) {
+        lept_ndjson_chunk chunk = n->chunks[n->next];
+        int aborted = n->aborted;
+        size_t i;
+        LEPT_NDJSON_UNLOCK(n);
+        for (i = 0; i < chunk.size; i++) {
+            lept_ndjson_record *r = &chunk.records[i];
+            if (!aborted)
+                aborted = n->callback(n->ctx, r->offset, r->error, &r->v) != 0;
+            lept_free(&r->v);
+        }
+        free(chunk.records);
+        LEPT_NDJSON_LOCK(n);
+        n->next++;
+        n->aborted |= aborted;
+    }
+    n->delivering = 0;
+}
+
+/**
+ * 工作线程：逐块领取并解析，直到输入结束或被中止
+ *
+ * @param arg
  * @return
  */
-int lept_parse(lept_value *v, const char *json) {
-    assert(v != NULL);
+static void *lept_ndjson_worker(void *arg) {
+    lept_ndjson *n = (lept_ndjson *) arg;
+    lept_context c, s;
+    lept_dom_tables t;
+    lept_context_init(&c, "", 0, 0, n->opts);
+    s.stack = NULL;
+    s.size = s.top = 0;
+    for (;;) {
+        lept_ndjson_record *records = NULL;
+        size_t size = 0, capacity = 0, id = 0, start, end;
+        const char *p, *q;
+        int aborted = 0;
+
+        /* 领取一块：从 pos 起约 chunk_size 字节，延伸到行尾 */
+        LEPT_NDJSON_LOCK(n);
+        if (n->aborted || n->pos == n->len) {
+            LEPT_NDJSON_UNLOCK(n);
+            break;
+        }
+        start = n->pos;
+        if (n->len - start <= n->chunk_size) {
+            end = n->len;
+        } else {
+            q = (const char *) memchr(n->json + start + n->chunk_size, '\n', n->len - start - n->chunk_size);
+            end = q ? (size_t) (q - n->json) + 1 : n->len;
+        }
+        n->pos = end;
+        if (!n->unordered) {
+            if (n->nchunks == n->capacity) {
+                n->capacity = n->capacity ? n->capacity + (n->capacity >> 1) : 16;
+                n->chunks = (lept_ndjson_chunk *) realloc(n->chunks, n->capacity * sizeof(lept_ndjson_chunk));
+            }
+            id = n->nchunks++;
+            n->chunks[id].ready = 0;
+        }
+        LEPT_NDJSON_UNLOCK(n);
+
+        /* 逐行解析：JSON 文本中的换行只能是空白，因此按 '\n' 切分总是正确的 */
+        lept_dom_tables_init(&t);
+        for (p = n->json + start; p < n->json + end && !aborted; p = q + 1) {
+            lept_value v;
+            int ret;
+            if (!(q = (const char *) memchr(p, '\n', n->json + end - p)))
+                q = n->json + end;
+            if ((ret = lept_ndjson_parse(&c, &s, &t, &v, p, q - p)) < 0)
+                continue;
+            if (n->unordered) {
+                /* 不保证顺序时直接交付，回调可能在多个线程中同时执行 */
+                aborted = n->callback(n->ctx, p - n->json, ret, &v) != 0;
+                lept_free(&v);
+                continue;
+            }
+            if (size == capacity) {
+                capacity = capacity ? capacity + (capacity >> 1) : 64;
+                records = (lept_ndjson_record *) realloc(records, capacity * sizeof(lept_ndjson_record));
+            }
+            records[size].offset = p - n->json;
+            records[size].error = ret;
+            memcpy(&records[size++].v, &v, sizeof(lept_value));
+        }
+        /* 块完成前释放表的引用，此后共享的键和形状只由本块的记录持有，交付它们的线程可以安全释放 */
+        lept_dom_tables_free(&t);
+
+        LEPT_NDJSON_LOCK(n);
+        n->aborted |= aborted;
+        if (!n->unordered) {
+            n->chunks[id].records = records;
+            n->chunks[id].size = size;
+            n->chunks[id].ready = 1;
+            lept_ndjson_deliver(n);
+        }
+        LEPT_NDJSON_UNLOCK(n);
+    }
+    free(c.stack);
+    free(s.stack);
+    return NULL;
+}
+
+/**
+ * 并行解析 NDJSON（JSON Lines）
+ *
+ * @param json
+ * @param len
+ * @param nthreads
+ * @param opts
+ * @param callback
+ * @param ctx
+ * @return
+ */
+int lept_parse_ndjson(const char *json, size_t len, size_t nthreads, const lept_parse_options *opts,
+                      lept_ndjson_callback callback, void *ctx) {
+    lept_ndjson n;
+    assert((json != NULL || len == 0) && callback != NULL);
+    LEPT_SIMD_INIT();
+    if (nthreads == 0) {
+        nthreads = lept_cpu_count();
+    }
+    n.json = json;
+    n.len = len;
+    n.pos = 0;
+    /* 每个线程分到若干块，以平衡各行长度不均造成的负载差异 */
+    n.chunk_size = len / (nthreads * 8);
+    if (n.chunk_size < LEPT_NDJSON_MIN_CHUNK)
+        n.chunk_size = LEPT_NDJSON_MIN_CHUNK;
+    if (nthreads > len / n.chunk_size + 1)
+        nthreads = len / n.chunk_size + 1;
+    n.opts = opts;
+    n.callback = callback;
+    n.ctx = ctx;
+    n.unordered = opts && (opts->flags & LEPT_PARSE_OPT_UNORDERED);
+    n.aborted = 0;
+    n.chunks = NULL;
+    n.nchunks = n.capacity = n.next = 0;
+    n.delivering = 0;
+#ifdef LEPT_THREADS
+    pthread_mutex_init(&n.lock, NULL);
+#endif
+    /* 各线程共享 n，从同一处领取块；调用线程也参与解析 */
+    lept_run_threads(lept_ndjson_worker, &n, 0, nthreads);
+#ifdef LEPT_THREADS
+    pthread_mutex_destroy(&n.lock);
+#endif
+    /* 所有领取的块都已完成，最后完成的线程已交付（或在中止后释放）全部结果 */
+    assert(n.next == n.nchunks);
+    free(n.chunks);
+    return n.aborted ? LEPT_PARSE_ABORTED : LEPT_PARSE_OK;
+}
+
+/**
+ * 展开延迟解析的数组或对象（一层，其中的容器仍延迟）。源文本已在解析时校验，展开不会失败。
+ * 访问函数的参数为 const，展开只改变内部表示，不改变值
+ *
+ * @param v
+ */
+static void lept_expand(lept_value *v) {
+    lept_parse_options opts = {0, 0, 0};
+    lept_context c;
+    lept_value e;
+    int ret;
+    assert(v->flags & LEPT_FLAG_LAZY);
+    opts.flags = v->u.l.flags;
+    lept_context_init(&c, v->u.l.json, v->u.l.len, 0, &opts);
+    ret = lept_parse_value(&c, &e);
+    assert(ret == LEPT_PARSE_OK && c.json == c.end && c.top == 0);
+    (void) ret;
+    free(c.stack);
+    memcpy(v, &e, sizeof(lept_value));
+}
+
+/* 访问数组或对象的内容之前调用 */
+#define LEPT_EXPAND(v) do { if ((v)->flags & LEPT_FLAG_LAZY) lept_expand((lept_value *) (v)); } while(0)
+
+/**
+ * 两阶段解析的结构索引：按顺序记录每个结构字符（{}[]:,）、字符串起始引号及
+ * 其他标量（数字、字面值）首字符在输入中的偏移
+ */
+typedef struct {
+    uint32_t *pos;
+    size_t n, capacity;
+} lept_index;
+
+/**
+ * 前缀异或：结果第 i 位为 x 第 0..i 位的异或，用于从引号位置得到字符串区间
+ *
+ * @param x
+ * @return
+ */
+static uint64_t lept_prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+/**
+ * 第一阶段：以 64 字节为一块向量化分类，再用位运算排除字符串内部的字符，得到结构索引
+ * 不做语法检查，不合法的输入由第二阶段发现
+ *
+ * @param json
+ * @param len
+ * @param ix
+ */
+static void lept_build_index(const char *json, size_t len, lept_index *ix) {
+    /* 上一块末尾的状态：最后一个字符是否被转义、是否在字符串内、是否为标量字符 */
+    uint64_t prev_escaped = 0, prev_in_string = 0, prev_scalar = 0;
+    size_t base;
+    ix->n = 0;
+    ix->capacity = len / 8 + 64;
+    ix->pos = (uint32_t *) malloc(ix->capacity * sizeof(uint32_t));
+    for (base = 0; base < len; base += 64) {
+        lept_block_masks m;
+        uint64_t escaped, bits, quote, in_string, scalar, structural;
+        if (len - base >= 64) {
+            lept_simd->classify(json + base, &m);
+        } else {
+            /* 最后不足 64 字节的块用空白补齐 */
+            char block[64];
+            memset(block, ' ', sizeof(block));
+            memcpy(block, json + base, len - base);
+            lept_simd->classify(block, &m);
+        }
+
+        /* 被转义的字符：逐个处理未被转义的反斜杠（通常很少），它转义紧随其后的字符 */
+        escaped = prev_escaped;
+        bits = m.backslash & ~prev_escaped;
+        prev_escaped = 0;
+        while (bits) {
+            int i = __builtin_ctzll(bits);
+            if (i == 63) {
+                prev_escaped = 1;
+                break;
+            }
+            escaped |= (uint64_t) 1 << (i + 1);
+            bits &= ~((uint64_t) 3 << i);
+        }
+
+        /* 字符串区间：包含起始引号，不包含结尾引号 */
+        quote = m.quote & ~escaped;
+        in_string = lept_prefix_xor(quote) ^ prev_in_string;
+        prev_in_string = (uint64_t) 0 - (in_string >> 63);
+
+        /* 标量首字符：不是空白、结构字符或引号，且前一个字符不是标量字符 */
+        scalar = ~(m.op | m.ws | quote);
+        structural = scalar & ~((scalar << 1) | prev_scalar);
+        prev_scalar = scalar >> 63;
+        structural = ((structural | m.op) & ~in_string) | (quote & in_string);
+        if (len - base < 64) {
+            structural &= ((uint64_t) 1 << (len - base)) - 1;
+        }
+
+        if (ix->capacity - ix->n < 64) {
+            ix->capacity += ix->capacity >> 1;
+            ix->pos = (uint32_t *) realloc(ix->pos, ix->capacity * sizeof(uint32_t));
+        }
+        while (structural) {
+            ix->pos[ix->n++] = (uint32_t) (base + __builtin_ctzll(structural));
+            structural &= structural - 1;
+        }
+    }
+}
+
+/* 第二阶段出错时返回，交由 lept_parse_n 重新解析以得到与其完全一致的错误码 */
+#define LEPT_INDEX_FAIL (-1)
+
+/* 第二阶段递归构建的最大嵌套层数，更深的输入交由不递归的 lept_parse_n 解析 */
+#define LEPT_INDEX_MAX_DEPTH 1024
+
+/**
+ * 第二阶段：按索引逐个取出记号构建 lept_value，标量仍由原有的扫描函数解析
+ *
+ * @param c     c->json 固定指向输入开头，索引中的偏移均相对于它
+ * @param ix
+ * @param i     当前记号在索引中的位置
+ * @param v
+ * @param depth 外层数组和对象的个数
+ * @return
+ */
+static int lept_parse_indexed_value(lept_context *c, const lept_index *ix, size_t *i, lept_value *v, size_t depth) {
+    const char *base = c->json;
+    const char *p;
+    size_t size = 0, k;
+    int ret, borrowed;
+    if (*i >= ix->n || depth >= LEPT_INDEX_MAX_DEPTH) {
+        return LEPT_INDEX_FAIL;
+    }
+    p = base + ix->pos[(*i)++];
+    switch (*p) {
+        case '[':
+            if (*i < ix->n && base[ix->pos[*i]] == ']') {
+                (*i)++;
+                lept_set_array(v, 0);
+                return LEPT_PARSE_OK;
+            }
+            for (;;) {
+                lept_value e;
+                lept_init(&e);
+                if ((ret = lept_parse_indexed_value(c, ix, i, &e, depth + 1)) != LEPT_PARSE_OK) {
+                    break;
+                }
+                memcpy(lept_context_push(c, sizeof(lept_value)), &e, sizeof(lept_value));
+                size++;
+                ret = LEPT_INDEX_FAIL;
+                if (*i >= ix->n) {
+                    break;
+                }
+                p = base + ix->pos[(*i)++];
+                if (*p == ']') {
+                    v->type = LEPT_ARRAY;
+                    v->u.a.size = v->u.a.capacity = size;
+                    size *= sizeof(lept_value);
+                    memcpy(v->u.a.e = (lept_value *) malloc(size), lept_context_pop(c, size), size);
+                    return LEPT_PARSE_OK;
+                } else if (*p != ',') {
+                    break;
+                }
+            }
+            for (k = 0; k < size; k++) {
+                lept_free((lept_value *) lept_context_pop(c, sizeof(lept_value)));
+            }
+            return ret;
+        case '{':
+            if (*i < ix->n && base[ix->pos[*i]] == '}') {
+                (*i)++;
+                lept_set_object(v, 0);
+                return LEPT_PARSE_OK;
+            }
+            for (;;) {
+                lept_member m;
+                char *str;
+                const char *save = c->json;
+                ret = LEPT_INDEX_FAIL;
+                if (*i + 1 >= ix->n || base[ix->pos[*i]] != '"' || base[ix->pos[*i + 1]] != ':') {
+                    break;
+                }
+                /* 键：字符串结尾之后到冒号之间只能是空白 */
+                c->json = base + ix->pos[*i];
+                ret = lept_parse_string_raw(c, &str, &m.klen, &borrowed);
+                if (ret == LEPT_PARSE_OK) {
+                    lept_parse_whitespace(c);
+                    if (c->json != base + ix->pos[*i + 1])
+                        ret = LEPT_INDEX_FAIL;
+                }
+                c->json = save;
+                if (ret != LEPT_PARSE_OK) {
+                    break;
+                }
+                *i += 2;
+                m.k = (char *) malloc(m.klen + 1);
+                /* 空键时 str 可能为 NULL（栈上没有弹出任何字节） */
+                if (m.klen)
+                    memcpy(m.k, str, m.klen);
+                m.k[m.klen] = '\0';
+                m.kflags = 0;
+                lept_init(&m.v);
+                if ((ret = lept_parse_indexed_value(c, ix, i, &m.v, depth + 1)) != LEPT_PARSE_OK) {
+                    free(m.k);
+                    break;
+                }
+                memcpy(lept_context_push(c, sizeof(lept_member)), &m, sizeof(lept_member));
+                size++;
+                ret = LEPT_INDEX_FAIL;
+                if (*i >= ix->n) {
+                    break;
+                }
+                p = base + ix->pos[(*i)++];
+                if (*p == '}') {
+                    lept_set_object(v, size);
+                    memcpy(v->u.o.m, lept_context_pop(c, sizeof(lept_member) * size), sizeof(lept_member) * size);
+                    v->u.o.size = size;
+                    return LEPT_PARSE_OK;
+                } else if (*p != ',') {
+                    break;
+                }
+            }
+            for (k = 0; k < size; k++) {
+                lept_member *m = (lept_member *) lept_context_pop(c, sizeof(lept_member));
+                free(m->k);
+                lept_free(&m->v);
+            }
+            return ret;
+        case ']':
+        case '}':
+        case ':':
+        case ',':
+            return LEPT_INDEX_FAIL;
+        default: {
+            /* 标量：用原有的扫描函数解析，且其后到下一个记号之间只能是空白 */
+            const char *save = c->json;
+            c->json = p;
+            ret = lept_parse_value(c, v);
+            if (ret == LEPT_PARSE_OK) {
+                lept_parse_whitespace(c);
+                if (c->json != (*i < ix->n ? base + ix->pos[*i] : c->end)) {
+                    lept_free(v);
+                    ret = LEPT_INDEX_FAIL;
+                }
+            }
+            c->json = save;
+            return ret;
+        }
+    }
+}
 
+/**
+ * 两阶段解析：先向量化建立结构索引，再按索引构建 lept_value
+ * 结果与 lept_parse_n 完全一致；出错时回退到 lept_parse_n 以得到相同的错误码
+ *
+ * @param v
+ * @param json
+ * @param len
+ * @return
+ */
+int lept_parse_indexed(lept_value *v, const char *json, size_t len) {
     lept_context c;
+    lept_index ix;
+    size_t i = 0;
     int ret;
+    assert(v != NULL && (json != NULL || len == 0));
+    /* 偏移用 32 位保存 */
+    if (len > UINT32_MAX) {
+        return lept_parse_n(v, json, len);
+    }
+    LEPT_SIMD_INIT();
     c.json = json;
+    c.end = json + len;
     c.stack = NULL;
     c.size = c.top = 0;
+    c.insitu = 0;
+    c.flags = 0;
+    c.max_depth = 0;
+    c.doc = NULL;
     lept_init(v);
+    lept_build_index(json, len, &ix);
+    ret = lept_parse_indexed_value(&c, &ix, &i, v, 0);
+    if (ret == LEPT_PARSE_OK && i != ix.n) {
+        lept_free(v);
+        ret = LEPT_INDEX_FAIL;
+    }
+    assert(c.top == 0);
+    free(c.stack);
+    free(ix.pos);
+    if (ret != LEPT_PARSE_OK) {
+        return lept_parse_n(v, json, len);
+    }
+    return ret;
+}
 
-    /* 去除空白、换行符、制表符 */
-    lept_parse_whitespace(&c);
+/* 并行构建时每个线程至少分到的字节数，更小的输入串行解析 */
+#ifndef LEPT_PARALLEL_MIN_PART
+#define LEPT_PARALLEL_MIN_PART (64 * 1024)
+#endif
+
+/* 并行构建根数组时一个线程的工作：解析第 begin 到 end - 1 个元素 */
+typedef struct {
+    const char *json;
+    const uint32_t *sep;        /* 根数组的左括号、第一层的逗号及右括号的偏移 */
+    size_t begin, end;
+    lept_value *e;              /* 结果数组，各线程写各自的区间 */
+    const lept_parse_options *opts;
+    int ret;
+} lept_parallel_part;
+
+/**
+ * 解析一段元素：每个元素是两个相邻分隔符之间的全部文本（除空白外）
+ *
+ * @param arg
+ * @return
+ */
+static void *lept_parallel_worker(void *arg) {
+    lept_parallel_part *part = (lept_parallel_part *) arg;
+    lept_context c, s;
+    lept_dom_tables t;
+    size_t i;
+    lept_context_init(&c, part->json, 0, 0, part->opts);
+    /* 元素在根数组之内，少一层 */
+    c.max_depth = c.max_depth ? c.max_depth - 1 : 0;
+    s.stack = NULL;
+    s.size = s.top = 0;
+    lept_dom_tables_init(&t);
+    part->ret = LEPT_PARSE_OK;
+    for (i = part->begin; i < part->end; i++) {
+        c.json = part->json + part->sep[i] + 1;
+        c.end = part->json + part->sep[i + 1];
+        c.top = 0;
+        lept_parse_whitespace(&c);
+        if ((part->ret = lept_parse_value_stack(&c, &s, &part->e[i], &t)) != LEPT_PARSE_OK)
+            break;
+        lept_parse_whitespace(&c);
+        if (c.json != c.end) {
+            /* 如 "[1 2]"：交由串行解析得到错误码 */
+            lept_free(&part->e[i]);
+            part->ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+            break;
+        }
+    }
+    /* 出错时释放本段已完成的元素 */
+    if (part->ret != LEPT_PARSE_OK) {
+        while (i-- > part->begin)
+            lept_free(&part->e[i]);
+    }
+    lept_dom_tables_free(&t);
+    free(c.stack);
+    free(s.stack);
+    return NULL;
+}
+
+/**
+ * 并行构建根数组：先用结构索引找出第一层的逗号，把元素按字节数大致均分给各线程解析，
+ * 结果直接写入同一个元素数组。不是数组、输入太小或有任何错误时交由串行解析，
+ * 因此结果和错误码与串行解析完全一致
+ *
+ * @param v
+ * @param json
+ * @param len
+ * @param opts
+ * @return
+ */
+static int lept_parse_parallel(lept_value *v, const char *json, size_t len, const lept_parse_options *opts) {
+    lept_parallel_part *parts;
+    lept_index ix;
+    size_t i, n, count, depth = 0, nparts = opts->nthreads, begin;
+    const char *p = json;
+    int ret = LEPT_PARSE_OK;
+    assert(v != NULL && (json != NULL || len == 0));
+    while (p < json + len && ISWS(*p))
+        p++;
+    /* 延迟解析只构建根值一层，不需要并行 */
+    if (len > UINT32_MAX || p == json + len || *p != '[' || len / nparts < LEPT_PARALLEL_MIN_PART ||
+        opts->max_depth == 1 || (opts->flags & LEPT_PARSE_OPT_LAZY)) {
+        return lept_parse_root(v, json, len, 1, 0, opts, NULL, NULL, NULL);
+    }
+    LEPT_SIMD_INIT();
+    lept_init(v);
+
+    /* 在索引中原地留下分隔符：根数组的左括号、第一层的逗号及右括号 */
+    lept_build_index(json, len, &ix);
+    for (i = n = 0; i < ix.n; i++) {
+        char ch = json[ix.pos[i]];
+        if (ch == '[' || ch == '{') {
+            if (depth++ == 0)
+                ix.pos[n++] = ix.pos[i];
+        } else if (ch == ']' || ch == '}') {
+            if (--depth == 0) {
+                ix.pos[n++] = ix.pos[i];
+                break;
+            }
+        } else if (ch == ',' && depth == 1) {
+            ix.pos[n++] = ix.pos[i];
+        }
+    }
+    /* 括号不配对、根值之后还有内容或是空数组 */
+    if (depth != 0 || i + 1 != ix.n || json[ix.pos[n - 1]] != ']' || n < 3) {
+        free(ix.pos);
+        return lept_parse_root(v, json, len, 1, 0, opts, NULL, NULL, NULL);
+    }
+    count = n - 1;
+    lept_set_array(v, count);
+
+    /* 按字节数均分：第 k 段从偏移超过 k * len / nparts 的第一个元素开始 */
+    if (nparts > count)
+        nparts = count;
+    parts = (lept_parallel_part *) malloc(nparts * sizeof(lept_parallel_part));
+    for (i = 0, begin = 0; i < nparts; i++) {
+        size_t end = begin;
+        if (i + 1 == nparts) {
+            end = count;
+        } else {
+            while (end < count && ix.pos[end] < (len / nparts) * (i + 1))
+                end++;
+            if (end == begin && end < count)
+                end++;
+        }
+        parts[i].json = json;
+        parts[i].sep = ix.pos;
+        parts[i].begin = begin;
+        parts[i].end = end;
+        parts[i].e = v->u.a.e;
+        parts[i].opts = opts;
+        begin = end;
+    }
+    lept_run_threads(lept_parallel_worker, parts, sizeof(lept_parallel_part), nparts);
 
-    /**
-     * 解析结果并判断结果
-     * JSON 文本应该有 3 部分：JSON-text = ws value ws；
-     * 以下判断第三部分，即解析空白然后检查 JSON 文本是否完结
-     */
-    if ((ret = lept_parse_value(&c, v)) == LEPT_PARSE_OK) {
-        /* 解析成功后，再跳过后面的空白，判断是否已到末尾 */
-        lept_parse_whitespace(&c);
-        if (*c.json != '\0') {
-            v->type = LEPT_NULL;
-            ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+    for (i = 0; i < nparts; i++) {
+        if (parts[i].ret != LEPT_PARSE_OK)
+            ret = parts[i].ret;
+    }
+    if (ret == LEPT_PARSE_OK) {
+        v->u.a.size = count;
+    } else {
+        /* 已完成的段逐个释放，出错的段已自行释放 */
+        for (i = 0; i < nparts; i++) {
+            if (parts[i].ret == LEPT_PARSE_OK)
+                for (n = parts[i].begin; n < parts[i].end; n++)
+                    lept_free(&v->u.a.e[n]);
         }
+        lept_free(v);
     }
-    /* 最后确保所有数据从缓冲区弹出 */
-    assert(c.top == 0);
-    free(c.stack);
-    return ret;
+    free(parts);
+    free(ix.pos);
+    return ret == LEPT_PARSE_OK ? ret : lept_parse_root(v, json, len, 1, 0, opts, NULL, NULL, NULL);
 }
 
 /**
@@ -566,11 +5827,18 @@ int lept_is_equal(const lept_value *lhs, const lept_value *rhs) {
     if (lhs->type != rhs->type) {
         return 0;
     }
+    LEPT_EXPAND(lhs);
+    LEPT_EXPAND(rhs);
     switch (lhs->type) {
         case LEPT_STRING:
             return lhs->u.s.len == rhs->u.s.len && memcmp(lhs->u.s.s, rhs->u.s.s, lhs->u.s.len) == 0;
         case LEPT_NUMBER:
-            return lhs->u.n == rhs->u.n;
+            if ((lhs->flags & LEPT_FLAG_INTEGER) && (rhs->flags & LEPT_FLAG_INTEGER)) {
+                /* 两种整数表示的取值范围不相交，标志相同时比较位模式即可 */
+                return (lhs->flags & LEPT_FLAG_INTEGER) == (rhs->flags & LEPT_FLAG_INTEGER) &&
+                       lhs->u.u64 == rhs->u.u64;
+            }
+            return lept_get_number(lhs) == lept_get_number(rhs);
         case LEPT_ARRAY:
             if (lhs->u.a.size != rhs->u.a.size) {
                 return 0;
@@ -581,15 +5849,14 @@ int lept_is_equal(const lept_value *lhs, const lept_value *rhs) {
                 }
             return 1;
         case LEPT_OBJECT:
-            if (lhs->u.o.size != rhs->u.o.size) {
+            if (LEPT_OBJECT_SIZE(lhs) != LEPT_OBJECT_SIZE(rhs)) {
                 return 0;
             }
-            for (i = 0; i < lhs->u.o.size; i++) {
-                j = lept_find_object_index(rhs, lhs->u.o.m[i].k, lhs->u.o.m[i].klen);
-                if (memcmp(lhs->u.o.m[i].k, rhs->u.o.m[j].k, lhs->u.o.m[i].klen) == 0) {
-                    if (!lept_is_equal(lept_get_object_value(lhs, i), lept_get_object_value(rhs, j))) {
-                        return 0;
-                    }
+            for (i = 0; i < LEPT_OBJECT_SIZE(lhs); i++) {
+                j = lept_find_object_index(rhs, lept_get_object_key(lhs, i), lept_get_object_key_length(lhs, i));
+                if (j == LEPT_KEY_NOT_EXIST ||
+                    !lept_is_equal(lept_get_object_value(lhs, i), lept_get_object_value(rhs, j))) {
+                    return 0;
                 }
             }
             return 1;
@@ -639,6 +5906,12 @@ void lept_set_boolean(lept_value *v, int b) {
  */
 double lept_get_number(const lept_value *v) {
     assert(v != NULL && v->type == LEPT_NUMBER);
+    if (v->flags & LEPT_FLAG_INT64) {
+        return (double) v->u.i64;
+    }
+    if (v->flags & LEPT_FLAG_UINT64) {
+        return (double) v->u.u64;
+    }
     return v->u.n;
 }
 
@@ -651,6 +5924,95 @@ double lept_get_number(const lept_value *v) {
 void lept_set_number(lept_value *v, double n) {
     lept_free(v);
     v->u.n = n;
+    v->flags = 0;
+    v->type = LEPT_NUMBER;
+}
+
+/**
+ * number 是否以 64 位整数保存
+ *
+ * @param v
+ * @return
+ */
+int lept_is_integer(const lept_value *v) {
+    assert(v != NULL && v->type == LEPT_NUMBER);
+    return (v->flags & LEPT_FLAG_INTEGER) != 0;
+}
+
+/**
+ * 获取 JSON 值 number 的 int64_t 表示
+ *
+ * @param v
+ * @return
+ */
+int64_t lept_get_int64(const lept_value *v) {
+    assert(v != NULL && v->type == LEPT_NUMBER);
+    if (v->flags & LEPT_FLAG_INT64) {
+        return v->u.i64;
+    }
+    if (v->flags & LEPT_FLAG_UINT64) {
+        return v->u.u64 > (uint64_t) INT64_MAX ? INT64_MAX : (int64_t) v->u.u64;
+    }
+    /* 超出范围时取最接近的值，NaN 为 0：直接转换是未定义行为 */
+    if (v->u.n != v->u.n) {
+        return 0;
+    }
+    if (v->u.n >= 9223372036854775808.0) {
+        return INT64_MAX;
+    }
+    if (v->u.n < -9223372036854775808.0) {
+        return INT64_MIN;
+    }
+    return (int64_t) v->u.n;
+}
+
+/**
+ * 设置 JSON 值 number 为 int64_t
+ *
+ * @param v
+ * @param i
+ */
+void lept_set_int64(lept_value *v, int64_t i) {
+    lept_free(v);
+    v->u.i64 = i;
+    v->flags = LEPT_FLAG_INT64;
+    v->type = LEPT_NUMBER;
+}
+
+/**
+ * 获取 JSON 值 number 的 uint64_t 表示
+ *
+ * @param v
+ * @return
+ */
+uint64_t lept_get_uint64(const lept_value *v) {
+    assert(v != NULL && v->type == LEPT_NUMBER);
+    if (v->flags & LEPT_FLAG_INT64) {
+        return v->u.i64 < 0 ? 0 : (uint64_t) v->u.i64;
+    }
+    if (v->flags & LEPT_FLAG_UINT64) {
+        return v->u.u64;
+    }
+    /* 超出范围时取最接近的值，NaN 为 0：直接转换是未定义行为 */
+    if (!(v->u.n > -1.0)) {
+        return 0;
+    }
+    if (v->u.n >= 18446744073709551616.0) {
+        return UINT64_MAX;
+    }
+    return (uint64_t) v->u.n;
+}
+
+/**
+ * 设置 JSON 值 number 为 uint64_t，不超过 INT64_MAX 时按 int64_t 保存，使表示唯一
+ *
+ * @param v
+ * @param u
+ */
+void lept_set_uint64(lept_value *v, uint64_t u) {
+    lept_free(v);
+    v->u.u64 = u;
+    v->flags = u <= (uint64_t) INT64_MAX ? LEPT_FLAG_INT64 : LEPT_FLAG_UINT64;
     v->type = LEPT_NUMBER;
 }
 
@@ -741,6 +6103,37 @@ static void lept_stringify_string(lept_context *c, const char *s, size_t len) {
 
 #endif
 
+/**
+ * 无符号整数转十进制字符串，每次查表输出两位
+ *
+ * @param buf   至少 20 个字节
+ * @param x
+ * @return 写入的长度
+ */
+static size_t lept_u64toa(char *buf, uint64_t x) {
+    static const char digits2[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    char tmp[20], *p = tmp + sizeof(tmp);
+    size_t len;
+    while (x >= 100) {
+        const char *d = digits2 + (x % 100) * 2;
+        x /= 100;
+        *--p = d[1];
+        *--p = d[0];
+    }
+    if (x >= 10) {
+        *--p = digits2[x * 2 + 1];
+        *--p = digits2[x * 2];
+    } else {
+        *--p = (char) ('0' + x);
+    }
+    len = tmp + sizeof(tmp) - p;
+    memcpy(buf, p, len);
+    return len;
+}
+
 /**
  *
  * @param c
@@ -759,12 +6152,27 @@ static void lept_stringify_value(lept_context *c, const lept_value *v) {
             PUTS(c, "true", 4);
             break;
         case LEPT_NUMBER:
-            c->top -= 32 - sprintf(lept_context_push(c, 32), "%.17g", v->u.n);
+            if (v->flags & LEPT_FLAG_INT64) {
+                char *p = lept_context_push(c, 21);
+                size_t len;
+                if (v->u.i64 < 0) {
+                    *p = '-';
+                    len = 1 + lept_u64toa(p + 1, (uint64_t) -(v->u.i64 + 1) + 1);
+                } else {
+                    len = lept_u64toa(p, (uint64_t) v->u.i64);
+                }
+                c->top -= 21 - len;
+            } else if (v->flags & LEPT_FLAG_UINT64) {
+                c->top -= 20 - lept_u64toa(lept_context_push(c, 20), v->u.u64);
+            } else {
+                c->top -= 32 - sprintf(lept_context_push(c, 32), "%.17g", v->u.n);
+            }
             break;
         case LEPT_STRING:
             lept_stringify_string(c, v->u.s.s, v->u.s.len);
             break;
         case LEPT_ARRAY:
+            LEPT_EXPAND(v);
             PUTC(c, '[');
             for (i = 0; i < v->u.a.size; i++) {
                 if (i > 0)
@@ -774,13 +6182,25 @@ static void lept_stringify_value(lept_context *c, const lept_value *v) {
             PUTC(c, ']');
             break;
         case LEPT_OBJECT:
+            LEPT_EXPAND(v);
             PUTC(c, '{');
-            for (i = 0; i < v->u.o.size; i++) {
-                if (i > 0)
-                    PUTC(c, ',');
-                lept_stringify_string(c, v->u.o.m[i].k, v->u.o.m[i].klen);
-                PUTC(c, ':');
-                lept_stringify_value(c, &v->u.o.m[i].v);
+            if (v->flags & LEPT_FLAG_SHAPED) {
+                const lept_shape *s = v->u.h.shape;
+                for (i = 0; i < s->size; i++) {
+                    if (i > 0)
+                        PUTC(c, ',');
+                    lept_stringify_string(c, s->keys[i].k, s->keys[i].klen);
+                    PUTC(c, ':');
+                    lept_stringify_value(c, &v->u.h.v[i]);
+                }
+            } else {
+                for (i = 0; i < v->u.o.size; i++) {
+                    if (i > 0)
+                        PUTC(c, ',');
+                    lept_stringify_string(c, v->u.o.m[i].k, v->u.o.m[i].klen);
+                    PUTC(c, ':');
+                    lept_stringify_value(c, &v->u.o.m[i].v);
+                }
             }
             PUTC(c, '}');
             break;
@@ -807,39 +6227,364 @@ char *lept_stringify(const lept_value *v, size_t *length) {
     return c.stack;
 }
 
+/**
+ * 初始化工作区
+ *
+ * @param w
+ * @param cap
+ */
+void lept_workspace_init(lept_workspace *w, size_t cap) {
+    assert(w != NULL);
+    w->stack = w->values = w->out = NULL;
+    w->ssize = w->vsize = w->osize = 0;
+    w->cap = cap;
+}
+
+/**
+ * 释放超过 keep 字节的缓冲区
+ *
+ * @param w
+ * @param keep
+ */
+void lept_workspace_trim(lept_workspace *w, size_t keep) {
+    assert(w != NULL);
+    if (w->ssize > keep) {
+        free(w->stack);
+        w->stack = NULL;
+        w->ssize = 0;
+    }
+    if (w->vsize > keep) {
+        free(w->values);
+        w->values = NULL;
+        w->vsize = 0;
+    }
+    if (w->osize > keep) {
+        free(w->out);
+        w->out = NULL;
+        w->osize = 0;
+    }
+}
+
+/**
+ * 释放工作区的所有缓冲区
+ *
+ * @param w
+ */
+void lept_workspace_free(lept_workspace *w) {
+    lept_workspace_trim(w, 0);
+}
+
+/**
+ * 使用工作区的堆栈解析
+ *
+ * @param w
+ * @param v
+ * @param json
+ * @param len
+ * @param opts
+ * @return
+ */
+int lept_workspace_parse(lept_workspace *w, lept_value *v, const char *json, size_t len, const lept_parse_options *opts) {
+    int ret;
+    assert(w != NULL);
+    if (opts && opts->nthreads > 1) {
+        return lept_parse_opts(v, json, len, opts);
+    }
+    ret = lept_parse_root(v, json, len, 1, 0, opts, NULL, w, NULL);
+    /* 偶尔的大文档不应让工作区一直占用大量内存 */
+    if (w->cap != 0) {
+        lept_workspace_trim(w, w->cap);
+    }
+    return ret;
+}
+
+/**
+ * 使用工作区的缓冲区序列化
+ *
+ * @param w
+ * @param v
+ * @param length
+ * @return
+ */
+const char *lept_workspace_stringify(lept_workspace *w, const lept_value *v, size_t *length) {
+    lept_context c;
+    assert(w != NULL && v != NULL);
+    /* 上一次的结果已不再使用，此时才按上限释放 */
+    if (w->cap != 0 && w->osize > w->cap) {
+        free(w->out);
+        w->out = NULL;
+        w->osize = 0;
+    }
+    c.stack = w->out;
+    c.size = w->osize;
+    c.top = 0;
+    lept_stringify_value(&c, v);
+    if (length)
+        *length = c.top;
+    PUTC(&c, '\0');
+    w->out = c.stack;
+    w->osize = c.size;
+    return w->out;
+}
+
+/**
+ * @param d
+ * @param chunk_size
+ */
+void lept_document_init(lept_document *d, size_t chunk_size) {
+    assert(d != NULL);
+    lept_init(&d->root);
+    d->chunks = d->current = NULL;
+    d->top = d->end = NULL;
+    d->chunk_size = chunk_size ? chunk_size : LEPT_DOCUMENT_CHUNK_SIZE;
+    lept_workspace_init(&d->w, 0);
+}
+
+/**
+ * 解析到文档：重用文档的区块和堆栈
+ *
+ * @param d
+ * @param json
+ * @param len
+ * @param opts
+ * @return
+ */
+int lept_document_parse(lept_document *d, const char *json, size_t len, const lept_parse_options *opts) {
+    lept_parse_options o = {0, 0, 0};
+    assert(d != NULL);
+    lept_document_reset(d);
+    if (opts) {
+        o = *opts;
+    }
+    /* 共享的键和形状按引用计数释放，与整块释放不相容 */
+    o.flags &= ~(LEPT_PARSE_OPT_INTERN_KEYS | LEPT_PARSE_OPT_SHAPES);
+    o.nthreads = 0;
+    return lept_parse_root(&d->root, json, len, 1, 0, &o, NULL, &d->w, d);
+}
+
+/**
+ * lept_free 只释放修改时在堆上分配的部分，区块中的内存留到下一次解析重用
+ *
+ * @param d
+ */
+void lept_document_reset(lept_document *d) {
+    assert(d != NULL);
+    lept_free(&d->root);
+    d->current = NULL;
+    d->top = d->end = NULL;
+}
+
+/**
+ * @param d
+ */
+void lept_document_free(lept_document *d) {
+    lept_chunk *k;
+    lept_document_reset(d);
+    while ((k = d->chunks) != NULL) {
+        d->chunks = k->next;
+        free(k);
+    }
+    lept_workspace_free(&d->w);
+}
+
+/* lept_free 待释放容器列表的初始容量（在 C 调用栈上），超出时改用堆内存 */
+#define LEPT_FREE_LOCAL_SIZE 16
+
 /**
  * 释放内存
+ * 不递归：待释放的数组和对象放入列表逐个处理，因此任意嵌套层数都不会耗尽 C 调用栈
  *
  * @param v
  */
 void lept_free(lept_value *v) {
-    size_t i;
+    lept_value local[LEPT_FREE_LOCAL_SIZE], *work = local, x;
+    size_t i, n = 0, capacity = LEPT_FREE_LOCAL_SIZE;
     if (v == NULL) {
         return;
     }
 /*    assert(v != NULL);*/
+    x = *v;
+    for (;;) {
+        switch (x.type) {
+            case LEPT_STRING:
+                if (!(x.flags & LEPT_FLAG_BORROWED))
+                    free(x.u.s.s);
+                break;
+            case LEPT_ARRAY:
+            case LEPT_OBJECT: {
+                size_t size;
+                /* 未展开的容器只引用输入 */
+                if (x.flags & LEPT_FLAG_LAZY)
+                    break;
+                size = x.type == LEPT_ARRAY ? x.u.a.size : LEPT_OBJECT_SIZE(&x);
+                if (n + size > capacity) {
+                    while (n + size > capacity)
+                        capacity += capacity >> 1;
+                    if (work == local) {
+                        work = (lept_value *) malloc(capacity * sizeof(lept_value));
+                        memcpy(work, local, n * sizeof(lept_value));
+                    } else {
+                        work = (lept_value *) realloc(work, capacity * sizeof(lept_value));
+                    }
+                }
+                if (x.type == LEPT_ARRAY) {
+                    for (i = 0; i < size; i++) {
+                        /* 只有自有的 string 以及 array、object 需要释放 */
+                        if (x.u.a.e[i].type > LEPT_STRING ||
+                            (x.u.a.e[i].type == LEPT_STRING && !(x.u.a.e[i].flags & LEPT_FLAG_BORROWED)))
+                            work[n++] = x.u.a.e[i];
+                    }
+                    /* 文档区块中的元素数组不释放 */
+                    if (!(x.flags & LEPT_FLAG_BORROWED))
+                        free(x.u.a.e);
+                } else if (x.flags & LEPT_FLAG_SHAPED) {
+                    for (i = 0; i < size; i++) {
+                        if (x.u.h.v[i].type >= LEPT_STRING)
+                            work[n++] = x.u.h.v[i];
+                    }
+                    free(x.u.h.v);
+                    lept_shape_release(x.u.h.shape);
+                } else {
+                    for (i = 0; i < size; i++) {
+                        lept_key_free(x.u.o.m[i].k, x.u.o.m[i].kflags);
+                        if (x.u.o.m[i].v.type > LEPT_STRING ||
+                            (x.u.o.m[i].v.type == LEPT_STRING && !(x.u.o.m[i].v.flags & LEPT_FLAG_BORROWED)))
+                            work[n++] = x.u.o.m[i].v;
+                    }
+                    if (!(x.flags & LEPT_FLAG_BORROWED))
+                        free(x.u.o.m);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        if (n == 0) {
+            break;
+        }
+        x = work[--n];
+    }
+    if (work != local) {
+        free(work);
+    }
+    /* 置空，避免重复释放 */
+    v->type = LEPT_NULL;
+    v->flags = 0;
+}
+
+/**
+ * 复制 len 个字节并以 '\0' 结尾
+ *
+ * @param s
+ * @param len
+ * @return
+ */
+static char *lept_strndup(const char *s, size_t len) {
+    char *p = (char *) malloc(len + 1);
+    memcpy(p, s, len);
+    p[len] = '\0';
+    return p;
+}
+
+/**
+ * 是否（包括子节点和对象键）引用了外部缓冲区
+ *
+ * @param v
+ * @return
+ */
+int lept_is_borrowed(const lept_value *v) {
+    size_t i;
+    assert(v != NULL);
+    switch (v->type) {
+        case LEPT_STRING:
+            return (v->flags & LEPT_FLAG_BORROWED) != 0;
+        case LEPT_ARRAY:
+            if (v->flags & (LEPT_FLAG_LAZY | LEPT_FLAG_BORROWED)) {
+                return 1;
+            }
+            for (i = 0; i < v->u.a.size; i++) {
+                if (lept_is_borrowed(&v->u.a.e[i])) {
+                    return 1;
+                }
+            }
+            return 0;
+        case LEPT_OBJECT:
+            if (v->flags & (LEPT_FLAG_LAZY | LEPT_FLAG_BORROWED)) {
+                return 1;
+            }
+            for (i = 0; i < LEPT_OBJECT_SIZE(v); i++) {
+                unsigned char kflags = v->flags & LEPT_FLAG_SHAPED ? v->u.h.shape->keys[i].kflags : v->u.o.m[i].kflags;
+                if ((kflags & LEPT_FLAG_BORROWED) || lept_is_borrowed(lept_get_object_value(v, i))) {
+                    return 1;
+                }
+            }
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * 把引用外部缓冲区的字符串和对象键复制为自有内存
+ *
+ * @param v
+ */
+void lept_detach(lept_value *v) {
+    size_t i;
+    assert(v != NULL);
     switch (v->type) {
         case LEPT_STRING:
-            free(v->u.s.s);
+            if (v->flags & LEPT_FLAG_BORROWED) {
+                v->u.s.s = lept_strndup(v->u.s.s, v->u.s.len);
+                v->flags &= ~LEPT_FLAG_BORROWED;
+            }
             break;
         case LEPT_ARRAY:
+            LEPT_EXPAND(v);
+            if (v->flags & LEPT_FLAG_BORROWED) {
+                lept_value *e = (lept_value *) malloc(v->u.a.size * sizeof(lept_value));
+                memcpy(e, v->u.a.e, v->u.a.size * sizeof(lept_value));
+                v->u.a.e = e;
+                v->u.a.capacity = v->u.a.size;
+                v->flags &= ~LEPT_FLAG_BORROWED;
+            }
             for (i = 0; i < v->u.a.size; i++) {
-                lept_free(&v->u.a.e[i]);
+                lept_detach(&v->u.a.e[i]);
             }
-            free(v->u.a.e);
             break;
         case LEPT_OBJECT:
+            LEPT_EXPAND(v);
+            if (v->flags & LEPT_FLAG_SHAPED) {
+                /* 形状由多个对象共享，就地复制其键对这些对象同样成立 */
+                lept_shape *s = v->u.h.shape;
+                for (i = 0; i < s->size; i++) {
+                    if (s->keys[i].kflags & LEPT_FLAG_BORROWED) {
+                        s->keys[i].k = lept_strndup(s->keys[i].k, s->keys[i].klen);
+                        s->keys[i].kflags &= ~LEPT_FLAG_BORROWED;
+                    }
+                    lept_detach(&v->u.h.v[i]);
+                }
+                break;
+            }
+            if (v->flags & LEPT_FLAG_BORROWED) {
+                lept_member *m = (lept_member *) malloc(v->u.o.size * sizeof(lept_member));
+                memcpy(m, v->u.o.m, v->u.o.size * sizeof(lept_member));
+                v->u.o.m = m;
+                v->u.o.capacity = v->u.o.size;
+                v->flags &= ~LEPT_FLAG_BORROWED;
+            }
             for (i = 0; i < v->u.o.size; i++) {
-                free(v->u.o.m[i].k);
-                lept_free(&v->u.o.m[i].v);
+                lept_member *m = &v->u.o.m[i];
+                if (m->kflags & LEPT_FLAG_BORROWED) {
+                    m->k = lept_strndup(m->k, m->klen);
+                    m->kflags &= ~LEPT_FLAG_BORROWED;
+                }
+                lept_detach(&m->v);
             }
-            free(v->u.o.m);
             break;
         default:
             break;
     }
-    /* 置空，避免重复释放 */
-    v->type = LEPT_NULL;
 }
 
 /**
@@ -905,6 +6650,7 @@ void lept_set_array(lept_value *v, size_t capacity) {
  */
 size_t lept_get_array_size(const lept_value *v) {
     assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
     return v->u.a.size;
 }
 
@@ -917,6 +6663,7 @@ size_t lept_get_array_size(const lept_value *v) {
  */
 lept_value *lept_get_array_element(const lept_value *v, size_t index) {
     assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
     assert(index < v->u.a.size);
     return &v->u.a.e[index];
 }
@@ -928,9 +6675,18 @@ lept_value *lept_get_array_element(const lept_value *v, size_t index) {
  */
 void lept_reserve_array(lept_value *v, size_t capacity) {
     assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
     if (v->u.a.capacity < capacity) {
+        if (v->flags & LEPT_FLAG_BORROWED) {
+            /* 文档区块中的元素数组不能扩大，改到堆上 */
+            lept_value *e = (lept_value *) malloc(capacity * sizeof(lept_value));
+            memcpy(e, v->u.a.e, v->u.a.size * sizeof(lept_value));
+            v->u.a.e = e;
+            v->flags &= ~LEPT_FLAG_BORROWED;
+        } else {
+            v->u.a.e = (lept_value *) realloc(v->u.a.e, capacity * sizeof(lept_value));
+        }
         v->u.a.capacity = capacity;
-        v->u.a.e = (lept_value *) realloc(v->u.a.e, capacity * sizeof(lept_value));
     }
 }
 
@@ -940,7 +6696,8 @@ void lept_reserve_array(lept_value *v, size_t capacity) {
  */
 void lept_shrink_array(lept_value *v) {
     assert(v != NULL && v->type == LEPT_ARRAY);
-    if (v->u.a.capacity > v->u.a.size) {
+    LEPT_EXPAND(v);
+    if (v->u.a.capacity > v->u.a.size && !(v->flags & LEPT_FLAG_BORROWED)) {
         v->u.a.capacity = v->u.a.size;
         v->u.a.e = (lept_value *) realloc(v->u.a.e, v->u.a.capacity * sizeof(lept_value));
     }
@@ -952,6 +6709,7 @@ void lept_shrink_array(lept_value *v) {
  */
 void lept_clear_array(lept_value *v) {
     assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
     lept_erase_array_element(v, 0, v->u.a.size);
 }
 
@@ -962,6 +6720,7 @@ void lept_clear_array(lept_value *v) {
  */
 lept_value *lept_pushback_array_element(lept_value *v) {
     assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
     if (v->u.a.size == v->u.a.capacity) {
         lept_reserve_array(v, v->u.a.capacity == 0 ? 1 : v->u.a.capacity * 2);
     }
@@ -974,7 +6733,9 @@ lept_value *lept_pushback_array_element(lept_value *v) {
  * @param v
  */
 void lept_popback_array_element(lept_value *v) {
-    assert(v != NULL && v->type == LEPT_ARRAY && v->u.a.size > 0);
+    assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
+    assert(v->u.a.size > 0);
     lept_free(&v->u.a.e[--v->u.a.size]);
 }
 
@@ -985,7 +6746,9 @@ void lept_popback_array_element(lept_value *v) {
  * @return
  */
 lept_value *lept_insert_array_element(lept_value *v, size_t index) {
-    assert(v != NULL && v->type == LEPT_ARRAY && index <= v->u.a.size);
+    assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
+    assert(index <= v->u.a.size);
     /* \todo */
     return NULL;
 }
@@ -997,7 +6760,9 @@ lept_value *lept_insert_array_element(lept_value *v, size_t index) {
  * @param count
  */
 void lept_erase_array_element(lept_value *v, size_t index, size_t count) {
-    assert(v != NULL && v->type == LEPT_ARRAY && index + count <= v->u.a.size);
+    assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
+    assert(index + count <= v->u.a.size);
     /* \todo */
 }
 
@@ -1008,9 +6773,43 @@ void lept_erase_array_element(lept_value *v, size_t index, size_t count) {
  */
 size_t lept_get_array_capacity(const lept_value *v) {
     assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
     return v->u.a.capacity;
 }
 
+/**
+ * 把按形状保存的对象转换为逐个保存成员，修改对象之前调用：共享的键增加引用计数，
+ * 引用输入的键照常引用，其他键复制
+ *
+ * @param v
+ */
+static void lept_unshape(lept_value *v) {
+    lept_shape *s = v->u.h.shape;
+    lept_value *e = v->u.h.v;
+    size_t i, n = s->size;
+    lept_member *m = (lept_member *) malloc(n * sizeof(lept_member));
+    for (i = 0; i < n; i++) {
+        const lept_shape_key *k = &s->keys[i];
+        m[i].klen = k->klen;
+        m[i].kflags = k->kflags;
+        if (k->kflags & LEPT_FLAG_SHARED)
+            LEPT_KEY_REFS(m[i].k = k->k)++;
+        else if (k->kflags & LEPT_FLAG_BORROWED)
+            m[i].k = k->k;
+        else
+            m[i].k = lept_strndup(k->k, k->klen);
+        memcpy(&m[i].v, &e[i], sizeof(lept_value));
+    }
+    free(e);
+    lept_shape_release(s);
+    v->flags &= ~LEPT_FLAG_SHAPED;
+    v->u.o.m = m;
+    v->u.o.size = v->u.o.capacity = n;
+}
+
+/* 修改对象的内容之前调用 */
+#define LEPT_UNSHAPE(v) do { if ((v)->flags & LEPT_FLAG_SHAPED) lept_unshape(v); } while(0)
+
 /**
  * 获取 JSON 值 object 长度
  *
@@ -1019,7 +6818,8 @@ size_t lept_get_array_capacity(const lept_value *v) {
  */
 size_t lept_get_object_size(const lept_value *v) {
     assert(v != NULL && v->type == LEPT_OBJECT);
-    return v->u.o.size;
+    LEPT_EXPAND(v);
+    return LEPT_OBJECT_SIZE(v);
 }
 
 /**
@@ -1029,6 +6829,7 @@ size_t lept_get_object_size(const lept_value *v) {
  */
 size_t lept_get_object_capacity(const lept_value *v) {
     assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_EXPAND(v);
     /* \todo */
     return 0;
 }
@@ -1040,6 +6841,8 @@ size_t lept_get_object_capacity(const lept_value *v) {
  */
 void lept_reserve_object(lept_value *v, size_t capacity) {
     assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_EXPAND(v);
+    LEPT_UNSHAPE(v);
     /* \todo */
 }
 
@@ -1049,6 +6852,8 @@ void lept_reserve_object(lept_value *v, size_t capacity) {
  */
 void lept_shrink_object(lept_value *v) {
     assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_EXPAND(v);
+    LEPT_UNSHAPE(v);
     /* \todo */
 }
 
@@ -1058,6 +6863,8 @@ void lept_shrink_object(lept_value *v) {
  */
 void lept_clear_object(lept_value *v) {
     assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_EXPAND(v);
+    LEPT_UNSHAPE(v);
     /* \todo */
 }
 
@@ -1069,7 +6876,10 @@ void lept_clear_object(lept_value *v) {
  */
 const char *lept_get_object_key(const lept_value *v, size_t index) {
     assert(v != NULL && v->type == LEPT_OBJECT);
-    assert(index < v->u.o.size);
+    LEPT_EXPAND(v);
+    assert(index < LEPT_OBJECT_SIZE(v));
+    if (v->flags & LEPT_FLAG_SHAPED)
+        return v->u.h.shape->keys[index].k;
     return v->u.o.m[index].k;
 }
 
@@ -1081,7 +6891,10 @@ const char *lept_get_object_key(const lept_value *v, size_t index) {
  */
 size_t lept_get_object_key_length(const lept_value *v, size_t index) {
     assert(v != NULL && v->type == LEPT_OBJECT);
-    assert(index < v->u.o.size);
+    LEPT_EXPAND(v);
+    assert(index < LEPT_OBJECT_SIZE(v));
+    if (v->flags & LEPT_FLAG_SHAPED)
+        return v->u.h.shape->keys[index].klen;
     return v->u.o.m[index].klen;
 }
 
@@ -1094,7 +6907,10 @@ size_t lept_get_object_key_length(const lept_value *v, size_t index) {
  */
 lept_value *lept_get_object_value(const lept_value *v, size_t index) {
     assert(v != NULL && v->type == LEPT_OBJECT);
-    assert(index < v->u.o.size);
+    LEPT_EXPAND(v);
+    assert(index < LEPT_OBJECT_SIZE(v));
+    if (v->flags & LEPT_FLAG_SHAPED)
+        return &v->u.h.v[index];
     return &v->u.o.m[index].v;
 }
 
@@ -1108,6 +6924,9 @@ lept_value *lept_get_object_value(const lept_value *v, size_t index) {
 size_t lept_find_object_index(const lept_value *v, const char *key, size_t klen) {
     size_t i;
     assert(v != NULL && v->type == LEPT_OBJECT && key != NULL);
+    LEPT_EXPAND(v);
+    if (v->flags & LEPT_FLAG_SHAPED)
+        return lept_shape_find(v->u.h.shape, key, klen);
     for (i = 0; i < v->u.o.size; i++)
         if (v->u.o.m[i].klen == klen && memcmp(v->u.o.m[i].k, key, klen) == 0)
             return i;
@@ -1123,7 +6942,7 @@ size_t lept_find_object_index(const lept_value *v, const char *key, size_t klen)
  */
 lept_value *lept_find_object_value(lept_value *v, const char *key, size_t klen) {
     size_t index = lept_find_object_index(v, key, klen);
-    return index != LEPT_KEY_NOT_EXIST ? &v->u.o.m[index].v : NULL;
+    return index != LEPT_KEY_NOT_EXIST ? lept_get_object_value(v, index) : NULL;
 }
 
 /**
@@ -1149,6 +6968,8 @@ void lept_set_object(lept_value *v, size_t capacity) {
  */
 lept_value *lept_set_object_value(lept_value *v, const char *key, size_t klen) {
     assert(v != NULL && v->type == LEPT_OBJECT && key != NULL);
+    LEPT_EXPAND(v);
+    LEPT_UNSHAPE(v);
     /* \todo */
     return NULL;
 }
@@ -1159,52 +6980,71 @@ lept_value *lept_set_object_value(lept_value *v, const char *key, size_t klen) {
  * @param index
  */
 void lept_remove_object_value(lept_value *v, size_t index) {
-    assert(v != NULL && v->type == LEPT_OBJECT && index < v->u.o.size);
+    assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_EXPAND(v);
+    LEPT_UNSHAPE(v);
+    assert(index < v->u.o.size);
     /* \todo */
 }
 
 /**
- * FIXME 内存泄露，待修复
+ * 深复制；共享的对象键（LEPT_FLAG_SHARED）和形状只增加引用计数
  *
  * @param dst
  * @param src
  */
 void lept_copy(lept_value *dst, const lept_value *src) {
+    size_t i, n;
     assert(src != NULL && dst != NULL && src != dst);
-    size_t i, j;
+    LEPT_EXPAND(src);
     switch (src->type) {
         case LEPT_STRING:
             lept_set_string(dst, src->u.s.s, src->u.s.len);
             break;
         case LEPT_ARRAY:
-            /* \todo */
-            lept_set_array(dst, src->u.a.capacity);
+            lept_set_array(dst, src->u.a.size);
             for (i = 0; i < src->u.a.size; i++) {
-                lept_value *src_v = &src->u.a.e[i];
-                switch (src_v->type) {
-                    case LEPT_ARRAY:
-                    case LEPT_OBJECT:
-                        lept_copy(&dst->u.a.e[i], src_v);
-                        break;
-                    case LEPT_NULL:
-                        lept_set_null(&dst->u.a.e[i]);
-                        break;
-                    case LEPT_NUMBER:
-                        lept_set_number(&dst->u.a.e[i], src_v->u.n);
-                        break;
-                    case LEPT_STRING:
-                        lept_set_string(&dst->u.a.e[i], src_v->u.s.s, src_v->u.s.len);
-                        break;
-                    case LEPT_FALSE:
-                    case LEPT_TRUE:
-                        lept_set_boolean(&dst->u.a.e[i], src_v->type);
-                        break;
-                }
+                lept_init(&dst->u.a.e[i]);
+                lept_copy(&dst->u.a.e[i], &src->u.a.e[i]);
             }
             dst->u.a.size = src->u.a.size;
             break;
         case LEPT_OBJECT:
-            /* \todo */
+            if ((src->flags & LEPT_FLAG_SHAPED) && !lept_shape_borrowed(src->u.h.shape)) {
+                /* 副本共享同一个形状 */
+                lept_shape *s = src->u.h.shape;
+                lept_free(dst);
+                dst->type = LEPT_OBJECT;
+                dst->flags = LEPT_FLAG_SHAPED;
+                dst->u.h.shape = s;
+                dst->u.h.v = (lept_value *) malloc(s->size * sizeof(lept_value));
+                s->refs++;
+                for (i = 0; i < s->size; i++) {
+                    lept_init(&dst->u.h.v[i]);
+                    lept_copy(&dst->u.h.v[i], &src->u.h.v[i]);
+                }
+                break;
+            }
+            /* 形状的键引用输入时副本逐个保存成员，键复制为自有内存 */
+            n = LEPT_OBJECT_SIZE(src);
+            lept_set_object(dst, n);
+            for (i = 0; i < n; i++) {
+                lept_member *to = &dst->u.o.m[i];
+                unsigned char kflags = src->flags & LEPT_FLAG_SHAPED ? src->u.h.shape->keys[i].kflags : src->u.o.m[i].kflags;
+                const char *k = lept_get_object_key(src, i);
+                to->klen = lept_get_object_key_length(src, i);
+                if (kflags & LEPT_FLAG_SHARED) {
+                    LEPT_KEY_REFS(k)++;
+                    to->k = (char *) k;
+                    to->kflags = LEPT_FLAG_SHARED;
+                } else {
+                    to->k = lept_strndup(k, to->klen);
+                    to->kflags = 0;
+                }
+                lept_init(&to->v);
+                lept_copy(&to->v, lept_get_object_value(src, i));
+            }
+            dst->u.o.size = n;
             break;
         default:
             lept_free(dst);
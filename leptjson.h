@@ -2,6 +2,7 @@
 #define LEPTJSON_H__
 
 #include <stddef.h> /* size_t */
+#include <stdint.h> /* int64_t, uint64_t */
 
 /* 项目名称_目录_文件名称_H__ */
 /* 项目名称_H__ */
@@ -57,9 +58,77 @@ enum {
 
     LEPT_PARSE_MISS_COLON,
 
-    LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET
+    LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET,
+
+    /* 数组和对象的嵌套层数超过 lept_parse_options.max_depth */
+    LEPT_PARSE_DEPTH_EXCEEDED,
+
+    /* SAX 事件处理函数中止了解析 */
+    LEPT_PARSE_ABORTED,
+
+    /* 文件无法打开、映射或读取 */
+    LEPT_PARSE_IO_ERROR,
+
+    /* 字符串含有不合法的 UTF-8 序列（LEPT_PARSE_OPT_VALIDATE_UTF8） */
+    LEPT_PARSE_INVALID_UTF8
 };
 
+/* 解析时扫描使用的指令集级别 */
+typedef enum {
+    LEPT_SIMD_AUTO = -1,    /* 自动选择 CPU 支持的最高级别 */
+    LEPT_SIMD_SCALAR = 0,   /* 逐字节扫描，适用于所有平台 */
+    LEPT_SIMD_SSE2,
+    LEPT_SIMD_AVX2
+} lept_simd_level;
+
+/* 解析选项 */
+typedef struct {
+    unsigned flags;     /* LEPT_PARSE_OPT_* 的组合 */
+    size_t max_depth;   /* 数组和对象的最大嵌套层数，超过时返回 LEPT_PARSE_DEPTH_EXCEEDED；0 表示不限制 */
+    size_t nthreads;    /* 根值为较大的数组时用多少个线程并行构建其元素，结果与串行相同；0 或 1 表示不并行，不宜超过 CPU 核数 */
+} lept_parse_options;
+
+/*
+ * 不含转义的字符串和对象键直接引用输入（指针与长度），不复制；含转义的仍复制解码。
+ * 引用的内容不以 '\0' 结尾，须配合长度使用；输入须在结果释放或 lept_detach 之前保持有效
+ */
+#define LEPT_PARSE_OPT_BORROW   0x01
+
+/*
+ * 延迟解析：根值以下的非空数组和对象只校验并记录源文本区间，首次经访问函数
+ * （lept_get_array_element、lept_find_object_value 等）访问时才展开一层。
+ * 错误码与完整解析相同；输入须在结果释放或 lept_detach 之前保持有效。
+ * 展开会修改 const lept_value，同一个值不能在多个线程中同时首次访问
+ */
+#define LEPT_PARSE_OPT_LAZY     0x02
+
+/* 只用于 lept_parse_ndjson：记录解析完即交付，不保证顺序，回调可能在多个线程中同时执行 */
+#define LEPT_PARSE_OPT_UNORDERED 0x04
+
+/*
+ * 校验字符串和对象键是否为合法的 UTF-8（RFC 3629），否则返回 LEPT_PARSE_INVALID_UTF8；
+ * 默认不校验，0x20 及以上的字节原样保留。校验与查找引号、转义的扫描合并进行。
+ * lept_parser（分块解析）与 lept_reader 不支持此选项
+ */
+#define LEPT_PARSE_OPT_VALIDATE_UTF8 0x08
+
+/*
+ * 对象键驻留：一次解析中相同的键（如对象数组中每个元素的 "id"）共享一份不可修改的内存，按引用计数释放。
+ * 适合记录形式的数据；一次解析中不同的键超过 4096 个后，其余的键照常单独分配。
+ * 并行解析（nthreads）时同一线程解析的元素之间共享，lept_parse_ndjson 时同一块的记录之间共享。
+ * 共享的键的引用计数不是原子的，同一次解析得到的值（包括 lept_copy 的副本）不能在多个线程中同时释放或复制
+ */
+#define LEPT_PARSE_OPT_INTERN_KEYS 0x10
+
+/*
+ * 按形状保存对象：键序列相同的对象（如对象数组中的记录）共享一个形状（有序的键表及查找表），
+ * 对象本身只保存值，按键查找为一次散列表探查。同时驻留对象键（LEPT_PARSE_OPT_INTERN_KEYS）。
+ * 访问函数照常使用；修改对象前先转换为逐个保存成员。超过 64 个键的对象，以及一次解析中
+ * 不同的键序列超过 1024 个后的对象照常保存成员。并行解析（nthreads）时同一线程解析的元素之间共享，
+ * lept_parse_ndjson 时同一块的记录之间共享。形状的引用计数同样不是原子的
+ */
+#define LEPT_PARSE_OPT_SHAPES   0x20
+
 #define LEPT_KEY_NOT_EXIST ((size_t) - 1)
 
 /* JSON 结构体 */
@@ -67,6 +136,8 @@ typedef struct lept_value lept_value;
 
 typedef struct lept_member lept_member;
 
+typedef struct lept_shape lept_shape;
+
 struct lept_value {
     /* 值：使用共用体节省内存 */
     union {
@@ -77,6 +148,12 @@ struct lept_value {
             size_t size, capacity;
         } o;
 
+        /* 按形状保存的 object（LEPT_FLAG_SHAPED）：共享的形状及按键的顺序排列的值 */
+        struct {
+            lept_shape *shape;
+            lept_value *v;
+        } h;
+
         /* array：用到自身类型的指针，必须向前声明 */
         struct {
             lept_value *e;
@@ -89,18 +166,51 @@ struct lept_value {
             size_t len;
         } s;
 
-        /* number */
+        /* 延迟解析的 array/object（LEPT_FLAG_LAZY）：源文本区间及展开时使用的解析选项 */
+        struct {
+            const char *json;
+            size_t len;
+            unsigned flags;
+        } l;
+
+        /* number：不含小数和指数且在范围内的整数按 64 位整数精确保存，由 flags 区分 */
         double n;
+        int64_t i64;
+        uint64_t u64;
     } u;
 
     /* 类型 */
     lept_type type;
+
+    /* 附加标志（LEPT_FLAG_*） */
+    unsigned char flags;
 };
 
+/* number 以 int64_t 保存 */
+#define LEPT_FLAG_INT64     0x01
+
+/* number 以 uint64_t 保存（大于 INT64_MAX 的正整数） */
+#define LEPT_FLAG_UINT64    0x02
+
+#define LEPT_FLAG_INTEGER   (LEPT_FLAG_INT64 | LEPT_FLAG_UINT64)
+
+/* string（或成员键）、array/object 的元素（成员）数组引用外部缓冲区（输入或 lept_document 的区块），lept_free 时不释放 */
+#define LEPT_FLAG_BORROWED  0x04
+
+/* array/object 尚未展开，u.l 记录其源文本（LEPT_PARSE_OPT_LAZY） */
+#define LEPT_FLAG_LAZY      0x08
+
+/* 成员键与其他成员共享，引用计数在键之前（LEPT_PARSE_OPT_INTERN_KEYS），不可修改 */
+#define LEPT_FLAG_SHARED    0x10
+
+/* object 按形状保存，u.h 为形状和值（LEPT_PARSE_OPT_SHAPES） */
+#define LEPT_FLAG_SHAPED    0x20
+
 /* JSON object 成员 */
 struct lept_member {
     char *k;        /* 成员键以及键的长度 */
     size_t klen;
+    unsigned char kflags;   /* 成员键的标志（LEPT_FLAG_BORROWED、LEPT_FLAG_SHARED） */
     lept_value v;   /* 成员值 */
 };
 
@@ -108,7 +218,7 @@ struct lept_member {
  * （调用访问函数前）对 JSON 对象类型初始化
  * do { ... } while(0) 把表达式转为语句，模仿无返回值的函数
  */
-#define lept_init(v) do { (v)->type = LEPT_NULL; } while(0)
+#define lept_init(v) do { (v)->type = LEPT_NULL; (v)->flags = 0; } while(0)
 
 /**
  *
@@ -134,6 +244,352 @@ int lept_is_equal(const lept_value* lhs, const lept_value* rhs);
  */
 int lept_parse(lept_value *v, const char *json);
 
+/**
+ * 解析长度为 len 的 JSON，输入不要求以 '\0' 结尾（可直接解析接收缓冲区、mmap 区域等）
+ * 输入中的 '\0' 按普通字符处理
+ *
+ * @param v     根节点指针
+ * @param json  JSON 文本
+ * @param len   JSON 文本长度
+ * @return
+ */
+int lept_parse_n(lept_value *v, const char *json, size_t len);
+
+/**
+ * 解析 JSON 文本开头的一个值，值之后允许还有其他内容（不返回 LEPT_PARSE_ROOT_NOT_SINGULAR）
+ *
+ * @param v         根节点指针
+ * @param json      JSON 文本
+ * @param len       JSON 文本长度
+ * @param consumed  非 NULL 时返回解析停止处的偏移：成功时为值及其后空白的长度，失败时为出错位置
+ * @return
+ */
+int lept_parse_prefix(lept_value *v, const char *json, size_t len, size_t *consumed);
+
+/**
+ * 原地解析：在 buf 中就地解码字符串并以 '\0' 结尾，结果中的字符串和对象键直接指向 buf，
+ * 省去逐个字符串的内存分配和复制。buf 必须可写，且在 v 释放之前保持有效；
+ * 解析后（包括失败时）buf 的内容不再是原来的 JSON 文本
+ *
+ * @param v     根节点指针
+ * @param buf   可写的 JSON 文本
+ * @param len   JSON 文本长度
+ * @return
+ */
+int lept_parse_insitu(lept_value *v, char *buf, size_t len);
+
+/**
+ * 按选项解析长度为 len 的 JSON
+ *
+ * @param v     根节点指针
+ * @param json  JSON 文本
+ * @param len   JSON 文本长度
+ * @param opts  解析选项，NULL 时与 lept_parse_n 相同
+ * @return
+ */
+int lept_parse_opts(lept_value *v, const char *json, size_t len, const lept_parse_options *opts);
+
+/**
+ * 只校验长度为 len 的 JSON，不构建 lept_value、不解码字符串，也不分配内存（嵌套超过 1023 层时除外）
+ *
+ * @param json  JSON 文本
+ * @param len   JSON 文本长度
+ * @return 与 lept_parse_n 相同的错误码
+ */
+int lept_validate(const char *json, size_t len);
+
+/**
+ * 按 JSON Pointer（RFC 6901）选择性解析：只构建各路径选中的子树及路径经过的数组和对象，
+ * 其余部分只校验、不解码。记号 "*" 匹配任何成员或元素（如路径 /items 后接一段 "*" 选中 items 的所有元素）。
+ * 未选中的数组元素在选中的元素之前时以 null 占位，因此按同一路径在结果中取值与在完整解析的结果中相同。
+ * 错误码与 lept_parse_n 相同
+ *
+ * @param v         根节点指针
+ * @param json      JSON 文本
+ * @param len       JSON 文本长度
+ * @param pointers  路径，"" 表示整个文档，其余须以 '/' 开头
+ * @param n         路径数，为 0 时只校验，结果为 null
+ * @return
+ */
+int lept_parse_select(lept_value *v, const char *json, size_t len, const char **pointers, size_t n);
+
+/* 只读映射的文件内容，不以 '\0' 结尾 */
+typedef struct {
+    const char *json;
+    size_t len;
+    int mapped;         /* 内部使用：1 为 mmap 映射，0 为读入堆上的缓冲区（管道等无法映射的文件，或不支持 mmap 的平台） */
+} lept_file;
+
+/**
+ * 只读映射文件（提示内核顺序访问），不复制到堆上。内容可直接交给 lept_parse_opts 等按长度解析的函数，
+ * 配合 LEPT_PARSE_OPT_BORROW 或 LEPT_PARSE_OPT_LAZY 时结果引用映射，须在结果释放或 lept_detach 之后才能 lept_file_close
+ *
+ * @param f
+ * @param path
+ * @return LEPT_PARSE_OK 或 LEPT_PARSE_IO_ERROR
+ */
+int lept_file_open(lept_file *f, const char *path);
+
+/**
+ * 解除映射（或释放缓冲区）
+ *
+ * @param f
+ */
+void lept_file_close(lept_file *f);
+
+/**
+ * 映射并按选项解析文件，不先读入堆上的缓冲区。映射在返回前解除，因此忽略
+ * LEPT_PARSE_OPT_BORROW 和 LEPT_PARSE_OPT_LAZY，结果总是自有内存；需要引用映射时使用 lept_file_open
+ *
+ * @param v     根节点指针
+ * @param path  文件路径
+ * @param opts  解析选项，可为 NULL
+ * @return 文件无法打开、映射或读取时返回 LEPT_PARSE_IO_ERROR，否则与 lept_parse_opts 相同
+ */
+int lept_parse_file(lept_value *v, const char *path, const lept_parse_options *opts);
+
+/* SAX 事件处理函数的返回值 */
+#define LEPT_SAX_CONTINUE   0   /* 继续解析 */
+#define LEPT_SAX_SKIP       1   /* 仅用于 on_start_object/on_start_array：跳过（仍校验）其内容，随后直接产生 size 为 0 的结束事件 */
+#define LEPT_SAX_ABORT      2   /* 中止解析，lept_parse_sax 返回 LEPT_PARSE_ABORTED */
+
+/*
+ * SAX 事件处理函数，不需要的事件可设为 NULL。字符串和键不以 '\0' 结尾，只在回调期间有效；
+ * on_number 的参数为临时的 number 值，可用 lept_get_number、lept_is_integer、lept_get_int64 等读取
+ */
+typedef struct {
+    int (*on_null)(void *ctx);
+    int (*on_bool)(void *ctx, int b);
+    int (*on_number)(void *ctx, const lept_value *n);
+    int (*on_string)(void *ctx, const char *s, size_t len);
+    int (*on_key)(void *ctx, const char *k, size_t len);
+    int (*on_start_object)(void *ctx);
+    int (*on_end_object)(void *ctx, size_t size);
+    int (*on_start_array)(void *ctx);
+    int (*on_end_array)(void *ctx, size_t size);
+} lept_sax_handler;
+
+/**
+ * 以事件方式解析长度为 len 的 JSON，按文本顺序调用 handler，不构建 lept_value（lept_parse 系列即以此构建）。
+ * 出错时已产生的事件不会撤销
+ *
+ * @param json      JSON 文本
+ * @param len       JSON 文本长度
+ * @param handler   事件处理函数
+ * @param ctx       传给各处理函数的参数
+ * @param opts      解析选项（只用到 max_depth 和 LEPT_PARSE_OPT_VALIDATE_UTF8），可为 NULL
+ * @return
+ */
+int lept_parse_sax(const char *json, size_t len, const lept_sax_handler *handler, void *ctx,
+                   const lept_parse_options *opts);
+
+/* 拉取式读取得到的记号 */
+typedef enum {
+    LEPT_READ_ERROR = -1,   /* 出错，错误码见 lept_reader_error */
+    LEPT_READ_EOF,          /* 根值已读完且其后只有空白 */
+    LEPT_READ_NULL,
+    LEPT_READ_FALSE,
+    LEPT_READ_TRUE,
+    LEPT_READ_NUMBER,
+    LEPT_READ_STRING,
+    LEPT_READ_KEY,          /* 对象成员的键（其后的冒号已检查） */
+    LEPT_READ_START_ARRAY,
+    LEPT_READ_END_ARRAY,
+    LEPT_READ_START_OBJECT,
+    LEPT_READ_END_OBJECT
+} lept_read_token;
+
+/*
+ * 拉取式读取器：逐个读取记号，只校验不构建 lept_value，字符串按需解码。
+ * 成员供内部使用，请通过 lept_reader_* 函数访问
+ */
+typedef struct {
+    const char *json, *end;     /* 当前位置与输入末尾 */
+    char *stack;                /* 各层未结束容器的右括号（每层一个字节），其上为解码字符串的缓冲区 */
+    size_t size, top;
+    int state;
+    int error;                  /* LEPT_PARSE_* */
+    const char *span;           /* 当前记号的源文本，字符串和键不含引号 */
+    size_t len;
+    int escaped;                /* 当前字符串或键含有转义 */
+    lept_value number;          /* 当前 number 的值 */
+} lept_reader;
+
+/**
+ * 初始化读取器，输入须在读取完毕之前保持有效
+ *
+ * @param r
+ * @param json  JSON 文本
+ * @param len   JSON 文本长度
+ */
+void lept_reader_init(lept_reader *r, const char *json, size_t len);
+
+/**
+ * 释放读取器的内存
+ *
+ * @param r
+ */
+void lept_reader_free(lept_reader *r);
+
+/**
+ * 读取下一个记号。错误码与 lept_parse_n 相同，出错后一直返回 LEPT_READ_ERROR
+ *
+ * @param r
+ * @return
+ */
+lept_read_token lept_reader_next(lept_reader *r);
+
+/**
+ * 跳过（仍校验）一个容器：刚读到 START_ARRAY/START_OBJECT 时跳过该容器，否则跳过当前所在容器的剩余部分；
+ * 都包括结束括号，之后不再读到对应的 END_ARRAY/END_OBJECT。跳过的字符串不解码
+ *
+ * @param r
+ * @return LEPT_PARSE_OK 或错误码
+ */
+int lept_reader_skip(lept_reader *r);
+
+/**
+ * 出错时的错误码，未出错时为 LEPT_PARSE_OK
+ *
+ * @param r
+ * @return
+ */
+int lept_reader_error(const lept_reader *r);
+
+/**
+ * 当前记号的源文本：字符串和键不含引号且未解码，数组和对象为括号
+ *
+ * @param r
+ * @param len
+ * @return
+ */
+const char *lept_reader_get_span(const lept_reader *r, size_t *len);
+
+/**
+ * 解码当前的字符串或键。不含转义时直接指向输入，否则指向读取器内部的缓冲区，
+ * 都不以 '\0' 结尾，只在下一次调用 lept_reader_next 或 lept_reader_skip 之前有效
+ *
+ * @param r
+ * @param len
+ * @return
+ */
+const char *lept_reader_get_string(lept_reader *r, size_t *len);
+
+/**
+ * 当前 number 的值，可用 lept_get_number、lept_is_integer、lept_get_int64 等读取
+ *
+ * @param r
+ * @return
+ */
+const lept_value *lept_reader_get_number(const lept_reader *r);
+
+/*
+ * 增量解析器：输入可分多块到达，每块解析到末尾（可能在字符串、数字、转义或字面值中间）暂停，
+ * 下一块从暂停处继续，已读过的字节不再扫描。结果及错误码与对完整输入调用 lept_parse_n 相同。
+ * 成员供内部使用，请通过 lept_parser_* 函数访问
+ */
+typedef struct {
+    char *stack;                /* 各层未结束容器的右括号（每层一个字节），其上为跨块的字符串或数字 */
+    size_t size, top;
+    char *values;               /* 构建中的数组元素和对象成员 */
+    size_t vsize, vtop;
+    size_t frame;
+    size_t max_depth;
+    size_t head;                /* 跨块的字符串或数字在 stack 中的起始位置 */
+    int state;
+    int error;                  /* 出错后保持不变 */
+    int key;                    /* 当前字符串是对象成员的键 */
+    int literal;                /* 当前字面值的类型及已匹配的字符数 */
+    size_t matched;
+    char esc[12];               /* 跨块的转义序列（从反斜杠起，至多两个 \uXXXX） */
+    size_t nesc;
+    lept_value v;               /* 完成的根值 */
+} lept_parser;
+
+/**
+ * 初始化增量解析器
+ *
+ * @param p
+ * @param opts  解析选项（只用到 max_depth），可为 NULL
+ */
+void lept_parser_init(lept_parser *p, const lept_parse_options *opts);
+
+/**
+ * 输入一块 JSON 文本。块在调用返回后即可释放，字符串都复制到结果中
+ *
+ * @param p
+ * @param chunk
+ * @param len
+ * @return LEPT_PARSE_OK 或错误码，出错后不再解析，之后的调用都返回同一错误码
+ */
+int lept_parser_feed(lept_parser *p, const char *chunk, size_t len);
+
+/**
+ * 输入结束：取出解析结果并释放解析器的内存，之后不能再调用 lept_parser_feed
+ *
+ * @param p
+ * @param v     成功时为解析结果，否则为 null
+ * @return
+ */
+int lept_parser_finish(lept_parser *p, lept_value *v);
+
+/**
+ * 放弃解析并释放解析器的内存（lept_parser_finish 之后无需调用）
+ *
+ * @param p
+ */
+void lept_parser_free(lept_parser *p);
+
+/*
+ * lept_parse_ndjson 的回调：offset 为记录在输入中的偏移，error 为其解析结果（LEPT_PARSE_*），出错时 v 为 null。
+ * v 在回调返回后释放，需要保留时用 lept_move 取走。返回非 0 时中止解析
+ */
+typedef int (*lept_ndjson_callback)(void *ctx, size_t offset, int error, lept_value *v);
+
+/**
+ * 并行解析 NDJSON（JSON Lines）：每行一个 JSON 值，只有空白的行忽略。输入按行切分成块，
+ * 由 nthreads 个线程（包括调用线程）解析，每条记录调用一次 callback。
+ * 默认按记录顺序依次调用；opts 含 LEPT_PARSE_OPT_UNORDERED 时解析完即调用，回调须线程安全
+ *
+ * @param json      NDJSON 文本
+ * @param len       文本长度
+ * @param nthreads  线程数，0 表示 CPU 核数
+ * @param opts      各记录的解析选项，可为 NULL
+ * @param callback
+ * @param ctx       传给 callback 的参数
+ * @return LEPT_PARSE_OK，或回调中止时返回 LEPT_PARSE_ABORTED；各记录的错误交给回调
+ */
+int lept_parse_ndjson(const char *json, size_t len, size_t nthreads, const lept_parse_options *opts,
+                      lept_ndjson_callback callback, void *ctx);
+
+/**
+ * 两阶段解析：先向量化扫描整个输入建立结构字符索引，再按索引构建 lept_value，
+ * 适合较大的文档。结果（包括错误码）与 lept_parse_n 完全一致
+ *
+ * @param v     根节点指针
+ * @param json  JSON 文本
+ * @param len   JSON 文本长度
+ * @return
+ */
+int lept_parse_indexed(lept_value *v, const char *json, size_t len);
+
+/**
+ * 设置解析扫描使用的指令集级别（主要用于测试），超出 CPU 支持范围时降到所支持的最高级别，
+ * 不合法的级别按 LEPT_SIMD_AUTO 处理。默认在首次解析时按 CPU 自动选择（多个线程同时首次解析是安全的），
+ * 也可用环境变量 LEPT_SIMD=scalar|sse2|avx2 指定。与解析并发调用不是线程安全的，应在开始解析前调用
+ *
+ * @param level
+ * @return 实际使用的级别
+ */
+lept_simd_level lept_set_simd_level(lept_simd_level level);
+
+/**
+ * 获取当前使用的指令集级别
+ *
+ * @return
+ */
+lept_simd_level lept_get_simd_level(void);
+
 /**
  *
  * @param v
@@ -142,6 +598,122 @@ int lept_parse(lept_value *v, const char *json);
  */
 char *lept_stringify(const lept_value *v, size_t *length);
 
+/*
+ * 可重用的工作区：保留解析和序列化时增长的缓冲区供之后的调用继续使用，稳定状态下不再为此分配内存
+ * （结果本身仍需分配）。同一工作区不能在多个线程中同时使用，可以每个线程一个（如 thread-local）。
+ * 成员供内部使用
+ */
+typedef struct {
+    char *stack;        /* 解析的堆栈 */
+    size_t ssize;
+    char *values;       /* 构建 lept_value 的堆栈 */
+    size_t vsize;
+    char *out;          /* 序列化的结果 */
+    size_t osize;
+    size_t cap;         /* 每个缓冲区在调用之间保留的最大字节数，0 表示不限制 */
+} lept_workspace;
+
+/**
+ * 初始化工作区
+ *
+ * @param w
+ * @param cap   每个缓冲区在调用之间保留的最大字节数，超过时在调用结束后释放；0 表示不限制
+ */
+void lept_workspace_init(lept_workspace *w, size_t cap);
+
+/**
+ * 与 lept_parse_opts 相同，但使用并保留工作区的堆栈
+ *
+ * @param w
+ * @param v
+ * @param json
+ * @param len
+ * @param opts  可为 NULL
+ * @return
+ */
+int lept_workspace_parse(lept_workspace *w, lept_value *v, const char *json, size_t len, const lept_parse_options *opts);
+
+/**
+ * 与 lept_stringify 相同，但结果写在工作区的缓冲区中，不须释放，
+ * 只在下一次调用 lept_workspace_stringify、lept_workspace_trim 或 lept_workspace_free 之前有效
+ *
+ * @param w
+ * @param v
+ * @param length
+ * @return
+ */
+const char *lept_workspace_stringify(lept_workspace *w, const lept_value *v, size_t *length);
+
+/**
+ * 释放大于 keep 字节的缓冲区，工作区仍可继续使用
+ *
+ * @param w
+ * @param keep
+ */
+void lept_workspace_trim(lept_workspace *w, size_t keep);
+
+/**
+ * 释放工作区的所有缓冲区
+ *
+ * @param w
+ */
+void lept_workspace_free(lept_workspace *w);
+
+/* lept_document 的区块，成员供内部使用 */
+typedef struct lept_chunk lept_chunk;
+
+/*
+ * 文档：解析结果中的字符串、对象键以及数组和对象的元素（成员）数组都从文档的区块中顺序分配，
+ * 不再逐个 malloc；lept_document_reset 或 lept_document_free 时整块释放。适合按请求解析、
+ * 用完即丢弃的 JSON。区块在 reset 后保留，下一次解析重用同一块内存。
+ * 文档中的值可以照常读取和修改：区块中的内存带有 LEPT_FLAG_BORROWED，lept_free 不释放；
+ * 修改时新的字符串和扩大的数组改在堆上分配，reset 和 free 时一并释放。
+ * lept_detach 或 lept_copy 得到的值不再依赖文档。同一文档不能在多个线程中同时使用。
+ * 成员除 root 外供内部使用
+ */
+typedef struct {
+    lept_value root;        /* 解析结果 */
+    lept_chunk *chunks;     /* 所有区块，按分配的顺序 */
+    lept_chunk *current;    /* 正在分配的区块，之后的区块在 reset 后留待重用 */
+    char *top, *end;        /* 当前区块中空闲的部分 */
+    size_t chunk_size;      /* 新区块的最小字节数 */
+    lept_workspace w;       /* 解析的堆栈 */
+} lept_document;
+
+/**
+ * 初始化文档，root 为 null
+ *
+ * @param d
+ * @param chunk_size    新区块的最小字节数，0 表示使用默认值（64 KiB）；之后的区块依次加倍
+ */
+void lept_document_init(lept_document *d, size_t chunk_size);
+
+/**
+ * 先清空文档（lept_document_reset），再把 JSON 解析到 root。
+ * 不使用 LEPT_PARSE_OPT_INTERN_KEYS、LEPT_PARSE_OPT_SHAPES 以及 nthreads
+ *
+ * @param d
+ * @param json
+ * @param len
+ * @param opts  可为 NULL
+ * @return      出错时 root 为 null
+ */
+int lept_document_parse(lept_document *d, const char *json, size_t len, const lept_parse_options *opts);
+
+/**
+ * 清空文档：释放 root 以及修改时在堆上分配的内存，区块留待重用
+ *
+ * @param d
+ */
+void lept_document_reset(lept_document *d);
+
+/**
+ * 释放文档的所有内存
+ *
+ * @param d
+ */
+void lept_document_free(lept_document *d);
+
 /**
  * 获取 JSON 类型（包括 null、true、false）
  *
@@ -182,6 +754,46 @@ double lept_get_number(const lept_value *v);
  */
 void lept_set_number(lept_value *v, double n);
 
+/**
+ * number 是否以 64 位整数精确保存（解析时不含小数和指数且不超出 int64_t/uint64_t 范围）
+ *
+ * @param v
+ * @return
+ */
+int lept_is_integer(const lept_value *v);
+
+/**
+ * 获取 JSON 值 number 的 int64_t 表示（以 double 保存时截断取整），超出范围时取 INT64_MIN 或 INT64_MAX，NaN 为 0
+ *
+ * @param v
+ * @return
+ */
+int64_t lept_get_int64(const lept_value *v);
+
+/**
+ * 设置 JSON 值 number 为 64 位有符号整数
+ *
+ * @param v
+ * @param i
+ */
+void lept_set_int64(lept_value *v, int64_t i);
+
+/**
+ * 获取 JSON 值 number 的 uint64_t 表示（以 double 保存时截断取整），负数为 0，超出范围时取 UINT64_MAX
+ *
+ * @param v
+ * @return
+ */
+uint64_t lept_get_uint64(const lept_value *v);
+
+/**
+ * 设置 JSON 值 number 为 64 位无符号整数
+ *
+ * @param v
+ * @param u
+ */
+void lept_set_uint64(lept_value *v, uint64_t u);
+
 /**
  * 释放内存
  *
@@ -190,7 +802,22 @@ void lept_set_number(lept_value *v, double n);
 void lept_free(lept_value *v);
 
 /**
- * 获取 JSON 值 string
+ * 值（包括子节点和对象键）是否引用了外部缓冲区（LEPT_PARSE_OPT_BORROW、LEPT_PARSE_OPT_LAZY 或原地解析的结果）
+ *
+ * @param v
+ * @return
+ */
+int lept_is_borrowed(const lept_value *v);
+
+/**
+ * 把引用外部缓冲区的字符串和对象键复制为自有内存（延迟解析的部分全部展开），之后即可释放原缓冲区
+ *
+ * @param v
+ */
+void lept_detach(lept_value *v);
+
+/**
+ * 获取 JSON 值 string，LEPT_PARSE_OPT_BORROW 解析得到的引用不以 '\0' 结尾
  *
  * @param v
  * @return
@@ -372,7 +999,7 @@ lept_value* lept_set_object_value(lept_value* v, const char* key, size_t klen);
 void lept_remove_object_value(lept_value* v, size_t index);
 
 /**
- *
+ * 深复制；共享的对象键和形状只增加引用计数
  * @param dst
  * @param src
  */
@@ -3,8 +3,9 @@
 #include <crtdbg.h> /* Windows 下检测内存泄漏 */
 #endif
 
+#include <locale.h>  /* setlocale() */
 #include <stdio.h>
-#include <stdlib.h>  /* NULL, malloc(), realloc(), free() */
+#include <stdlib.h>  /* NULL, malloc(), realloc(), free(), strtod() */
 #include <string.h>  /* memcmp */
 #include "leptjson.h"
 
@@ -38,6 +39,12 @@ static int test_pass = 0;
 #define EXPECT_EQ_STRING(expect, actual, alength) \
     EXPECT_EQ_BASE(sizeof(expect) - 1 == alength && memcmp(expect, actual, alength) == 0, expect, actual, "%s")
 
+#define EXPECT_EQ_INT64(expect, actual) \
+    EXPECT_EQ_BASE((expect) == (actual), (long long) (expect), (long long) (actual), "%lld")
+
+#define EXPECT_EQ_UINT64(expect, actual) \
+    EXPECT_EQ_BASE((expect) == (actual), (unsigned long long) (expect), (unsigned long long) (actual), "%llu")
+
 #define EXPECT_TRUE(actual) EXPECT_EQ_BASE((actual) != 0, "true", "false", "%s")
 
 #define EXPECT_FALSE(actual) EXPECT_EQ_BASE((actual) == 0, "false", "true", "%s")
@@ -209,6 +216,133 @@ static void test_parse_number() {
     TEST_NUMBER(-2.2250738585072014e-308, "-2.2250738585072014e-308");
     TEST_NUMBER(1.7976931348623157e+308, "1.7976931348623157e+308");  /* Max double */
     TEST_NUMBER(-1.7976931348623157e+308, "-1.7976931348623157e+308");
+
+    /* 需要正确舍入的边界情况 */
+    TEST_NUMBER(9007199254740992.0, "9007199254740993");    /* 2^53 + 1，恰好一半时舍入到偶数 */
+    TEST_NUMBER(9007199254740996.0, "9007199254740995");
+    TEST_NUMBER(1e23, "1e23");
+    TEST_NUMBER(1e23, "100000000000000000000000");
+    TEST_NUMBER(8.98846567431158e307, "8.98846567431158e307");
+    TEST_NUMBER(2.2250738585072011e-308, "2.2250738585072011e-308");
+    TEST_NUMBER(0.0, "2.4703282292062327e-324");            /* 小于最小非规格化数的一半 */
+    TEST_NUMBER(4.9406564584124654e-324, "2.4703282292062328e-324");
+    TEST_NUMBER(0.1, "0.1000000000000000055511151231257827021181583404541015625");
+    TEST_NUMBER(0.30000000000000004, "0.3000000000000000444089209850062616169452667236328125");
+    TEST_NUMBER(123456789012345680000.0, "123456789012345678901.234567890123456789");
+    TEST_NUMBER(1.0, "1.00000000000000011102230246251565404236316680908203125");  /* 1 与下一个数的正中间 */
+    TEST_NUMBER(1.0000000000000002, "1.00000000000000011102230246251565404236316680908203126");
+    TEST_NUMBER(0.0, "0e1000000000000");
+    TEST_NUMBER(1.0, "0.000000000000000000000000000000000000000000000000001e51");
+}
+
+/* 与 strtod() 的结果逐位比较 */
+#define TEST_NUMBER_EXACT(json)\
+    do {\
+        lept_value v;\
+        double expect = strtod(json, NULL), actual;\
+        lept_init(&v);\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));\
+        actual = lept_get_number(&v);\
+        EXPECT_EQ_BASE(memcmp(&expect, &actual, sizeof(double)) == 0, expect, actual, "%.17g");\
+        lept_free(&v);\
+    } while(0)
+
+static void test_parse_number_exact() {
+    /* 固定种子的线性同余生成器，生成各种位数和指数的数字 */
+    unsigned long seed = 12345;
+    char json[128];
+    int i, j, n, ndigits;
+    for (i = 0; i < 20000; i++) {
+        n = 0;
+        seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF;
+        ndigits = 1 + (int) (seed % 40);
+        json[n++] = (char) ('1' + seed % 9);
+        for (j = 1; j < ndigits; j++) {
+            seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF;
+            if (j == ndigits / 2 && seed % 2)
+                json[n++] = '.';
+            json[n++] = (char) ('0' + (seed >> 8) % 10);
+        }
+        sprintf(json + n, "e%d", (int) ((seed >> 12) % 620) - 310 - ndigits);  /* 不超过 double 的范围 */
+        TEST_NUMBER_EXACT(json);
+    }
+}
+
+#define TEST_INT64(expect, json)\
+    do {\
+        lept_value v;\
+        lept_init(&v);\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));\
+        EXPECT_EQ_INT(LEPT_NUMBER, lept_get_type(&v));\
+        EXPECT_TRUE(lept_is_integer(&v));\
+        EXPECT_EQ_INT64(expect, lept_get_int64(&v));\
+        lept_free(&v);\
+    } while(0)
+
+static void test_parse_integer() {
+    lept_value v;
+    TEST_INT64(0, "0");
+    TEST_INT64(1, "1");
+    TEST_INT64(-1, "-1");
+    TEST_INT64(1234567890123LL, "1234567890123");
+    TEST_INT64(9007199254740993LL, "9007199254740993");   /* 2^53 + 1，double 无法精确表示 */
+    TEST_INT64(INT64_MAX, "9223372036854775807");
+    TEST_INT64(INT64_MIN, "-9223372036854775808");
+
+    /* 大于 INT64_MAX 的正整数按 uint64_t 保存 */
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "18446744073709551615"));
+    EXPECT_TRUE(lept_is_integer(&v));
+    EXPECT_EQ_UINT64(UINT64_MAX, lept_get_uint64(&v));
+    EXPECT_EQ_DOUBLE(18446744073709551615.0, lept_get_number(&v));
+    lept_free(&v);
+
+    /* 超出范围、含小数或指数、以及 -0 仍按 double 保存 */
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "18446744073709551616"));
+    EXPECT_FALSE(lept_is_integer(&v));
+    EXPECT_EQ_DOUBLE(18446744073709551616.0, lept_get_number(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "-9223372036854775809"));
+    EXPECT_FALSE(lept_is_integer(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "100000000000000000000"));
+    EXPECT_FALSE(lept_is_integer(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "1.0"));
+    EXPECT_FALSE(lept_is_integer(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "1e2"));
+    EXPECT_FALSE(lept_is_integer(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "-0"));
+    EXPECT_FALSE(lept_is_integer(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "[0]"));
+    EXPECT_TRUE(lept_is_integer(lept_get_array_element(&v, 0)));
+    lept_free(&v);
+
+    /* 转换为整数时超出范围的取最接近的值 */
+    lept_set_number(&v, 1e300);
+    EXPECT_EQ_INT64(INT64_MAX, lept_get_int64(&v));
+    EXPECT_EQ_UINT64(UINT64_MAX, lept_get_uint64(&v));
+    lept_set_number(&v, -1e300);
+    EXPECT_EQ_INT64(INT64_MIN, lept_get_int64(&v));
+    EXPECT_EQ_UINT64(0, lept_get_uint64(&v));
+    lept_set_number(&v, -0.5);
+    EXPECT_EQ_INT64(0, lept_get_int64(&v));
+    EXPECT_EQ_UINT64(0, lept_get_uint64(&v));
+    lept_set_number(&v, 0.0 / 0.0);
+    EXPECT_EQ_INT64(0, lept_get_int64(&v));
+    EXPECT_EQ_UINT64(0, lept_get_uint64(&v));
+    lept_set_int64(&v, -1);
+    EXPECT_EQ_UINT64(0, lept_get_uint64(&v));
+    lept_set_uint64(&v, UINT64_MAX);
+    EXPECT_EQ_INT64(INT64_MAX, lept_get_int64(&v));
+    lept_free(&v);
+}
+
+static void test_parse_number_locale() {
+    /* 小数点为 ',' 的区域设置下解析结果不变；系统没有该区域设置时跳过 */
+    if (setlocale(LC_NUMERIC, "de_DE.UTF-8") != NULL || setlocale(LC_NUMERIC, "de_DE") != NULL) {
+        TEST_NUMBER(1.5, "1.5");
+        TEST_NUMBER(-3.1416, "-3.1416");
+        setlocale(LC_NUMERIC, "C");
+    }
 }
 
 
@@ -388,6 +522,61 @@ static void test_parse_invalid_unicode_surrogate() {
     TEST_ERROR(LEPT_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD800\\uE000\"");
 }
 
+/* 逐个码点检查 \u 转义的解码（包括大小写十六进制数字及代理对） */
+static void test_parse_unicode_escape() {
+    char json[32], expect[4];
+    size_t i, n;
+    unsigned u;
+    lept_value v;
+    for (i = 0; i < 4; i++) {
+        for (u = 0; u < 256; u++) {
+            int hex = u != 0 && strchr("0123456789abcdefABCDEF", (int) u) != NULL;
+            memcpy(json, "\"\\u0000\"", 8);
+            json[3 + i] = (char) u;
+            lept_init(&v);
+            EXPECT_EQ_INT(hex ? LEPT_PARSE_OK : LEPT_PARSE_INVALID_UNICODE_HEX, lept_parse_n(&v, json, 8));
+            lept_free(&v);
+        }
+    }
+    for (u = 0; u <= 0x10FFFF; u++) {
+        /* 代理对：只检查高、低代理项之一取边界值的组合 */
+        if (u >= 0xD800 && u <= 0xDFFF)
+            continue;
+        if (u > 0xFFFF && (u & 0x3FF) != 0 && (u & 0x3FF) != 0x3FF && ((u - 0x10000) >> 10) != 0 &&
+            ((u - 0x10000) >> 10) != 0x3FF)
+            continue;
+        if (u <= 0x7F) {
+            expect[0] = (char) u;
+            n = 1;
+        } else if (u <= 0x7FF) {
+            expect[0] = (char) (0xC0 | (u >> 6));
+            expect[1] = (char) (0x80 | (u & 0x3F));
+            n = 2;
+        } else if (u <= 0xFFFF) {
+            expect[0] = (char) (0xE0 | (u >> 12));
+            expect[1] = (char) (0x80 | ((u >> 6) & 0x3F));
+            expect[2] = (char) (0x80 | (u & 0x3F));
+            n = 3;
+        } else {
+            expect[0] = (char) (0xF0 | (u >> 18));
+            expect[1] = (char) (0x80 | ((u >> 12) & 0x3F));
+            expect[2] = (char) (0x80 | ((u >> 6) & 0x3F));
+            expect[3] = (char) (0x80 | (u & 0x3F));
+            n = 4;
+        }
+        if (u <= 0xFFFF)
+            sprintf(json, u % 2 ? "\"\\u%04X\"" : "\"\\u%04x\"", u);
+        else
+            sprintf(json, u % 2 ? "\"\\u%04X\\u%04X\"" : "\"\\u%04x\\u%04x\"",
+                    0xD800 + ((u - 0x10000) >> 10), 0xDC00 + ((u - 0x10000) & 0x3FF));
+        lept_init(&v);
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));
+        EXPECT_EQ_SIZE_T(n, lept_get_string_length(&v));
+        EXPECT_TRUE(memcmp(expect, lept_get_string(&v), n) == 0);
+        lept_free(&v);
+    }
+}
+
 static void test_parse_miss_comma_or_square_bracket() {
     TEST_ERROR(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[1");
     TEST_ERROR(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[1}");
@@ -439,6 +628,13 @@ static void test_stringify_number() {
     TEST_ROUNDTRIP("-2.2250738585072014e-308");
     TEST_ROUNDTRIP("1.7976931348623157e+308");  /* Max double */
     TEST_ROUNDTRIP("-1.7976931348623157e+308");
+
+    TEST_ROUNDTRIP("9007199254740993");
+    TEST_ROUNDTRIP("-1234567890123456789");
+    TEST_ROUNDTRIP("9223372036854775807");
+    TEST_ROUNDTRIP("-9223372036854775808");
+    TEST_ROUNDTRIP("18446744073709551615");
+    TEST_ROUNDTRIP("[10,-99,100,4294967296]");
 }
 
 static void test_stringify_string() {
@@ -488,6 +684,24 @@ static void test_access_number() {
     lept_free(&v);
 }
 
+static void test_access_integer() {
+    lept_value v;
+    lept_init(&v);
+    lept_set_string(&v, "a", 1);
+    lept_set_int64(&v, -9007199254740993LL);
+    EXPECT_TRUE(lept_is_integer(&v));
+    EXPECT_EQ_INT64(-9007199254740993LL, lept_get_int64(&v));
+    lept_set_uint64(&v, UINT64_MAX);
+    EXPECT_EQ_UINT64(UINT64_MAX, lept_get_uint64(&v));
+    lept_set_uint64(&v, 42);
+    EXPECT_EQ_INT64(42, lept_get_int64(&v));
+    EXPECT_EQ_DOUBLE(42.0, lept_get_number(&v));
+    lept_set_number(&v, 42.0);
+    EXPECT_FALSE(lept_is_integer(&v));
+    EXPECT_EQ_INT64(42, lept_get_int64(&v));
+    lept_free(&v);
+}
+
 static void test_access_string() {
     lept_value v;
     lept_init(&v);
@@ -498,11 +712,1590 @@ static void test_access_string() {
     lept_free(&v);
 }
 
+static void test_parse_n() {
+    lept_value v;
+    size_t consumed;
+    /* 不以 '\0' 结尾的输入 */
+    static const char num[] = {'1', '2', '3'};
+    static const char str[] = {'"', 'a', 'b', 'c', '"'};
+    static const char lit[] = {'t', 'r', 'u', 'e'};
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, num, 2));
+    EXPECT_EQ_DOUBLE(12.0, lept_get_number(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, str, sizeof(str)));
+    EXPECT_EQ_STRING("abc", lept_get_string(&v), lept_get_string_length(&v));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_QUOTATION_MARK, lept_parse_n(&v, str, sizeof(str) - 1));
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_VALUE, lept_parse_n(&v, lit, sizeof(lit) - 1));
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_VALUE, lept_parse_n(&v, "1.5", 2));
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_VALUE, lept_parse_n(&v, "1e5", 2));
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_UNICODE_HEX, lept_parse_n(&v, "\"\\u0041\"", 6));
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_UNICODE_SURROGATE, lept_parse_n(&v, "\"\\uD834\\uDD1E\"", 8));
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lept_parse_n(&v, "[1,2]", 4));
+    EXPECT_EQ_INT(LEPT_PARSE_EXPECT_VALUE, lept_parse_n(&v, NULL, 0));
+
+    /* '\0' 按普通字符处理 */
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_STRING_CHAR, lept_parse_n(&v, "\"a\0b\"", 5));
+    EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, lept_parse_n(&v, "null\0", 5));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, lept_parse_n(&v, "[1] [2]", 7));
+
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_prefix(&v, "[1] [2]", 7, &consumed));
+    EXPECT_EQ_SIZE_T(4, consumed);
+    EXPECT_EQ_SIZE_T(1, lept_get_array_size(&v));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_prefix(&v, "[1] [2]" + 4, 3, &consumed));
+    EXPECT_EQ_SIZE_T(3, consumed);
+    EXPECT_EQ_DOUBLE(2.0, lept_get_number(lept_get_array_element(&v, 0)));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_prefix(&v, "{\"a\":1}\n{", 9, &consumed));
+    EXPECT_EQ_SIZE_T(8, consumed);
+    lept_free(&v);
+}
+
+static void test_parse_whitespace() {
+    static const char ws[] = " \t\n\r";
+    char json[512];
+    lept_value v;
+    size_t i, n;
+    int level;
+    for (level = LEPT_SIMD_SCALAR; level <= LEPT_SIMD_AVX2; level++) {
+        lept_set_simd_level((lept_simd_level) level);
+        /* 覆盖向量宽度边界附近的各种空白长度 */
+        for (n = 0; n < 100; n++) {
+            char *p = json;
+            for (i = 0; i < n; i++)
+                *p++ = ws[i % 4];
+            memcpy(p, "[1,", 3);
+            p += 3;
+            for (i = 0; i < n; i++)
+                *p++ = ws[(i + 1) % 4];
+            memcpy(p, "true]", 5);
+            p += 5;
+            for (i = 0; i < n; i++)
+                *p++ = ws[(i + 2) % 4];
+            lept_init(&v);
+            EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, json, p - json));
+            EXPECT_EQ_SIZE_T(2, lept_get_array_size(&v));
+            EXPECT_EQ_INT(LEPT_TRUE, lept_get_type(lept_get_array_element(&v, 1)));
+            lept_free(&v);
+            /* 空白之后紧跟非法字符 */
+            *p++ = 'x';
+            EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, lept_parse_n(&v, json, p - json));
+        }
+    }
+    level = lept_set_simd_level(LEPT_SIMD_AUTO);
+    /* 不合法的级别按自动选择处理 */
+    EXPECT_EQ_INT(level, lept_set_simd_level((lept_simd_level) 99));
+    EXPECT_EQ_INT(level, lept_set_simd_level((lept_simd_level) -5));
+    EXPECT_EQ_INT(level, lept_get_simd_level());
+}
+
+static void test_parse_long_string() {
+    char json[256], expect[256];
+    lept_value v;
+    size_t i, n;
+    int level;
+    for (level = LEPT_SIMD_SCALAR; level <= LEPT_SIMD_AVX2; level++) {
+        lept_set_simd_level((lept_simd_level) level);
+        /* 转义字符出现在向量宽度边界附近的各个位置 */
+        for (n = 0; n < 100; n++) {
+            char *p = json, *q = expect;
+            *p++ = '"';
+            for (i = 0; i < n; i++)
+                *p++ = *q++ = (char) (i % 2 ? 'a' + i % 26 : 0x80 + i);
+            memcpy(p, "\\n\\\"", 4);
+            p += 4;
+            *q++ = '\n';
+            *q++ = '"';
+            for (i = 0; i < 40; i++)
+                *p++ = *q++ = 'z';
+            *p++ = '"';
+            lept_init(&v);
+            EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, json, p - json));
+            EXPECT_EQ_SIZE_T((size_t) (q - expect), lept_get_string_length(&v));
+            EXPECT_TRUE(memcmp(expect, lept_get_string(&v), q - expect) == 0);
+            lept_free(&v);
+            /* 缺失结尾的引号 */
+            EXPECT_EQ_INT(LEPT_PARSE_MISS_QUOTATION_MARK, lept_parse_n(&v, json, p - json - 1));
+            /* 控制字符 */
+            json[n + 1] = '\x1F';
+            EXPECT_EQ_INT(LEPT_PARSE_INVALID_STRING_CHAR, lept_parse_n(&v, json, p - json));
+        }
+    }
+    lept_set_simd_level(LEPT_SIMD_AUTO);
+}
+
+/* 按 json 解析字符串，校验 UTF-8 时期望 expect，不校验时总是成功 */
+static void test_utf8_string(int expect, const char *json, size_t len) {
+    lept_parse_options opts = {LEPT_PARSE_OPT_VALIDATE_UTF8, 0, 0};
+    lept_value v1, v2;
+    lept_init(&v1);
+    lept_init(&v2);
+    EXPECT_EQ_INT(expect, lept_parse_opts(&v1, json, len, &opts));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v2, json, len));
+    if (expect == LEPT_PARSE_OK)
+        EXPECT_TRUE(lept_is_equal(&v1, &v2));
+    lept_free(&v1);
+    lept_free(&v2);
+}
+
+static void test_parse_utf8() {
+    static const char *valid[] = {
+        "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xE2\x82\xAC", "\xED\x9F\xBF", "\xEE\x80\x80", "\xEF\xBF\xBF",
+        "\xF0\x90\x80\x80", "\xF3\xBF\xBF\xBF", "\xF4\x8F\xBF\xBF", "\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80",
+    };
+    static const char *invalid[] = {
+        "\x80", "\xBF", "\xC0\x80", "\xC1\xBF", "\xC2", "\xC2\x41", "\xC2\xC2\x80", "\xE0\x80\x80", "\xE0\x9F\xBF",
+        "\xED\xA0\x80", "\xED\xBF\xBF", "\xE2\x82", "\xE2\x82\x41", "\xF0\x80\x80\x80", "\xF0\x8F\xBF\xBF",
+        "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xF0\x90\x80", "\xF8\x88\x80\x80\x80", "\xFE", "\xFF",
+        "\xC3\xA9\xA9", "\xE2\x82\xAC\x80",
+    };
+    static const lept_sax_handler none = {NULL};
+    lept_parse_options opts = {LEPT_PARSE_OPT_VALIDATE_UTF8, 0, 0};
+    lept_value v;
+    char json[256];
+    size_t i, n, m, len;
+    unsigned long seed = 12345;
+    int level;
+    for (level = LEPT_SIMD_SCALAR; level <= LEPT_SIMD_AVX2; level++) {
+        lept_set_simd_level((lept_simd_level) level);
+        /* 序列出现在向量宽度边界附近的各个位置，之前为 ASCII 或 3 字节的字符，之后紧跟引号、转义或更多内容 */
+        for (n = 0; n < 70; n++) {
+            for (i = 0; i < sizeof(valid) / sizeof(valid[0]) + sizeof(invalid) / sizeof(invalid[0]); i++) {
+                int ok = i < sizeof(valid) / sizeof(valid[0]);
+                const char *seq = ok ? valid[i] : invalid[i - sizeof(valid) / sizeof(valid[0])];
+                for (m = 0; m < 3; m++) {
+                    json[0] = '"';
+                    len = 1;
+                    if (n % 2) {
+                        memset(json + 1, 'a', n);
+                        len += n;
+                    } else {
+                        for (; len < n + 1; len += 3)
+                            memcpy(json + len, "\xE4\xB8\xAD", 3);
+                    }
+                    memcpy(json + len, seq, strlen(seq));
+                    len += strlen(seq);
+                    if (m == 1) {
+                        memcpy(json + len, "\\n", 2);
+                        len += 2;
+                    } else if (m == 2) {
+                        memset(json + len, 'z', 40);
+                        len += 40;
+                    }
+                    json[len++] = '"';
+                    test_utf8_string(ok ? LEPT_PARSE_OK : LEPT_PARSE_INVALID_UTF8, json, len);
+                }
+            }
+        }
+
+        /* 随机内容：各级别的结果相同 */
+        for (i = 0; i < 2000; i++) {
+            int expect;
+            json[0] = '"';
+            len = 1;
+            n = 1 + (seed >> 4) % 100;
+            for (m = 0; m < n; m++) {
+                static const unsigned char bytes[] = {'a', 'a', 'a', 'a', 0x80, 0x9F, 0xA0, 0xBF, 0xC2, 0xDF,
+                                                      0xE0, 0xE4, 0xED, 0xEF, 0xF0, 0xF4, 0xF5};
+                seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF;
+                json[len++] = (char) bytes[(seed >> 8) % sizeof(bytes)];
+            }
+            json[len++] = '"';
+            lept_set_simd_level(LEPT_SIMD_SCALAR);
+            lept_init(&v);
+            expect = lept_parse_opts(&v, json, len, &opts);
+            lept_free(&v);
+            lept_set_simd_level((lept_simd_level) level);
+            test_utf8_string(expect, json, len);
+        }
+    }
+    lept_set_simd_level(LEPT_SIMD_AUTO);
+
+    /* 对象键、延迟解析及 SAX 同样校验 */
+    opts.flags = LEPT_PARSE_OPT_VALIDATE_UTF8 | LEPT_PARSE_OPT_LAZY;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_UTF8, lept_parse_opts(&v, "{\"\xC0\xAF\":1}", 8, &opts));
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_UTF8, lept_parse_opts(&v, "[[\"\xED\xA0\x80\"]]", 9, &opts));
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_UTF8, lept_parse_sax("[\"\xFF\"]", 5, &none, NULL, &opts));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, "[[\"\xE2\x82\xAC\"]]", 9, &opts));
+    lept_free(&v);
+    /* 缺失结尾的引号时，截断的序列先被发现 */
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_UTF8, lept_parse_opts(&v, "\"\xE2\x82", 3, &opts));
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_QUOTATION_MARK, lept_parse_opts(&v, "\"\xE2\x82\xAC", 4, &opts));
+}
+
+/* 合法与不合法的各种输入，用于与 lept_parse_n 对比结果 */
+static const char *parse_cases[] = {
+    "", " ", "null", "true", "false", "nul", "?", "+0", ".123", "1.", "INF", "nan",
+    "[1,]", "[\"a\", nul]", "0", "-0", "1.5", "-1E-10", "1e-10000", "1e309", "-1e309",
+    "1.7976931348623157e+308", "4.9406564584124654e-324", "null x", "0123", "0x0", "0x123",
+    "\"\"", "\"Hello\"", "\"Hello\\nWorld\"", "\"\\\" \\\\ \\/ \\b \\f \\n \\r \\t\"",
+    "\"Hello\\u0000World\"", "\"\\uD834\\uDD1E\"", "\"", "\"abc", "\"\\v\"", "\"\\x12\"",
+    "\"\x01\"", "\"\\u\"", "\"\\u012\"", "\"\\uG000\"", "\"\\uD800\"", "\"\\uD800\\uE000\"",
+    "[ ]", "[ null , false , true , 123 , \"abc\" ]", "[ [ ] , [ 0 ] , [ 0 , 1 ] , [ 0 , 1 , 2 ] ]",
+    "[1", "[1}", "[1 2", "[[]", " { } ",
+    " { \"n\" : null , \"f\" : false , \"t\" : true , \"i\" : 123 , \"s\" : \"abc\", "
+    "\"a\" : [ 1, 2, 3 ],\"o\" : { \"1\" : 1, \"2\" : 2, \"3\" : 3 } } ",
+    "{:1,", "{1:1,", "{true:1,", "{[]:1,", "{{}:1,", "{\"a\":1,", "{\"a\"}", "{\"a\",\"b\"}",
+    "{\"a\":1", "{\"a\":1]", "{\"a\":1 \"b\"", "{\"a\":{}", "[1,2]x", "[\"a\"x]", "[tru e]",
+    "{\"\":1}", "{\"a\" x:1}", "[\"\\\\\"]", "[\"\\\\\\\"\"]", "[1]]", "]", ",", "{\"a\":1,}", "[,1]",
+};
+
+/* 两阶段解析与 lept_parse_n 的结果（包括错误码）必须完全一致 */
+#define TEST_INDEXED(json, len)\
+    do {\
+        lept_value v1, v2;\
+        int ret1, ret2;\
+        lept_init(&v1);\
+        lept_init(&v2);\
+        ret1 = lept_parse_n(&v1, json, len);\
+        ret2 = lept_parse_indexed(&v2, json, len);\
+        EXPECT_EQ_INT(ret1, ret2);\
+        EXPECT_EQ_INT(lept_get_type(&v1), lept_get_type(&v2));\
+        if (ret1 == LEPT_PARSE_OK && ret2 == LEPT_PARSE_OK) {\
+            size_t len1, len2;\
+            char *json1 = lept_stringify(&v1, &len1), *json2 = lept_stringify(&v2, &len2);\
+            EXPECT_TRUE(len1 == len2 && memcmp(json1, json2, len1) == 0);\
+            free(json1);\
+            free(json2);\
+        }\
+        lept_free(&v1);\
+        lept_free(&v2);\
+    } while(0)
+
+static void test_parse_indexed() {
+    static const char tail[] = "\\\\\\\"\\\\\", {\"k\\\"\" : [1, -2.5e3, null] }, \"[,]\" ,true]";
+    char json[1024];
+    size_t i, n;
+    int level;
+    for (level = LEPT_SIMD_SCALAR; level <= LEPT_SIMD_AVX2; level++) {
+        lept_set_simd_level((lept_simd_level) level);
+        for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++) {
+            TEST_INDEXED(parse_cases[i], strlen(parse_cases[i]));
+        }
+        /* 转义的引号与反斜杠出现在 64 字节块边界附近的各个位置 */
+        for (n = 0; n < 140; n++) {
+            char *p = json;
+            *p++ = '[';
+            *p++ = '"';
+            for (i = 0; i < n; i++)
+                *p++ = 'a';
+            memcpy(p, tail, sizeof(tail) - 1);
+            p += sizeof(tail) - 1;
+            TEST_INDEXED(json, p - json);
+            /* 截断在各个位置 */
+            TEST_INDEXED(json, p - json - n % 40);
+        }
+    }
+    lept_set_simd_level(LEPT_SIMD_AUTO);
+}
+
+/* 原地解析的结果（包括错误码）与 lept_parse_n 一致；输入复制到不以 '\0' 结尾的缓冲区 */
+#define TEST_INSITU(json, len)\
+    do {\
+        lept_value v1, v2;\
+        int ret1, ret2;\
+        char *buf = (char *) malloc((len) + 1);\
+        memcpy(buf, json, len);\
+        lept_init(&v1);\
+        lept_init(&v2);\
+        ret1 = lept_parse_n(&v1, json, len);\
+        ret2 = lept_parse_insitu(&v2, buf, len);\
+        EXPECT_EQ_INT(ret1, ret2);\
+        EXPECT_EQ_INT(lept_get_type(&v1), lept_get_type(&v2));\
+        if (ret1 == LEPT_PARSE_OK && ret2 == LEPT_PARSE_OK) {\
+            EXPECT_TRUE(lept_is_equal(&v1, &v2));\
+        }\
+        lept_free(&v1);\
+        lept_free(&v2);\
+        free(buf);\
+    } while(0)
+
+static void test_parse_insitu() {
+    char buf[] = "{\"k\\u0041\":[\"a\\tb\",\"\\uD834\\uDD1E\",\"plain\"]}";
+    lept_value v, *a;
+    size_t i;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_insitu(&v, buf, sizeof(buf) - 1));
+    EXPECT_EQ_STRING("kA", lept_get_object_key(&v, 0), lept_get_object_key_length(&v, 0));
+    EXPECT_TRUE(lept_get_object_key(&v, 0) >= buf && lept_get_object_key(&v, 0) < buf + sizeof(buf));
+    a = lept_get_object_value(&v, 0);
+    EXPECT_EQ_STRING("a\tb", lept_get_string(lept_get_array_element(a, 0)), lept_get_string_length(lept_get_array_element(a, 0)));
+    EXPECT_EQ_STRING("\xF0\x9D\x84\x9E", lept_get_string(lept_get_array_element(a, 1)), lept_get_string_length(lept_get_array_element(a, 1)));
+    EXPECT_EQ_STRING("plain", lept_get_string(lept_get_array_element(a, 2)), lept_get_string_length(lept_get_array_element(a, 2)));
+    /* 就地结果以 '\0' 结尾 */
+    EXPECT_EQ_INT('\0', lept_get_string(lept_get_array_element(a, 0))[3]);
+    EXPECT_TRUE(lept_get_string(lept_get_array_element(a, 2)) > buf && lept_get_string(lept_get_array_element(a, 2)) < buf + sizeof(buf));
+    /* 替换引用缓冲区的值 */
+    lept_set_string(lept_get_array_element(a, 2), "owned", 5);
+    EXPECT_EQ_STRING("owned", lept_get_string(lept_get_array_element(a, 2)), lept_get_string_length(lept_get_array_element(a, 2)));
+    lept_free(&v);
+
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++) {
+        TEST_INSITU(parse_cases[i], strlen(parse_cases[i]));
+    }
+}
+
+/* 带选项的解析结果（包括错误码）与 lept_parse_n 一致，lept_detach 后可释放输入，复制后可释放原值 */
+#define TEST_PARSE_OPTS(json, len, flags)\
+    do {\
+        lept_value v1, v2, v3;\
+        lept_parse_options opts = {(flags), 0, 0};\
+        int ret1, ret2;\
+        char *input = (char *) malloc((len) + 1);\
+        memcpy(input, json, len);\
+        lept_init(&v1);\
+        lept_init(&v2);\
+        lept_init(&v3);\
+        ret1 = lept_parse_n(&v1, json, len);\
+        ret2 = lept_parse_opts(&v2, input, len, &opts);\
+        EXPECT_EQ_INT(ret1, ret2);\
+        EXPECT_EQ_INT(lept_get_type(&v1), lept_get_type(&v2));\
+        lept_detach(&v2);\
+        EXPECT_FALSE(lept_is_borrowed(&v2));\
+        free(input);\
+        if (ret1 == LEPT_PARSE_OK && ret2 == LEPT_PARSE_OK) {\
+            EXPECT_TRUE(lept_is_equal(&v1, &v2));\
+            lept_copy(&v3, &v2);\
+            lept_free(&v2);\
+            EXPECT_TRUE(lept_is_equal(&v1, &v3));\
+        }\
+        lept_free(&v1);\
+        lept_free(&v2);\
+        lept_free(&v3);\
+    } while(0)
+
+static void test_parse_borrow() {
+    static const char json[] = "{\"key\":[\"plain\",\"esc\\n\"],\"k\\u0041\":\"\"}";
+    lept_parse_options opts = {LEPT_PARSE_OPT_BORROW, 0, 0};
+    lept_value v, *a;
+    size_t i;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, json, sizeof(json) - 1, &opts));
+    EXPECT_TRUE(lept_is_borrowed(&v));
+    /* 不含转义的键和字符串引用输入，含转义的被复制解码 */
+    EXPECT_TRUE(lept_get_object_key(&v, 0) == json + 2);
+    EXPECT_EQ_SIZE_T(3, lept_get_object_key_length(&v, 0));
+    a = lept_get_object_value(&v, 0);
+    EXPECT_TRUE(lept_is_borrowed(lept_get_array_element(a, 0)));
+    EXPECT_EQ_STRING("plain", lept_get_string(lept_get_array_element(a, 0)), lept_get_string_length(lept_get_array_element(a, 0)));
+    EXPECT_FALSE(lept_is_borrowed(lept_get_array_element(a, 1)));
+    EXPECT_EQ_STRING("esc\n", lept_get_string(lept_get_array_element(a, 1)), lept_get_string_length(lept_get_array_element(a, 1)));
+    EXPECT_EQ_STRING("kA", lept_get_object_key(&v, 1), lept_get_object_key_length(&v, 1));
+    EXPECT_TRUE(lept_is_borrowed(lept_get_object_value(&v, 1)));
+    EXPECT_EQ_SIZE_T(0, lept_get_string_length(lept_get_object_value(&v, 1)));
+    /* 复制后不再引用输入，且以 '\0' 结尾 */
+    lept_detach(&v);
+    EXPECT_FALSE(lept_is_borrowed(&v));
+    EXPECT_TRUE(lept_get_object_key(&v, 0) != json + 2);
+    EXPECT_EQ_INT('\0', lept_get_string(lept_get_array_element(a, 0))[5]);
+    lept_free(&v);
+
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++) {
+        TEST_PARSE_OPTS(parse_cases[i], strlen(parse_cases[i]), LEPT_PARSE_OPT_BORROW);
+    }
+}
+
+static void test_parse_lazy() {
+    static const char json[] = "{\"id\":7,\"tags\":[\"a\",[1,{\"x\":null}]],\"meta\":{\"k\":\"v\\n\"},\"e\":[]}";
+    static const char *nested_cases[] = {
+        "[[1,]]", "[{\"a\":1e309}]", "[[\"\\x\"]]", "[{\"a\" 1}]", "[[1 2]]", "[{\"a\":1]]", "[[[]]",
+        "[{}, [[], {\"b\":[true, \"\\uD834\\uDD1E\", -0.5e-3]}], {\"c\":{\"d\":{}}}]", "[[\"\x01\"]]",
+        "[[\"\\uD800\"]]", "{\"a\":{\"b\":[1, 2 ,3 ] } , \"c\" : [ ] }", "[[1],", "[{\"a\":", "[[tru]]",
+    };
+    lept_parse_options opts = {LEPT_PARSE_OPT_LAZY, 0, 0}, limited = {LEPT_PARSE_OPT_LAZY, 3, 0};
+    lept_value v, *tags, *inner;
+    size_t i;
+    char *out;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, json, sizeof(json) - 1, &opts));
+    EXPECT_TRUE(lept_is_borrowed(&v));
+    /* 根值以下的非空容器尚未展开，空容器直接构建 */
+    tags = lept_find_object_value(&v, "tags", 4);
+    EXPECT_TRUE((tags->flags & LEPT_FLAG_LAZY) != 0);
+    EXPECT_TRUE((lept_get_object_value(&v, 2)->flags & LEPT_FLAG_LAZY) != 0);
+    EXPECT_FALSE((lept_get_object_value(&v, 3)->flags & LEPT_FLAG_LAZY) != 0);
+    EXPECT_EQ_INT(LEPT_ARRAY, lept_get_type(tags));
+    /* 首次访问时展开一层 */
+    EXPECT_EQ_SIZE_T(2, lept_get_array_size(tags));
+    EXPECT_FALSE((tags->flags & LEPT_FLAG_LAZY) != 0);
+    EXPECT_EQ_STRING("a", lept_get_string(lept_get_array_element(tags, 0)), lept_get_string_length(lept_get_array_element(tags, 0)));
+    inner = lept_get_array_element(tags, 1);
+    EXPECT_TRUE((inner->flags & LEPT_FLAG_LAZY) != 0);
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(lept_find_object_value(lept_get_array_element(inner, 1), "x", 1)));
+    /* 序列化时展开其余部分 */
+    out = lept_stringify(&v, NULL);
+    EXPECT_EQ_STRING("{\"id\":7,\"tags\":[\"a\",[1,{\"x\":null}]],\"meta\":{\"k\":\"v\\n\"},\"e\":[]}", out, strlen(out));
+    free(out);
+    lept_free(&v);
+    /* 跳过的部分同样检查嵌套层数 */
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_parse_opts(&v, "[1,{\"a\":[[]]}]", 14, &limited));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, "{\"a\":[{}]}", 10, &limited));
+    lept_free(&v);
+
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++) {
+        TEST_PARSE_OPTS(parse_cases[i], strlen(parse_cases[i]), LEPT_PARSE_OPT_LAZY);
+        TEST_PARSE_OPTS(parse_cases[i], strlen(parse_cases[i]), LEPT_PARSE_OPT_LAZY | LEPT_PARSE_OPT_BORROW);
+    }
+    for (i = 0; i < sizeof(nested_cases) / sizeof(nested_cases[0]); i++) {
+        TEST_PARSE_OPTS(nested_cases[i], strlen(nested_cases[i]), LEPT_PARSE_OPT_LAZY);
+        TEST_PARSE_OPTS(nested_cases[i], strlen(nested_cases[i]), LEPT_PARSE_OPT_LAZY | LEPT_PARSE_OPT_BORROW);
+    }
+}
+
+static void test_parse_intern() {
+    static const char json[] = "[{\"id\":1,\"name\":\"a\"},{\"id\":2,\"na\\u006de\":\"b\"},{\"name\":\"c\",\"id\":3}]";
+    lept_parse_options opts = {LEPT_PARSE_OPT_INTERN_KEYS, 0, 0};
+    lept_value v, copy, *e0, *e1, *e2;
+    char *big;
+    size_t i, len;
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, json, sizeof(json) - 1, &opts));
+    e0 = lept_get_array_element(&v, 0);
+    e1 = lept_get_array_element(&v, 1);
+    e2 = lept_get_array_element(&v, 2);
+    /* 相同的键（包括含转义的）共享同一份内存 */
+    EXPECT_TRUE(lept_get_object_key(e0, 0) == lept_get_object_key(e1, 0));
+    EXPECT_TRUE(lept_get_object_key(e0, 0) == lept_get_object_key(e2, 1));
+    EXPECT_TRUE(lept_get_object_key(e0, 1) == lept_get_object_key(e1, 1));
+    EXPECT_TRUE(lept_get_object_key(e0, 1) == lept_get_object_key(e2, 0));
+    EXPECT_EQ_STRING("name", lept_get_object_key(e1, 1), lept_get_object_key_length(e1, 1));
+    EXPECT_TRUE(e0->u.o.m[0].kflags & LEPT_FLAG_SHARED);
+    EXPECT_FALSE(lept_is_borrowed(&v));
+
+    /* 副本共享键，先释放原值后副本仍然有效 */
+    lept_init(&copy);
+    lept_copy(&copy, &v);
+    EXPECT_TRUE(lept_get_object_key(lept_get_array_element(&copy, 2), 0) == lept_get_object_key(e0, 1));
+    lept_free(&v);
+    EXPECT_EQ_STRING("name", lept_get_object_key(lept_get_array_element(&copy, 2), 0), 4);
+    lept_free(&copy);
+
+    /* 不含转义的键引用输入时不必共享 */
+    opts.flags |= LEPT_PARSE_OPT_BORROW;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, json, sizeof(json) - 1, &opts));
+    EXPECT_TRUE(lept_get_array_element(&v, 0)->u.o.m[0].kflags & LEPT_FLAG_BORROWED);
+    EXPECT_TRUE(lept_get_array_element(&v, 1)->u.o.m[1].kflags & LEPT_FLAG_SHARED);
+    lept_free(&v);
+
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++) {
+        TEST_PARSE_OPTS(parse_cases[i], strlen(parse_cases[i]), LEPT_PARSE_OPT_INTERN_KEYS);
+        TEST_PARSE_OPTS(parse_cases[i], strlen(parse_cases[i]), LEPT_PARSE_OPT_INTERN_KEYS | LEPT_PARSE_OPT_LAZY);
+    }
+    /* 出错时已共享的键正确释放 */
+    TEST_PARSE_OPTS("[{\"a\":1},{\"a\":2,\"b\":x}]", 23, LEPT_PARSE_OPT_INTERN_KEYS);
+    TEST_PARSE_OPTS("[{\"a\":1},{\"a\":{\"a\":[}}]", 23, LEPT_PARSE_OPT_INTERN_KEYS);
+
+    /* 不同的键超过上限后照常单独分配 */
+    big = (char *) malloc(6000 * 32);
+    len = 0;
+    big[len++] = '{';
+    for (i = 0; i < 6000; i++)
+        len += sprintf(big + len, "%s\"k%lu\":{\"k%lu\":%lu}", i ? "," : "", (unsigned long) i, (unsigned long) (i % 10), (unsigned long) i);
+    big[len++] = '}';
+    TEST_PARSE_OPTS(big, len, LEPT_PARSE_OPT_INTERN_KEYS);
+    opts.flags = LEPT_PARSE_OPT_INTERN_KEYS;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, big, len, &opts));
+    EXPECT_TRUE(v.u.o.m[0].kflags & LEPT_FLAG_SHARED);
+    EXPECT_FALSE(v.u.o.m[5999].kflags & LEPT_FLAG_SHARED);
+    lept_free(&v);
+    free(big);
+}
+
+/* 统计与上一条记录共享形状（或第一个键）的记录数 */
+static int test_shapes_callback(void *ctx, size_t offset, int error, lept_value *v) {
+    static const void *last = NULL;
+    const void *p = v->flags & LEPT_FLAG_SHAPED ? (const void *) v->u.h.shape : (const void *) lept_get_object_key(v, 0);
+    (void) error;
+    if (offset > 0 && p == last)
+        ++*(size_t *) ctx;
+    last = p;
+    return 0;
+}
+
+static void test_parse_shapes() {
+    static const char json[] = "[{\"id\":1,\"name\":\"a\"},{\"id\":2,\"na\\u006de\":\"b\"},{\"name\":\"c\",\"id\":3}]";
+    lept_parse_options opts = {LEPT_PARSE_OPT_SHAPES, 0, 0};
+    lept_value v, copy, *e0, *e1, *e2;
+    char *buf, *out;
+    size_t i, len, n, shared;
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, json, sizeof(json) - 1, &opts));
+    e0 = lept_get_array_element(&v, 0);
+    e1 = lept_get_array_element(&v, 1);
+    e2 = lept_get_array_element(&v, 2);
+    /* 键序列相同（包括含转义的键）的对象共享形状，键的顺序不同则形状不同 */
+    EXPECT_TRUE(e0->flags & LEPT_FLAG_SHAPED);
+    EXPECT_TRUE(e0->u.h.shape == e1->u.h.shape);
+    EXPECT_TRUE(e0->u.h.shape != e2->u.h.shape);
+    EXPECT_EQ_SIZE_T(2, lept_get_object_size(e1));
+    EXPECT_EQ_STRING("name", lept_get_object_key(e1, 1), lept_get_object_key_length(e1, 1));
+    EXPECT_EQ_STRING("b", lept_get_string(lept_find_object_value(e1, "name", 4)), 1);
+    EXPECT_EQ_SIZE_T(1, lept_find_object_index(e2, "id", 2));
+    EXPECT_EQ_DOUBLE(3.0, lept_get_number(lept_get_object_value(e2, 1)));
+    EXPECT_TRUE(lept_find_object_value(e1, "nam", 3) == NULL);
+    EXPECT_TRUE(lept_find_object_value(e1, "names", 5) == NULL);
+    EXPECT_FALSE(lept_is_borrowed(&v));
+    out = lept_stringify(&v, &len);
+    EXPECT_EQ_STRING("[{\"id\":1,\"name\":\"a\"},{\"id\":2,\"name\":\"b\"},{\"name\":\"c\",\"id\":3}]", out, len);
+    free(out);
+
+    /* 副本共享形状，先释放原值后副本仍然有效 */
+    lept_init(&copy);
+    lept_copy(&copy, &v);
+    EXPECT_TRUE(lept_get_array_element(&copy, 0)->u.h.shape == e0->u.h.shape);
+    EXPECT_TRUE(lept_is_equal(&copy, &v));
+
+    /* 修改前转换为逐个保存成员，不影响共享同一形状的其他对象 */
+    lept_reserve_object(e0, 4);
+    EXPECT_FALSE(e0->flags & LEPT_FLAG_SHAPED);
+    EXPECT_EQ_STRING("name", lept_get_object_key(e0, 1), 4);
+    EXPECT_EQ_DOUBLE(1.0, lept_get_number(lept_find_object_value(e0, "id", 2)));
+    EXPECT_TRUE(e1->flags & LEPT_FLAG_SHAPED);
+    EXPECT_TRUE(lept_is_equal(&copy, &v));
+    lept_free(&v);
+    EXPECT_EQ_STRING("name", lept_get_object_key(lept_get_array_element(&copy, 1), 1), 4);
+    lept_free(&copy);
+
+    /* 重复的键查找时得到第一个 */
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, "{\"id\":4,\"x\":5,\"id\":6}", 21, &opts));
+    EXPECT_TRUE(v.flags & LEPT_FLAG_SHAPED);
+    EXPECT_EQ_SIZE_T(3, lept_get_object_size(&v));
+    EXPECT_EQ_SIZE_T(0, lept_find_object_index(&v, "id", 2));
+    EXPECT_EQ_STRING("id", lept_get_object_key(&v, 2), 2);
+    EXPECT_EQ_DOUBLE(6.0, lept_get_number(lept_get_object_value(&v, 2)));
+    lept_free(&v);
+
+    /* 引用输入的键，lept_detach 之后不再依赖输入 */
+    len = sizeof(json) - 1;
+    buf = (char *) malloc(len);
+    memcpy(buf, json, len);
+    opts.flags |= LEPT_PARSE_OPT_BORROW;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, buf, len, &opts));
+    EXPECT_TRUE(lept_get_array_element(&v, 0)->u.h.shape == lept_get_array_element(&v, 1)->u.h.shape);
+    EXPECT_TRUE(lept_is_borrowed(&v));
+    lept_detach(&v);
+    EXPECT_FALSE(lept_is_borrowed(&v));
+    memset(buf, ' ', len);
+    free(buf);
+    EXPECT_EQ_STRING("name", lept_get_object_key(lept_get_array_element(&v, 1), 1), 4);
+    EXPECT_EQ_STRING("c", lept_get_string(lept_find_object_value(lept_get_array_element(&v, 2), "name", 4)), 1);
+    lept_free(&v);
+
+    /* 形状的键引用输入时，副本不共享形状，输入释放后仍然有效 */
+    len = sizeof(json) - 1;
+    buf = (char *) malloc(len);
+    memcpy(buf, json, len);
+    lept_init(&v);
+    lept_init(&copy);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, buf, len, &opts));
+    lept_copy(&copy, &v);
+    EXPECT_FALSE(lept_is_borrowed(&copy));
+    EXPECT_FALSE(lept_get_array_element(&copy, 0)->flags & LEPT_FLAG_SHAPED);
+    lept_free(&v);
+    memset(buf, ' ', len);
+    free(buf);
+    out = lept_stringify(&copy, &len);
+    EXPECT_EQ_STRING("[{\"id\":1,\"name\":\"a\"},{\"id\":2,\"name\":\"b\"},{\"name\":\"c\",\"id\":3}]", out, len);
+    free(out);
+    lept_free(&copy);
+
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++) {
+        TEST_PARSE_OPTS(parse_cases[i], strlen(parse_cases[i]), LEPT_PARSE_OPT_INTERN_KEYS | LEPT_PARSE_OPT_SHAPES);
+        TEST_PARSE_OPTS(parse_cases[i], strlen(parse_cases[i]), LEPT_PARSE_OPT_INTERN_KEYS | LEPT_PARSE_OPT_SHAPES | LEPT_PARSE_OPT_LAZY);
+        TEST_PARSE_OPTS(parse_cases[i], strlen(parse_cases[i]), LEPT_PARSE_OPT_INTERN_KEYS | LEPT_PARSE_OPT_SHAPES | LEPT_PARSE_OPT_BORROW);
+    }
+    /* 出错时已建立的形状正确释放 */
+    TEST_PARSE_OPTS("[{\"a\":1},{\"a\":2},{\"a\":x}]", 25, LEPT_PARSE_OPT_INTERN_KEYS | LEPT_PARSE_OPT_SHAPES);
+    TEST_PARSE_OPTS("[{\"a\":1},{\"a\":{\"a\":[}}]", 23, LEPT_PARSE_OPT_INTERN_KEYS | LEPT_PARSE_OPT_SHAPES);
+
+    /* 并行解析时同一线程的元素、NDJSON 同一块的记录之间也共享形状和键 */
+    n = 10000;
+    buf = (char *) malloc(n * 32);
+    len = 0;
+    buf[len++] = '[';
+    for (i = 0; i < n; i++)
+        len += sprintf(buf + len, "%s{\"id\":%lu,\"name\":\"x\"}", i ? "," : "", (unsigned long) i);
+    buf[len++] = ']';
+    opts.flags = LEPT_PARSE_OPT_SHAPES;
+    opts.nthreads = 2;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, buf, len, &opts));
+    e0 = lept_get_array_element(&v, 0);
+    e1 = lept_get_array_element(&v, 1);
+    EXPECT_TRUE(e0->flags & LEPT_FLAG_SHAPED);
+    EXPECT_TRUE(e0->u.h.shape == e1->u.h.shape);
+    EXPECT_TRUE(lept_get_object_key(e0, 0) == lept_get_object_key(e1, 0));
+    lept_free(&v);
+    opts.nthreads = 0;
+    len = 0;
+    for (i = 0; i < 100; i++)
+        len += sprintf(buf + len, "{\"id\":%lu,\"name\":\"x\"}\n", (unsigned long) i);
+    shared = 0;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ndjson(buf, len, 1, &opts, test_shapes_callback, &shared));
+    EXPECT_EQ_SIZE_T(99, shared);
+    opts.flags = LEPT_PARSE_OPT_INTERN_KEYS;
+    shared = 0;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ndjson(buf, len, 1, &opts, test_shapes_callback, &shared));
+    EXPECT_EQ_SIZE_T(99, shared);
+    free(buf);
+
+    /* 键数和形状数超过上限的对象照常保存成员 */
+    buf = (char *) malloc(1100 * 32);
+    len = 0;
+    buf[len++] = '[';
+    for (i = 0; i < 1100; i++)
+        len += sprintf(buf + len, "%s{\"k%lu\":%lu}", i ? "," : "", (unsigned long) i, (unsigned long) i);
+    buf[len++] = ',';
+    buf[len++] = '{';
+    for (i = 0; i < 65; i++)
+        len += sprintf(buf + len, "%s\"k%lu\":%lu", i ? "," : "", (unsigned long) i, (unsigned long) i);
+    buf[len++] = '}';
+    buf[len++] = ']';
+    TEST_PARSE_OPTS(buf, len, LEPT_PARSE_OPT_INTERN_KEYS | LEPT_PARSE_OPT_SHAPES);
+    opts.flags = LEPT_PARSE_OPT_SHAPES;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, buf, len, &opts));
+    EXPECT_TRUE(lept_get_array_element(&v, 1023)->flags & LEPT_FLAG_SHAPED);
+    EXPECT_FALSE(lept_get_array_element(&v, 1024)->flags & LEPT_FLAG_SHAPED);
+    EXPECT_FALSE(lept_get_array_element(&v, 1100)->flags & LEPT_FLAG_SHAPED);
+    EXPECT_EQ_SIZE_T(65, lept_get_object_size(lept_get_array_element(&v, 1100)));
+    lept_free(&v);
+    free(buf);
+}
+
+static void test_parse_depth() {
+    /* 嵌套层数超过 C 调用栈所能容纳的递归深度 */
+    const size_t n = 200000;
+    lept_parse_options opts = {0, 3, 0};
+    char *json = (char *) malloc(n * 6 + 1);
+    size_t i, len = 0;
+    lept_value v, *p;
+    for (i = 0; i < n; i++)
+        json[len++] = '[';
+    for (i = 0; i < n; i++)
+        json[len++] = ']';
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, json, len));
+    for (i = 0, p = &v; i < n - 1; i++)
+        p = lept_get_array_element(p, 0);
+    EXPECT_EQ_SIZE_T(0, lept_get_array_size(p));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_indexed(&v, json, len));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_parse_opts(&v, json, len, &opts));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+    /* 未结束的输入：逐层释放已解析的部分 */
+    EXPECT_EQ_INT(LEPT_PARSE_EXPECT_VALUE, lept_parse_n(&v, json, n));
+
+    len = 0;
+    for (i = 0; i < n; i++) {
+        memcpy(json + len, "{\"a\":", 5);
+        len += 5;
+    }
+    json[len++] = '1';
+    for (i = 0; i < n; i++)
+        json[len++] = '}';
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, json, len));
+    EXPECT_EQ_INT(LEPT_OBJECT, lept_get_type(&v));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET, lept_parse_n(&v, json, len - 1));
+    free(json);
+
+    /* 最大嵌套层数 */
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, "[[[1]]]", 7, &opts));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, "{\"a\":[{}]}", 10, &opts));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_parse_opts(&v, "[[[[1]]]]", 9, &opts));
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_parse_opts(&v, "[1,{\"a\":[[]]}]", 15, &opts));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+}
+
+/* SAX 事件记录为文本，便于比较 */
+typedef struct {
+    char buf[256];
+    size_t len;
+    int skip;           /* 跳过根值以下的数组 */
+    const char *stop;   /* 遇到此键时中止 */
+} test_sax_log;
+
+static void test_sax_puts(test_sax_log *log, const char *s, size_t len) {
+    if (log->len + len < sizeof(log->buf)) {
+        memcpy(log->buf + log->len, s, len);
+        log->len += len;
+    }
+    log->buf[log->len] = '\0';
+}
+
+static int test_sax_null(void *ctx) {
+    test_sax_puts((test_sax_log *) ctx, "n ", 2);
+    return LEPT_SAX_CONTINUE;
+}
+
+static int test_sax_bool(void *ctx, int b) {
+    test_sax_puts((test_sax_log *) ctx, b ? "t " : "f ", 2);
+    return LEPT_SAX_CONTINUE;
+}
+
+static int test_sax_number(void *ctx, const lept_value *n) {
+    char buf[32];
+    if (lept_is_integer(n))
+        sprintf(buf, "i%lld ", (long long) lept_get_int64(n));
+    else
+        sprintf(buf, "d%g ", lept_get_number(n));
+    test_sax_puts((test_sax_log *) ctx, buf, strlen(buf));
+    return LEPT_SAX_CONTINUE;
+}
+
+static int test_sax_string(void *ctx, const char *s, size_t len) {
+    test_sax_puts((test_sax_log *) ctx, "s", 1);
+    test_sax_puts((test_sax_log *) ctx, s, len);
+    test_sax_puts((test_sax_log *) ctx, " ", 1);
+    return LEPT_SAX_CONTINUE;
+}
+
+static int test_sax_key(void *ctx, const char *k, size_t len) {
+    test_sax_log *log = (test_sax_log *) ctx;
+    if (log->stop != NULL && strlen(log->stop) == len && memcmp(log->stop, k, len) == 0)
+        return LEPT_SAX_ABORT;
+    test_sax_puts(log, k, len);
+    test_sax_puts(log, ":", 1);
+    return LEPT_SAX_CONTINUE;
+}
+
+static int test_sax_start_object(void *ctx) {
+    test_sax_puts((test_sax_log *) ctx, "{ ", 2);
+    return LEPT_SAX_CONTINUE;
+}
+
+static int test_sax_end_object(void *ctx, size_t size) {
+    char buf[32];
+    sprintf(buf, "}%d ", (int) size);
+    test_sax_puts((test_sax_log *) ctx, buf, strlen(buf));
+    return LEPT_SAX_CONTINUE;
+}
+
+static int test_sax_start_array(void *ctx) {
+    test_sax_log *log = (test_sax_log *) ctx;
+    test_sax_puts(log, "[ ", 2);
+    return log->skip && log->len > 2 ? LEPT_SAX_SKIP : LEPT_SAX_CONTINUE;
+}
+
+static int test_sax_end_array(void *ctx, size_t size) {
+    char buf[32];
+    sprintf(buf, "]%d ", (int) size);
+    test_sax_puts((test_sax_log *) ctx, buf, strlen(buf));
+    return LEPT_SAX_CONTINUE;
+}
+
+static const lept_sax_handler test_sax_handler = {
+    test_sax_null, test_sax_bool, test_sax_number, test_sax_string, test_sax_key,
+    test_sax_start_object, test_sax_end_object, test_sax_start_array, test_sax_end_array
+};
+
+#define TEST_SAX(expect, json, skip_arrays, stop_key)\
+    do {\
+        test_sax_log log;\
+        log.len = 0;\
+        log.buf[0] = '\0';\
+        log.skip = skip_arrays;\
+        log.stop = stop_key;\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_sax(json, strlen(json), &test_sax_handler, &log, NULL));\
+        EXPECT_EQ_STRING(expect, log.buf, log.len);\
+    } while(0)
+
+static void test_parse_sax() {
+    static const lept_sax_handler none = {NULL};
+    lept_parse_options opts = {0, 2, 0};
+    test_sax_log log;
+    size_t i;
+    TEST_SAX("n ", " null ", 0, NULL);
+    TEST_SAX("[ ]0 ", "[ ]", 0, NULL);
+    TEST_SAX("{ a:[ i1 d-2.5 i-9223372036854775808 ]3 b:{ }0 c:sx\ny }3 ",
+             "{\"a\":[1,-2.5e0,-9223372036854775808],\"b\":{},\"c\":\"x\\ny\"}", 0, NULL);
+    TEST_SAX("[ t f n [ ]0 s ]5 ", "[true,false,null,[1,[2]],\"\"]", 1, NULL);
+    TEST_SAX("{ a:[ ]0 }1 ", "{\"a\":[{\"b\":[]}, 2]}", 1, NULL);
+
+    /* 中止解析：此前的事件已产生 */
+    log.len = 0;
+    log.skip = 0;
+    log.stop = "stop";
+    EXPECT_EQ_INT(LEPT_PARSE_ABORTED, lept_parse_sax("{\"a\":1,\"stop\":2}", 16, &test_sax_handler, &log, NULL));
+    EXPECT_EQ_STRING("{ a:i1 ", log.buf, log.len);
+
+    /* 跳过的内容仍然校验 */
+    log.len = 0;
+    log.skip = 1;
+    log.stop = NULL;
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_VALUE, lept_parse_sax("[[1,]]", 6, &test_sax_handler, &log, NULL));
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_parse_sax("[[[1]]]", 7, &test_sax_handler, &log, &opts));
+    EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, lept_parse_sax("[] x", 4, &test_sax_handler, &log, NULL));
+
+    /* 不处理任何事件时即为校验，错误码与 lept_parse_n 一致 */
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++) {
+        lept_value v;
+        lept_init(&v);
+        EXPECT_EQ_INT(lept_parse_n(&v, parse_cases[i], strlen(parse_cases[i])),
+                      lept_parse_sax(parse_cases[i], strlen(parse_cases[i]), &none, NULL, NULL));
+        lept_free(&v);
+    }
+}
+
+/* 读到结束或出错，返回错误码；skip 时遇到数组和对象整个跳过 */
+static int test_reader_drain(const char *json, size_t len, int skip) {
+    lept_reader r;
+    lept_read_token tok;
+    int ret;
+    lept_reader_init(&r, json, len);
+    while ((tok = lept_reader_next(&r)) != LEPT_READ_EOF && tok != LEPT_READ_ERROR) {
+        if (skip && (tok == LEPT_READ_START_ARRAY || tok == LEPT_READ_START_OBJECT))
+            lept_reader_skip(&r);
+    }
+    ret = lept_reader_error(&r);
+    lept_reader_free(&r);
+    return ret;
+}
+
+static void test_reader() {
+    static const char json[] = " {\"id\":-42, \"n\\u0041me\" : \"a\\tb\", \"skip\":[1,{\"x\":[]}], \"rest\":{\"a\":1,\"b\":[2]}, \"z\":[ ]} ";
+    lept_reader r;
+    const char *s;
+    size_t len, i;
+    lept_reader_init(&r, json, sizeof(json) - 1);
+    EXPECT_EQ_INT(LEPT_READ_START_OBJECT, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_READ_KEY, lept_reader_next(&r));
+    s = lept_reader_get_string(&r, &len);
+    EXPECT_EQ_STRING("id", s, len);
+    EXPECT_TRUE(s == json + 3);
+    EXPECT_EQ_INT(LEPT_READ_NUMBER, lept_reader_next(&r));
+    EXPECT_EQ_INT64(-42, lept_get_int64(lept_reader_get_number(&r)));
+    s = lept_reader_get_span(&r, &len);
+    EXPECT_EQ_STRING("-42", s, len);
+    /* 含转义的键和字符串按需解码，源文本不解码 */
+    EXPECT_EQ_INT(LEPT_READ_KEY, lept_reader_next(&r));
+    s = lept_reader_get_span(&r, &len);
+    EXPECT_EQ_STRING("n\\u0041me", s, len);
+    s = lept_reader_get_string(&r, &len);
+    EXPECT_EQ_STRING("nAme", s, len);
+    EXPECT_EQ_INT(LEPT_READ_STRING, lept_reader_next(&r));
+    s = lept_reader_get_string(&r, &len);
+    EXPECT_EQ_STRING("a\tb", s, len);
+    /* 跳过整个数组 */
+    EXPECT_EQ_INT(LEPT_READ_KEY, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_READ_START_ARRAY, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_reader_skip(&r));
+    /* 跳过对象的剩余部分 */
+    EXPECT_EQ_INT(LEPT_READ_KEY, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_READ_START_OBJECT, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_READ_KEY, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_reader_skip(&r));
+    EXPECT_EQ_INT(LEPT_READ_KEY, lept_reader_next(&r));
+    s = lept_reader_get_string(&r, &len);
+    EXPECT_EQ_STRING("z", s, len);
+    EXPECT_EQ_INT(LEPT_READ_START_ARRAY, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_READ_END_ARRAY, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_READ_END_OBJECT, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_READ_EOF, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_READ_EOF, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_reader_error(&r));
+    lept_reader_free(&r);
+
+    lept_reader_init(&r, "[true, x]", 9);
+    EXPECT_EQ_INT(LEPT_READ_START_ARRAY, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_READ_TRUE, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_READ_ERROR, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_READ_ERROR, lept_reader_next(&r));
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_VALUE, lept_reader_error(&r));
+    lept_reader_free(&r);
+
+    /* 错误码与 lept_parse_n 一致，跳过时同样校验 */
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++) {
+        lept_value v;
+        int ret;
+        lept_init(&v);
+        ret = lept_parse_n(&v, parse_cases[i], strlen(parse_cases[i]));
+        EXPECT_EQ_INT(ret, test_reader_drain(parse_cases[i], strlen(parse_cases[i]), 0));
+        EXPECT_EQ_INT(ret, test_reader_drain(parse_cases[i], strlen(parse_cases[i]), 1));
+        lept_free(&v);
+    }
+}
+
+/* 按 step 字节一块（第一块为 first 字节）输入，每块复制到恰好大小的缓冲区，结果须与 lept_parse_n 相同 */
+static void test_parser_chunks(const char *json, size_t len, size_t first, size_t step) {
+    lept_parser p;
+    lept_value v1, v2;
+    size_t i, n;
+    int ret1, ret2 = LEPT_PARSE_OK;
+    lept_init(&v1);
+    ret1 = lept_parse_n(&v1, json, len);
+    lept_parser_init(&p, NULL);
+    for (i = 0; i < len && ret2 == LEPT_PARSE_OK; i += n) {
+        char *chunk;
+        n = i == 0 ? first : step;
+        if (n > len - i)
+            n = len - i;
+        chunk = (char *) malloc(n);
+        memcpy(chunk, json + i, n);
+        ret2 = lept_parser_feed(&p, chunk, n);
+        free(chunk);
+    }
+    EXPECT_EQ_INT(ret2, lept_parser_feed(&p, "", 0));
+    ret2 = lept_parser_finish(&p, &v2);
+    EXPECT_EQ_INT(ret1, ret2);
+    if (ret1 == LEPT_PARSE_OK && ret2 == LEPT_PARSE_OK) {
+        EXPECT_TRUE(lept_is_equal(&v1, &v2));
+    }
+    lept_free(&v1);
+    lept_free(&v2);
+}
+
+static void test_parser() {
+    static const char *chunk_cases[] = {
+        "{\"id\":7,\"tags\":[\"a\",[1,{\"x\":null}]],\"meta\":{\"k\":\"v\\n\"},\"e\":[]}",
+        "[\"\\uD834\\uDD1E\\u00E9\\u4E2D\", \"\\uD834x\", \"\\uD834\\u0041\", \"\\u00\"]",
+        "[-1.5e+10, 0.25, 18446744073709551615, -9223372036854775808, 123456789012345678901234567890]",
+        "[[1,]]", "[{\"a\":1e309}]", "[{\"a\" 1}]", "[{\"a\":1]]", "[[[]]", "[1-2]", "[1 -2]", "1-",
+        "{\"a\\tb\":\"c\\\"d\", \"\":\"\", \"x\":[true,false,null]}", "[nulx]", "[truex]", "[\"\\",
+    };
+    lept_parse_options limited = {0, 2, 0};
+    lept_parser p;
+    lept_value v;
+    size_t i, k, len;
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]) + sizeof(chunk_cases) / sizeof(chunk_cases[0]); i++) {
+        const char *json = i < sizeof(parse_cases) / sizeof(parse_cases[0]) ? parse_cases[i]
+                           : chunk_cases[i - sizeof(parse_cases) / sizeof(parse_cases[0])];
+        len = strlen(json);
+        /* 在每个位置断开，以及逐字节输入 */
+        for (k = 1; k <= len; k++)
+            test_parser_chunks(json, len, k, len);
+        test_parser_chunks(json, len, 1, 1);
+        test_parser_chunks(json, len, 3, 3);
+    }
+
+    /* 嵌套层数 */
+    lept_parser_init(&p, &limited);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parser_feed(&p, "[[", 2));
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_parser_feed(&p, "[]]]", 4));
+    /* 出错后保持同一错误码 */
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_parser_feed(&p, "1", 1));
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_parser_finish(&p, &v));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+
+    /* 放弃解析时释放已构建的部分 */
+    lept_parser_init(&p, NULL);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parser_feed(&p, "{\"a\":[\"x\",{\"b\":\"y", 17));
+    lept_parser_free(&p);
+    lept_parser_init(&p, NULL);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parser_feed(&p, "\"abc\"", 5));
+    lept_parser_free(&p);
+}
+
+typedef struct {
+    const size_t *offsets;      /* 各条记录的偏移，递增 */
+    size_t count;
+    lept_value *values;
+    int *errors;
+    size_t delivered, last, stop;
+    int ordered_ok;
+} test_ndjson_state;
+
+/* 按偏移找到记录的位置存放结果；不保证顺序时各回调写不同的位置 */
+static int test_ndjson_callback(void *ctx, size_t offset, int error, lept_value *v) {
+    test_ndjson_state *s = (test_ndjson_state *) ctx;
+    size_t lo = 0, hi = s->count;
+    while (lo + 1 < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (s->offsets[mid] <= offset)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    s->errors[lo] = error;
+    lept_move(&s->values[lo], v);
+    return 0;
+}
+
+/* 按顺序交付：回调不会同时执行，检查顺序并在第 stop 条时中止 */
+static int test_ndjson_ordered(void *ctx, size_t offset, int error, lept_value *v) {
+    test_ndjson_state *s = (test_ndjson_state *) ctx;
+    if (s->delivered > 0 && offset <= s->last)
+        s->ordered_ok = 0;
+    s->last = offset;
+    test_ndjson_callback(ctx, offset, error, v);
+    return ++s->delivered == s->stop;
+}
+
+static void test_parse_ndjson() {
+    static const char *lines[] = {
+        "{\"id\":1,\"name\":\"a\\tb\",\"tags\":[\"x\",\"y\"]}", "  [1, 2.5, -3e10, true, null]\r", "", "  \t",
+        "\"plain\"", "{\"a\":", "123456789012345678901234567890", "[1,]", "{\"nested\":{\"k\":[[],{}]}}", "x",
+    };
+    static const unsigned option_flags[] = {0, LEPT_PARSE_OPT_UNORDERED, LEPT_PARSE_OPT_BORROW};
+    static const size_t thread_counts[] = {1, 2, 4, 0};
+    size_t n = 20000, len = 0, count = 0, i, j, k, t, *offsets;
+    char *json = (char *) malloc(n * 64);
+    int *expect_errors = (int *) malloc(n * sizeof(int));
+    lept_value *expect_values = (lept_value *) malloc(n * sizeof(lept_value));
+    test_ndjson_state s;
+
+    /* 各种记录、空行、\r\n 和出错的记录，最后一行没有换行符 */
+    offsets = (size_t *) malloc(n * sizeof(size_t));
+    for (i = 0; i < n; i++) {
+        const char *line = lines[(i * 7) % (sizeof(lines) / sizeof(lines[0]))];
+        size_t line_len = strlen(line);
+        const char *p = line;
+        while (p < line + line_len && (*p == ' ' || *p == '\t' || *p == '\r'))
+            p++;
+        if (p != line + line_len) {
+            offsets[count] = len;
+            lept_init(&expect_values[count]);
+            expect_errors[count] = lept_parse_n(&expect_values[count], line, line_len);
+            count++;
+        }
+        memcpy(json + len, line, line_len);
+        len += line_len;
+        if (i + 1 < n)
+            json[len++] = '\n';
+    }
+
+    s.offsets = offsets;
+    s.count = count;
+    s.values = (lept_value *) malloc(count * sizeof(lept_value));
+    s.errors = (int *) malloc(count * sizeof(int));
+    for (k = 0; k < sizeof(option_flags) / sizeof(option_flags[0]); k++) {
+        lept_parse_options opts = {option_flags[k], 0, 0};
+        for (t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+            for (j = 0; j < count; j++) {
+                lept_init(&s.values[j]);
+                s.errors[j] = -1;
+            }
+            s.delivered = s.last = 0;
+            s.stop = 0;
+            s.ordered_ok = 1;
+            EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ndjson(json, len, thread_counts[t], &opts,
+                option_flags[k] & LEPT_PARSE_OPT_UNORDERED ? test_ndjson_callback : test_ndjson_ordered, &s));
+            if (!(option_flags[k] & LEPT_PARSE_OPT_UNORDERED)) {
+                EXPECT_EQ_SIZE_T(count, s.delivered);
+                EXPECT_TRUE(s.ordered_ok);
+            }
+            for (j = 0; j < count; j++) {
+                EXPECT_EQ_INT(expect_errors[j], s.errors[j]);
+                if (expect_errors[j] == LEPT_PARSE_OK)
+                    EXPECT_TRUE(lept_is_equal(&expect_values[j], &s.values[j]));
+                lept_free(&s.values[j]);
+            }
+        }
+    }
+
+    /* 回调中止：之后不再调用 */
+    for (j = 0; j < count; j++)
+        lept_init(&s.values[j]);
+    s.delivered = s.last = 0;
+    s.stop = count / 3;
+    EXPECT_EQ_INT(LEPT_PARSE_ABORTED, lept_parse_ndjson(json, len, 4, NULL, test_ndjson_ordered, &s));
+    EXPECT_EQ_SIZE_T(count / 3, s.delivered);
+    for (j = 0; j < count; j++)
+        lept_free(&s.values[j]);
+
+    /* 空输入和只有空行的输入 */
+    s.delivered = 0;
+    s.stop = 0;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ndjson("", 0, 4, NULL, test_ndjson_ordered, &s));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ndjson("\n \r\n\n", 5, 4, NULL, test_ndjson_ordered, &s));
+    EXPECT_EQ_SIZE_T(0, s.delivered);
+
+    for (j = 0; j < count; j++)
+        lept_free(&expect_values[j]);
+    free(s.values);
+    free(s.errors);
+    free(expect_values);
+    free(expect_errors);
+    free(offsets);
+    free(json);
+}
+
+/* 并行构建与串行解析的结果（包括错误码）必须完全一致 */
+#define TEST_PARALLEL(json, len, opts)\
+    do {\
+        lept_parse_options serial = opts;\
+        lept_value v1, v2;\
+        int ret1, ret2;\
+        serial.nthreads = 0;\
+        lept_init(&v1);\
+        lept_init(&v2);\
+        ret1 = lept_parse_opts(&v1, json, len, &serial);\
+        ret2 = lept_parse_opts(&v2, json, len, &opts);\
+        EXPECT_EQ_INT(ret1, ret2);\
+        EXPECT_EQ_INT(lept_get_type(&v1), lept_get_type(&v2));\
+        if (ret1 == LEPT_PARSE_OK && ret2 == LEPT_PARSE_OK) {\
+            EXPECT_TRUE(lept_is_equal(&v1, &v2));\
+        }\
+        lept_free(&v1);\
+        lept_free(&v2);\
+    } while(0)
+
+static void test_parse_parallel() {
+    static const char *elements[] = {
+        "{\"id\":1,\"name\":\"a\\tb\",\"tags\":[\"x\",\"[,]\"],\"o\":{\"k\":null}}", "-2.5e10", "\"s\\\"tr\"",
+        "[[], {}, [1, [2, [3]]]]", "true", "18446744073709551615", "{\"\\\\\":\"}\"}", "null",
+    };
+    /* 替换某个元素后的各种错误 */
+    static const char *bad[] = {
+        "", "1 2", "{\"a\":1]", "[1,]", "\"abc", "\"\\x\"", "1:2", "{\"a\" 1}", "tru", "[[[[[[1]]]]]]",
+    };
+    static const size_t thread_counts[] = {2, 4, 7};
+    size_t n = 40000, len, i, j, k, t, bad_index;
+    char *json = (char *) malloc(n * 80 + 64);
+    lept_parse_options opts = {0, 0, 0}, limited = {LEPT_PARSE_OPT_BORROW, 5, 4};
+
+    for (j = 0; j <= sizeof(bad) / sizeof(bad[0]); j++) {
+        /* j 为 0 时不插入错误，否则把中间某个元素换成 bad[j - 1] */
+        bad_index = j == 0 ? n : n / 3 + j * 997;
+        len = 0;
+        json[len++] = ' ';
+        json[len++] = '[';
+        for (i = 0; i < n; i++) {
+            const char *e = i == bad_index ? bad[j - 1] : elements[i % (sizeof(elements) / sizeof(elements[0]))];
+            if (i > 0)
+                json[len++] = ',';
+            if (i % 5 == 0)
+                json[len++] = '\n';
+            memcpy(json + len, e, strlen(e));
+            len += strlen(e);
+        }
+        json[len++] = ']';
+        json[len++] = ' ';
+        for (t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+            opts.nthreads = thread_counts[t];
+            TEST_PARALLEL(json, len, opts);
+        }
+        TEST_PARALLEL(json, len, limited);
+    }
+
+    /* 根值之后的内容、未结束的数组及不配对的括号 */
+    len = 0;
+    json[len++] = '[';
+    for (i = 0; i < n; i++) {
+        memcpy(json + len, "[1,\"]\"],", 8);
+        len += 8;
+    }
+    json[len++] = '0';
+    json[len++] = ']';
+    opts.nthreads = 4;
+    TEST_PARALLEL(json, len, opts);
+    json[len] = 'x';
+    TEST_PARALLEL(json, len + 1, opts);
+    TEST_PARALLEL(json, len - 1, opts);
+    json[len - 1] = '}';
+    TEST_PARALLEL(json, len, opts);
+    json[0] = '{';
+    TEST_PARALLEL(json, len, opts);
+
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++) {
+        for (k = 0; k < sizeof(thread_counts) / sizeof(thread_counts[0]); k++) {
+            opts.nthreads = thread_counts[k];
+            TEST_PARALLEL(parse_cases[i], strlen(parse_cases[i]), opts);
+        }
+    }
+    free(json);
+}
+
+/* 只校验与 lept_parse_n 的错误码必须一致 */
+#define TEST_VALIDATE(json, len)\
+    do {\
+        lept_value v;\
+        lept_init(&v);\
+        EXPECT_EQ_INT(lept_parse_n(&v, json, len), lept_validate(json, len));\
+        lept_free(&v);\
+    } while(0)
+
+static void test_validate() {
+    static const char *cases[] = {
+        "-", "-0.0e+0", "01", "1.5.2", "1e", "1E+", "-1e-400", "1.7976931348623159e308", "[1e309]",
+        "{\"a\":[1,{\"b\":\"\\uD834\\uDD1E\"}]}", "[[1,]]", "[{\"a\" 1}]", "[\"\\uDC00\"]", "[\"\\uD800\\n\"]",
+        "[0,-0,1.5,-2e10,123456789012345678901234567890]", "{\"a\":1e999}", " [ ] x",
+    };
+    size_t n = 3000, i, len;
+    char *json = (char *) malloc(n * 2 + 400);
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++)
+        TEST_VALIDATE(parse_cases[i], strlen(parse_cases[i]));
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        TEST_VALIDATE(cases[i], strlen(cases[i]));
+
+    /* 整数部分 308 位以内不会超出范围，更长时仍须转换 */
+    for (len = 300; len <= 312; len++) {
+        memset(json, '9', len);
+        TEST_VALIDATE(json, len);
+        json[0] = '1';
+        memset(json + 1, '0', len - 1);
+        TEST_VALIDATE(json, len);
+    }
+
+    /* 超出调用栈上缓冲区的嵌套改用堆，结果不变 */
+    for (len = 0; len < n; len++)
+        json[len] = '[';
+    for (i = 0; i < n; i++)
+        json[len++] = ']';
+    TEST_VALIDATE(json, len);
+    TEST_VALIDATE(json, len - 1);
+    json[n + 10] = '}';
+    TEST_VALIDATE(json, len);
+    TEST_VALIDATE(json, 1023 * 2);
+    for (i = 1020; i <= 1026; i++) {
+        memset(json, '[', i);
+        memset(json + i, ']', i);
+        TEST_VALIDATE(json, i * 2);
+        TEST_VALIDATE(json, i * 2 - 1);
+    }
+    free(json);
+}
+
+/* 选择性解析的结果与期望的 JSON 相同 */
+#define TEST_SELECT(expect, json, pointers)\
+    do {\
+        lept_value v1, v2;\
+        lept_init(&v1);\
+        lept_init(&v2);\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v1, expect));\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_select(&v2, json, strlen(json), pointers, sizeof(pointers) / sizeof(pointers[0])));\
+        EXPECT_TRUE(lept_is_equal(&v1, &v2));\
+        lept_free(&v1);\
+        lept_free(&v2);\
+    } while(0)
+
+static void test_parse_select() {
+    static const char json[] =
+        "{\"user\":{\"id\":7,\"name\":\"x\\ty\",\"tags\":[1,2]},"
+        "\"items\":[{\"price\":1.5,\"qty\":2},{\"qty\":3},{\"price\":2,\"note\":\"\\u00e9\"},5],"
+        "\"other\":[{\"deep\":[1,2,3]}],\"we/ird~\":{\"k\":true},\"\\u0061\":[\"escaped key\"]}";
+    static const char *fields[] = {"/user/id", "/items/*/price"};
+    static const char *index[] = {"/items/2"};
+    static const char *escaped[] = {"/we~1ird~0/k", "/a/0"};
+    static const char *whole[] = {""};
+    static const char *missing[] = {"/missing", "/user/id/x", "/items/9", "/items/x"};
+    static const char *overlap[] = {"/user/id", "/user"};
+    static const char *all[] = {"/*/*"};
+    static const char *none[] = {NULL};
+    static const char *probes[][2] = {{"/a", "/*/0"}, {"/*/*", "/0/a/1"}};
+    lept_value v1, v2;
+    size_t i, j;
+
+    TEST_SELECT("{\"user\":{\"id\":7},\"items\":[{\"price\":1.5},{},{\"price\":2}]}", json, fields);
+    TEST_SELECT("{\"items\":[null,null,{\"price\":2,\"note\":\"\\u00e9\"}]}", json, index);
+    TEST_SELECT("{\"we/ird~\":{\"k\":true},\"a\":[\"escaped key\"]}", json, escaped);
+    TEST_SELECT(json, json, whole);
+    TEST_SELECT("{\"user\":{},\"items\":[]}", json, missing);
+    TEST_SELECT("{\"user\":{\"id\":7,\"name\":\"x\\ty\",\"tags\":[1,2]}}", json, overlap);
+    TEST_SELECT("{\"user\":{\"id\":7,\"name\":\"x\\ty\",\"tags\":[1,2]},"
+                "\"items\":[{\"price\":1.5,\"qty\":2},{\"qty\":3},{\"price\":2,\"note\":\"\\u00e9\"},5],"
+                "\"other\":[{\"deep\":[1,2,3]}],\"we/ird~\":{\"k\":true},\"a\":[\"escaped key\"]}", json, all);
+    TEST_SELECT("[null,[2,{\"a\":3}],{\"b\":4}]", "[1,[2,{\"a\":3}],{\"b\":4},5]", all);
+
+    /* 不选择任何部分时只校验 */
+    lept_init(&v2);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_select(&v2, json, sizeof(json) - 1, none, 0));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v2));
+
+    /* 跳过的部分同样校验，错误码与 lept_parse_n 相同 */
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++) {
+        for (j = 0; j < sizeof(probes) / sizeof(probes[0]); j++) {
+            lept_init(&v1);
+            lept_init(&v2);
+            EXPECT_EQ_INT(lept_parse_n(&v1, parse_cases[i], strlen(parse_cases[i])),
+                          lept_parse_select(&v2, parse_cases[i], strlen(parse_cases[i]), probes[j], 2));
+            lept_free(&v1);
+            lept_free(&v2);
+        }
+    }
+}
+
+/* 工作区的解析结果与 lept_parse_n 相同 */
+#define TEST_WORKSPACE(w, json, len)\
+    do {\
+        lept_value v1, v2;\
+        int ret;\
+        lept_init(&v1);\
+        lept_init(&v2);\
+        ret = lept_parse_n(&v1, json, len);\
+        EXPECT_EQ_INT(ret, lept_workspace_parse(w, &v2, json, len, NULL));\
+        if (ret == LEPT_PARSE_OK)\
+            EXPECT_TRUE(lept_is_equal(&v1, &v2));\
+        else\
+            EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v2));\
+        lept_free(&v1);\
+        lept_free(&v2);\
+    } while(0)
+
+static void test_workspace() {
+    lept_workspace w;
+    lept_value v;
+    lept_parse_options opts = {0};
+    const char *out;
+    char *expect, *json;
+    size_t i, len, n = 2000;
+    void *stack;
+
+    lept_workspace_init(&w, 0);
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++)
+        TEST_WORKSPACE(&w, parse_cases[i], strlen(parse_cases[i]));
+
+    /* 堆栈在调用之间保留，不再重新分配 */
+    json = (char *) malloc(n * 2);
+    memset(json, '[', n);
+    memset(json + n, ']', n);
+    TEST_WORKSPACE(&w, json, n * 2);
+    stack = w.stack;
+    EXPECT_TRUE(stack != NULL && w.values != NULL);
+    for (i = 0; i < 3; i++) {
+        TEST_WORKSPACE(&w, json, n * 2);
+        TEST_WORKSPACE(&w, json, n * 2 - 1);
+        EXPECT_TRUE(w.stack == stack);
+    }
+
+    /* 序列化结果与 lept_stringify 相同 */
+    lept_init(&v);
+    out = "{\"a\":[1,true,null,\"\\u00e9\"],\"b\":{}}";
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_workspace_parse(&w, &v, out, strlen(out), NULL));
+    expect = lept_stringify(&v, &len);
+    for (i = 0; i < 2; i++) {
+        size_t length;
+        out = lept_workspace_stringify(&w, &v, &length);
+        EXPECT_EQ_SIZE_T(len, length);
+        EXPECT_TRUE(memcmp(expect, out, len + 1) == 0);
+    }
+    free(expect);
+    lept_free(&v);
+
+    /* 选项与 lept_parse_opts 相同 */
+    opts.max_depth = 10;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_workspace_parse(&w, &v, json, n * 2, &opts));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_workspace_parse(&w, &v, json + n - 9, 18, &opts));
+    lept_free(&v);
+
+    /* 超过上限的缓冲区在调用结束后释放 */
+    lept_workspace_trim(&w, 1024);
+    EXPECT_TRUE(w.stack == NULL && w.values == NULL);
+    lept_workspace_free(&w);
+    lept_workspace_init(&w, 1024);
+    TEST_WORKSPACE(&w, json, n * 2);
+    EXPECT_TRUE(w.stack == NULL && w.values == NULL);
+    TEST_WORKSPACE(&w, "[1,[2]]", 7);
+    EXPECT_TRUE(w.stack != NULL && w.ssize <= 1024);
+    lept_workspace_free(&w);
+    free(json);
+}
+
+static const char *test_file_path = "leptjson_test.json";
+
+static void test_write_file(const char *json, size_t len) {
+    FILE *fp = fopen(test_file_path, "wb");
+    EXPECT_TRUE(fp != NULL);
+    if (fp) {
+        EXPECT_EQ_SIZE_T(len, fwrite(json, 1, len, fp));
+        fclose(fp);
+    }
+}
+
+/* 文件的解析结果与 lept_parse_n 相同 */
+#define TEST_FILE(json, len)\
+    do {\
+        lept_value v1, v2;\
+        int ret;\
+        lept_init(&v1);\
+        lept_init(&v2);\
+        test_write_file(json, len);\
+        ret = lept_parse_n(&v1, json, len);\
+        EXPECT_EQ_INT(ret, lept_parse_file(&v2, test_file_path, NULL));\
+        if (ret == LEPT_PARSE_OK)\
+            EXPECT_TRUE(lept_is_equal(&v1, &v2));\
+        lept_free(&v1);\
+        lept_free(&v2);\
+    } while(0)
+
+#define TEST_DOCUMENT(d, json, len, flags)\
+    do {\
+        lept_parse_options opts = {(flags), 0, 0};\
+        lept_value v1, v2;\
+        int ret;\
+        lept_init(&v1);\
+        lept_init(&v2);\
+        ret = lept_parse_n(&v1, json, len);\
+        EXPECT_EQ_INT(ret, lept_document_parse(d, json, len, &opts));\
+        if (ret == LEPT_PARSE_OK) {\
+            EXPECT_TRUE(lept_is_equal(&v1, &(d)->root));\
+            lept_copy(&v2, &(d)->root);\
+            lept_document_reset(d);\
+            EXPECT_TRUE(lept_is_equal(&v1, &v2));\
+        } else {\
+            EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&(d)->root));\
+        }\
+        lept_free(&v1);\
+        lept_free(&v2);\
+    } while(0)
+
+static void test_document() {
+    static const char json[] = "{\"a\":[1,\"x\",{\"b\":\"y\"}],\"c\\u0064\":\"z\\n\"}";
+    lept_document d;
+    lept_value v, *a, *e;
+    lept_chunk *chunks, *current;
+    char *big;
+    size_t i, len, n = 2000;
+
+    lept_document_init(&d, 0);
+    for (i = 0; i < sizeof(parse_cases) / sizeof(parse_cases[0]); i++) {
+        TEST_DOCUMENT(&d, parse_cases[i], strlen(parse_cases[i]), 0);
+        TEST_DOCUMENT(&d, parse_cases[i], strlen(parse_cases[i]), LEPT_PARSE_OPT_LAZY);
+        TEST_DOCUMENT(&d, parse_cases[i], strlen(parse_cases[i]), LEPT_PARSE_OPT_SHAPES);
+    }
+
+    /* 字符串、键和元素数组都在区块中 */
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse(&d, json, sizeof(json) - 1, NULL));
+    a = lept_find_object_value(&d.root, "a", 1);
+    EXPECT_TRUE(d.root.flags & LEPT_FLAG_BORROWED);
+    EXPECT_TRUE(a->flags & LEPT_FLAG_BORROWED);
+    EXPECT_TRUE(lept_get_array_element(a, 1)->flags & LEPT_FLAG_BORROWED);
+    EXPECT_TRUE(d.root.u.o.m[1].kflags & LEPT_FLAG_BORROWED);
+    EXPECT_EQ_STRING("cd", lept_get_object_key(&d.root, 1), 2);
+    EXPECT_EQ_STRING("z\n", lept_get_string(lept_find_object_value(&d.root, "cd", 2)), 2);
+    EXPECT_TRUE(lept_is_borrowed(&d.root));
+
+    /* 区块中的值照常修改：新的内存在堆上分配，reset 时一并释放 */
+    lept_set_string(lept_get_array_element(a, 1), "hello", 5);
+    lept_shrink_array(a);
+    EXPECT_TRUE(a->flags & LEPT_FLAG_BORROWED);
+    lept_reserve_array(a, 8);
+    EXPECT_FALSE(a->flags & LEPT_FLAG_BORROWED);
+    EXPECT_EQ_SIZE_T(8, lept_get_array_capacity(a));
+    EXPECT_EQ_SIZE_T(3, lept_get_array_size(a));
+    e = lept_get_array_element(a, 0);
+    lept_set_array(e, 2);
+    EXPECT_EQ_SIZE_T(2, lept_get_array_capacity(e));
+    lept_set_number(lept_find_object_value(lept_get_array_element(a, 2), "b", 1), 2.0);
+    EXPECT_EQ_DOUBLE(2.0, lept_get_number(lept_find_object_value(lept_get_array_element(a, 2), "b", 1)));
+    EXPECT_EQ_STRING("hello", lept_get_string(lept_get_array_element(a, 1)), 5);
+
+    /* 复制或 lept_detach 后不再依赖文档 */
+    lept_init(&v);
+    lept_copy(&v, &d.root);
+    EXPECT_FALSE(lept_is_borrowed(&v));
+    lept_document_reset(&d);
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&d.root));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_document_parse(&d, json, sizeof(json) - 1, NULL));
+    lept_detach(&d.root);
+    EXPECT_FALSE(lept_is_borrowed(&d.root));
+    lept_move(&v, &d.root);
+    lept_document_free(&d);
+    EXPECT_EQ_STRING("z\n", lept_get_string(lept_find_object_value(&v, "cd", 2)), 2);
+    lept_free(&v);
+
+    /* reset 后重用同一批区块；放不下时区块依次加倍 */
+    lept_document_init(&d, 256);
+    big = (char *) malloc(n * 16);
+    len = 0;
+    big[len++] = '[';
+    for (i = 0; i < n; i++)
+        len += sprintf(big + len, "%s{\"k\":\"v%lu\"}", i ? "," : "", (unsigned long) i);
+    big[len++] = ']';
+    TEST_DOCUMENT(&d, big, len, 0);
+    chunks = d.chunks;
+    EXPECT_TRUE(chunks != NULL && lept_document_parse(&d, big, len, NULL) == LEPT_PARSE_OK);
+    current = d.current;
+    EXPECT_TRUE(current != chunks);
+    for (i = 0; i < 3; i++) {
+        TEST_DOCUMENT(&d, big, len, 0);
+        EXPECT_TRUE(lept_document_parse(&d, big, len, NULL) == LEPT_PARSE_OK);
+        EXPECT_TRUE(d.chunks == chunks && d.current == current);
+    }
+    /* 大于区块的字符串 */
+    memset(big, 'x', len);
+    big[0] = big[len - 1] = '"';
+    TEST_DOCUMENT(&d, big, len, 0);
+    lept_document_free(&d);
+    free(big);
+}
+
+static void test_parse_file() {
+    lept_parse_options opts = {LEPT_PARSE_OPT_BORROW | LEPT_PARSE_OPT_LAZY, 0, 0};
+    lept_file f;
+    lept_value v;
+    size_t i, n = 4096;
+    char *json = (char *) malloc(n);
+
+    TEST_FILE("", 0);
+    TEST_FILE(" ", 1);
+    TEST_FILE("{\"a\":[1,2.5,\"x\\n\"]}", 19);
+    TEST_FILE("[1,2", 4);
+
+    /* 文件恰好占满整页，数值、字符串和字面值结束于文件末尾时不能越界读取 */
+    memset(json, ' ', n);
+    memcpy(json + n - 3, "123", 3);
+    TEST_FILE(json, n);
+    memcpy(json + n - 3, "1e5", 3);
+    TEST_FILE(json, n);
+    memcpy(json + n - 3, "\"a\"", 3);
+    TEST_FILE(json, n);
+    memcpy(json + n - 4, "true", 4);
+    TEST_FILE(json, n);
+    memcpy(json + n - 4, "\"\\u0", 4);
+    TEST_FILE(json, n);
+    memcpy(json + n - 4, "tru", 3);
+    TEST_FILE(json, n - 1);
+    json[0] = '[';
+    for (i = 1; i < n - 1; i += 2)
+        memcpy(json + i, "1,", 2);
+    json[n - 1] = '0';
+    TEST_FILE(json, n);
+    json[n - 1] = ']';
+    TEST_FILE(json, n);
+
+    /* 打开 lept_file 时结果可以引用映射 */
+    test_write_file("{\"key\":\"value\",\"list\":[\"x\"]}", 28);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_file_open(&f, test_file_path));
+    EXPECT_EQ_SIZE_T(28, f.len);
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v, f.json, f.len, &opts));
+    EXPECT_TRUE(lept_is_borrowed(&v));
+    EXPECT_TRUE(lept_get_string(lept_find_object_value(&v, "key", 3)) == f.json + 8);
+    lept_free(&v);
+    lept_file_close(&f);
+
+    /* lept_parse_file 返回前解除映射，结果总是自有内存 */
+    test_write_file("{\"key\":\"value\",\"list\":[\"x\"]}", 28);
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_file(&v, test_file_path, &opts));
+    EXPECT_FALSE(lept_is_borrowed(&v));
+    EXPECT_EQ_STRING("value", lept_get_string(lept_find_object_value(&v, "key", 3)), 5);
+    lept_free(&v);
+
+    remove(test_file_path);
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_IO_ERROR, lept_parse_file(&v, test_file_path, NULL));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_IO_ERROR, lept_file_open(&f, test_file_path));
+    EXPECT_EQ_INT(LEPT_PARSE_IO_ERROR, lept_parse_file(&v, ".", NULL));
+    free(json);
+}
+
 static void test_parse() {
     test_parse_null();
     test_parse_true();
     test_parse_false();
     test_parse_number();
+    test_parse_number_exact();
+    test_parse_number_locale();
+    test_parse_integer();
     test_parse_string();
     test_parse_array();
     test_parse_object();
@@ -516,10 +2309,32 @@ static void test_parse() {
     test_parse_invalid_string_char();
     test_parse_invalid_unicode_hex();
     test_parse_invalid_unicode_surrogate();
+    test_parse_unicode_escape();
     test_parse_miss_comma_or_square_bracket();
     test_parse_miss_key();
     test_parse_miss_colon();
     test_parse_miss_comma_or_curly_bracket();
+    test_parse_n();
+    test_parse_whitespace();
+    test_parse_long_string();
+    test_parse_utf8();
+    test_parse_indexed();
+    test_parse_insitu();
+    test_parse_borrow();
+    test_parse_lazy();
+    test_parse_intern();
+    test_parse_shapes();
+    test_parse_depth();
+    test_parse_sax();
+    test_reader();
+    test_parser();
+    test_parse_ndjson();
+    test_parse_parallel();
+    test_validate();
+    test_parse_select();
+    test_workspace();
+    test_document();
+    test_parse_file();
 }
 
 static void test_stringify() {
@@ -541,6 +2356,10 @@ static void test_equal() {
     TEST_EQUAL("null", "0", 0);
     TEST_EQUAL("123", "123", 1);
     TEST_EQUAL("123", "456", 0);
+    TEST_EQUAL("123", "123.0", 1);
+    TEST_EQUAL("9007199254740993", "9007199254740993", 1);
+    TEST_EQUAL("9007199254740993", "9007199254740992", 0);
+    TEST_EQUAL("-1", "18446744073709551615", 0);
     TEST_EQUAL("\"abc\"", "\"abc\"", 1);
     TEST_EQUAL("\"abc\"", "\"abcd\"", 0);
     TEST_EQUAL("[]", "[]", 1);
@@ -583,9 +2402,28 @@ static void test_copy_array() {
     lept_free(&v2);
 }
 
+static void test_copy_intern_keys() {
+    const char json[] = "[{\"id\":1,\"name\":\"a\"},{\"id\":2,\"name\":\"b\"}]";
+    lept_parse_options opts = {LEPT_PARSE_OPT_INTERN_KEYS, 0, 0};
+    lept_value v1, v2, v3;
+    lept_init(&v1);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_opts(&v1, json, sizeof(json) - 1, &opts));
+    lept_init(&v2);
+    lept_copy(&v2, &v1);
+    EXPECT_TRUE(lept_is_equal(&v2, &v1));
+    /* 副本不引用源的键表，释放源后仍可使用 */
+    lept_free(&v1);
+    lept_init(&v3);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v3, json));
+    EXPECT_TRUE(lept_is_equal(&v2, &v3));
+    lept_free(&v2);
+    lept_free(&v3);
+}
+
 static void test_copy() {
     test_copy_array();
     test_copy_object();
+    test_copy_intern_keys();
 }
 
 static void test_move() {
@@ -620,6 +2458,7 @@ static void test_access() {
     test_access_null();
     test_access_boolean();
     test_access_number();
+    test_access_integer();
     test_access_string();
 }
 
@@ -630,7 +2469,7 @@ int main() {
     test_parse();
     test_stringify();
     test_equal();
-/*    test_copy();*/
+    test_copy();
     test_move();
     test_swap();
     test_access();